@@ -0,0 +1,73 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickySpatialHash.h"
+#include "Misc/AutomationTest.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTrickySpatialHashOutsideBoundsTest,
+                                 "TrickyRulers.SpatialHash.FindNearestOutsideBounds",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FTrickySpatialHashOutsideBoundsTest::RunTest(const FString& Parameters)
+{
+	// A single point makes every location diagonal to it in the cell space lie outside of the hash.
+	const TArray<FVector> SinglePoint = {FVector::ZeroVector};
+	const FTrickySpatialHash SingleHash(SinglePoint, 100.0);
+	double Distance = 0.0;
+
+	const FVector DiagonalLocation(550.0, 550.0, 0.0);
+	TestEqual(TEXT("Nearest to a diagonal location"), SingleHash.FindNearestTo(DiagonalLocation, Distance), 0);
+	TestEqual(TEXT("Distance to a diagonal location"), Distance, DiagonalLocation.Size(), 0.001);
+
+	const FVector LocationBelow(-350.0, 250.0, -750.0);
+	TestEqual(TEXT("Nearest to a location below"), SingleHash.FindNearestTo(LocationBelow, Distance), 0);
+
+	const TArray<FVector> Points = {
+		FVector(0.0, 0.0, 0.0),
+		FVector(120.0, 40.0, 10.0),
+		FVector(-80.0, 260.0, 0.0),
+		FVector(310.0, -90.0, 50.0)
+	};
+	const FTrickySpatialHash Hash(Points, 100.0);
+	const TArray<FVector> Locations = {
+		FVector(2000.0, 2000.0, 0.0),
+		FVector(-1500.0, 300.0, 200.0),
+		FVector(400.0, -1200.0, -800.0),
+		FVector(100.0, 100.0, 0.0)
+	};
+
+	for (const FVector& Location : Locations)
+	{
+		int32 ExpectedIndex = INDEX_NONE;
+		double ExpectedDistance = TNumericLimits<double>::Max();
+
+		for (int32 i = 0; i < Points.Num(); ++i)
+		{
+			if (FVector::Dist(Location, Points[i]) < ExpectedDistance)
+			{
+				ExpectedIndex = i;
+				ExpectedDistance = FVector::Dist(Location, Points[i]);
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("Nearest to %s"), *Location.ToString()),
+		          Hash.FindNearestTo(Location, Distance),
+		          ExpectedIndex);
+		TestEqual(FString::Printf(TEXT("Distance to %s"), *Location.ToString()), Distance, ExpectedDistance, 0.001);
+	}
+
+	int32 FoundNum = 0;
+	Hash.ForEachInRadius(FVector(5000.0, 5000.0, 5000.0), 100.0, [&FoundNum](const int32, const double)
+	{
+		++FoundNum;
+	});
+
+	TestEqual(TEXT("Points in a radius outside of the hash"), FoundNum, 0);
+
+	return true;
+}
+
+#endif
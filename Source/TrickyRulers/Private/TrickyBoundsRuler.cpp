@@ -0,0 +1,308 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyBoundsRuler.h"
+
+#include "TrickyDebugShapesComponent.h"
+#include "Components/BillboardComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/Selection.h"
+#include "Engine/Texture2D.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+
+ATrickyBoundsRuler::ATrickyBoundsRuler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bIsEditorOnlyActor = true;
+
+	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
+	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+
+	DebugShapesComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugShapesComponent>(TEXT("DebugShapes"));
+	DebugShapesComponent->SetupAttachment(GetRootComponent());
+
+	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
+
+	if (BillboardComponent)
+	{
+		BillboardComponent->SetupAttachment(GetRootComponent());
+		UTexture2D* BillboardTexture = LoadObject<UTexture2D>(this, TEXT("/Engine/EditorResources/S_TargetPoint"));
+		BillboardComponent->SetSprite(BillboardTexture);
+		SpriteScale = 0.5;
+	}
+}
+
+bool ATrickyBoundsRuler::ShouldTickIfViewportsOnly() const
+{
+	return true;
+}
+
+void ATrickyBoundsRuler::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	if (HasAnyFlags(RF_ClassDefaultObject) || !GetWorld())
+	{
+		return;
+	}
+
+	BindDelegates();
+	UpdateTrackedActors();
+}
+
+void ATrickyBoundsRuler::PostUnregisterAllComponents()
+{
+	UnbindDelegates();
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+void ATrickyBoundsRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UpdateTrackedActors();
+}
+#endif
+
+void ATrickyBoundsRuler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RebuildShapes();
+
+	// Nothing has to be done until one of the tracked actors changes.
+	SetActorTickEnabled(false);
+}
+
+void ATrickyBoundsRuler::BindDelegates()
+{
+	UnbindDelegates();
+
+	RenderStateDirtyHandle = UActorComponent::MarkRenderStateDirtyEvent.AddUObject(
+		this, &ATrickyBoundsRuler::HandleComponentChanged);
+	PhysicsStateCreatedHandle = UActorComponent::GlobalCreatePhysicsDelegate.AddUObject(
+		this, &ATrickyBoundsRuler::HandlePhysicsStateCreated);
+
+#if WITH_EDITOR
+	if (GEngine)
+	{
+		ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddUObject(this, &ATrickyBoundsRuler::HandleActorDeleted);
+	}
+
+	SelectionChangedHandle = USelection::SelectionChangedEvent.AddUObject(
+		this, &ATrickyBoundsRuler::HandleSelectionChanged);
+#endif
+}
+
+void ATrickyBoundsRuler::UnbindDelegates()
+{
+	for (const TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>& Handle : TransformHandles)
+	{
+		if (USceneComponent* Component = Handle.Key.Get())
+		{
+			Component->TransformUpdated.Remove(Handle.Value);
+		}
+	}
+
+	TransformHandles.Empty();
+
+	UActorComponent::MarkRenderStateDirtyEvent.Remove(RenderStateDirtyHandle);
+	UActorComponent::GlobalCreatePhysicsDelegate.Remove(PhysicsStateCreatedHandle);
+	RenderStateDirtyHandle.Reset();
+	PhysicsStateCreatedHandle.Reset();
+
+#if WITH_EDITOR
+	if (GEngine)
+	{
+		GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+	}
+
+	USelection::SelectionChangedEvent.Remove(SelectionChangedHandle);
+#endif
+
+	ActorDeletedHandle.Reset();
+	SelectionChangedHandle.Reset();
+}
+
+void ATrickyBoundsRuler::BindActorComponents(AActor* Actor)
+{
+	TInlineComponentArray<USceneComponent*> Components(Actor);
+
+	for (USceneComponent* Component : Components)
+	{
+		if (!TransformHandles.Contains(Component))
+		{
+			TransformHandles.Add(Component,
+			                     Component->TransformUpdated.AddUObject(
+				                     this, &ATrickyBoundsRuler::HandleTransformUpdated));
+		}
+	}
+}
+
+void ATrickyBoundsRuler::UpdateTrackedActors()
+{
+	TArray<AActor*> Actors;
+
+	if (bTrackSelection)
+	{
+#if WITH_EDITOR
+		if (GEditor)
+		{
+			GEditor->GetSelectedActors()->GetSelectedObjects<AActor>(Actors);
+		}
+#endif
+	}
+	else
+	{
+		Actors.Append(TrackedActors);
+	}
+
+	for (const TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>& Handle : TransformHandles)
+	{
+		if (USceneComponent* Component = Handle.Key.Get())
+		{
+			Component->TransformUpdated.Remove(Handle.Value);
+		}
+	}
+
+	TransformHandles.Reset();
+	CachedBounds.Reset();
+
+	for (AActor* Actor : Actors)
+	{
+		if (!IsValid(Actor) || Actor == this)
+		{
+			continue;
+		}
+
+		CachedBounds.Add(Actor);
+		BindActorComponents(Actor);
+	}
+
+	SetActorTickEnabled(true);
+}
+
+void ATrickyBoundsRuler::MarkActorDirty(const AActor* Actor)
+{
+	FTrickyCachedBounds* Bounds = Actor ? CachedBounds.Find(Actor) : nullptr;
+
+	if (!Bounds)
+	{
+		return;
+	}
+
+	Bounds->bIsDirty = true;
+	SetActorTickEnabled(true);
+}
+
+void ATrickyBoundsRuler::RebuildShapes()
+{
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+	Lines.Reserve(CachedBounds.Num() * 12);
+	DebugTextData.Reset(CachedBounds.Num());
+
+	for (auto It = CachedBounds.CreateIterator(); It; ++It)
+	{
+		AActor* Actor = It.Key().Get();
+
+		if (!IsValid(Actor))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		FTrickyCachedBounds& Bounds = It.Value();
+
+		if (Bounds.bIsDirty)
+		{
+			// Components could be added since the last update.
+			BindActorComponents(Actor);
+
+			if (BoundsType == EBoundsType::Oriented)
+			{
+				Bounds.Box = Actor->CalculateComponentsBoundingBoxInLocalSpace(bIncludeNonColliding);
+				Bounds.Transform = Actor->GetActorTransform();
+			}
+			else
+			{
+				Bounds.Box = Actor->GetComponentsBoundingBox(bIncludeNonColliding);
+				Bounds.Transform = FTransform::Identity;
+			}
+
+			Bounds.bIsDirty = false;
+		}
+
+		if (!Bounds.Box.IsValid)
+		{
+			continue;
+		}
+
+		UTrickyDebugShapesComponent::AddBoxLines(Lines, Bounds.Box, Bounds.Transform, Color, Thickness);
+
+		if (!bShowDebugText)
+		{
+			continue;
+		}
+
+		const FVector Size = Bounds.Box.GetSize() * Bounds.Transform.GetScale3D().GetAbs() / 100.f;
+		FTrickyDebugTextData& Label = DebugTextData.AddDefaulted_GetRef();
+		Label.Text = FString::Printf(TEXT("----------\n%s\n----------\nX: %.2f m\nY: %.2f m\nZ: %.2f m\n----------"),
+		                             *Actor->GetActorNameOrLabel(),
+		                             Size.X,
+		                             Size.Y,
+		                             Size.Z);
+		Label.bUseCustomLocation = true;
+		Label.Location = Bounds.Transform.TransformPosition(
+			FVector(Bounds.Box.GetCenter().X, Bounds.Box.GetCenter().Y, Bounds.Box.Max.Z));
+		Label.Color = Color;
+		Label.TextScale = DebugTextScale;
+	}
+
+	DebugShapesComponent->SetLines(MoveTemp(Lines));
+	TrickyDebugTextComponent->SetDebugLabels(DebugTextData);
+	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+}
+
+void ATrickyBoundsRuler::HandleTransformUpdated(USceneComponent* Component,
+                                                EUpdateTransformFlags Flags,
+                                                ETeleportType Teleport)
+{
+	MarkActorDirty(Component ? Component->GetOwner() : nullptr);
+}
+
+void ATrickyBoundsRuler::HandleComponentChanged(UActorComponent& Component)
+{
+	MarkActorDirty(Component.GetOwner());
+}
+
+void ATrickyBoundsRuler::HandlePhysicsStateCreated(UActorComponent* Component)
+{
+	MarkActorDirty(Component ? Component->GetOwner() : nullptr);
+}
+
+void ATrickyBoundsRuler::HandleActorDeleted(AActor* Actor)
+{
+	if (CachedBounds.Remove(Actor) > 0)
+	{
+		SetActorTickEnabled(true);
+	}
+}
+
+void ATrickyBoundsRuler::HandleSelectionChanged(UObject* Object)
+{
+#if WITH_EDITOR
+	if (bTrackSelection && GEditor && Object == GEditor->GetSelectedActors())
+	{
+		UpdateTrackedActors();
+	}
+#endif
+}
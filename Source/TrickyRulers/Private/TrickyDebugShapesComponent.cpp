@@ -0,0 +1,137 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyDebugShapesComponent.h"
+
+#include "TrickyRulersMemory.h"
+
+class FTrickyDebugShapesSceneProxy : public FDebugRenderSceneProxy
+{
+public:
+	FTrickyDebugShapesSceneProxy(const UPrimitiveComponent* InComponent,
+	                             const TArray<FDebugLine>& InLines,
+	                             const FTrickyRulerGroupStatePtr& InGroupState)
+		: FDebugRenderSceneProxy(InComponent),
+		  GroupState(InGroupState)
+	{
+		DrawType = EDrawType::WireMesh;
+		ViewFlagName = TEXT("Editor");
+		ViewFlagIndex = static_cast<uint32>(FEngineShowFlags::FindIndexByName(*ViewFlagName));
+		Lines = InLines;
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views,
+	                                    const FSceneViewFamily& ViewFamily,
+	                                    uint32 VisibilityMap,
+	                                    FMeshElementCollector& Collector) const override
+	{
+		if (GroupState.IsValid() && GroupState->IsHidden())
+		{
+			return;
+		}
+
+		FDebugRenderSceneProxy::GetDynamicMeshElements(Views, ViewFamily, VisibilityMap, Collector);
+	}
+
+private:
+	FTrickyRulerGroupStatePtr GroupState;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::DebugShapes};
+};
+
+UTrickyDebugShapesComponent::UTrickyDebugShapesComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bIsEditorOnly = true;
+}
+
+void UTrickyDebugShapesComponent::SetLines(TArray<FDebugRenderSceneProxy::FDebugLine>&& InLines)
+{
+	Lines = MoveTemp(InLines);
+	LinesBounds.Init();
+
+	for (const FDebugRenderSceneProxy::FDebugLine& Line : Lines)
+	{
+		LinesBounds += Line.Start;
+		LinesBounds += Line.End;
+	}
+
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTrickyDebugShapesComponent::ClearShapes()
+{
+	if (Lines.Num() == 0)
+	{
+		return;
+	}
+
+	Lines.Empty();
+	LinesBounds.Init();
+	MarkRenderStateDirty();
+}
+
+void UTrickyDebugShapesComponent::AddBoxLines(TArray<FDebugRenderSceneProxy::FDebugLine>& OutLines,
+                                              const FBox& Box,
+                                              const FTransform& Transform,
+                                              const FColor& Color,
+                                              const float Thickness)
+{
+	FVector Vertices[8];
+
+	for (int32 i = 0; i < 8; ++i)
+	{
+		const FVector Corner((i & 1) ? Box.Max.X : Box.Min.X,
+		                     (i & 2) ? Box.Max.Y : Box.Min.Y,
+		                     (i & 4) ? Box.Max.Z : Box.Min.Z);
+		Vertices[i] = Transform.TransformPosition(Corner);
+	}
+
+	// Pairs of the corners which differ in a single axis.
+	constexpr int32 Edges[12][2] = {
+		{0, 1}, {2, 3}, {4, 5}, {6, 7},
+		{0, 2}, {1, 3}, {4, 6}, {5, 7},
+		{0, 4}, {1, 5}, {2, 6}, {3, 7}
+	};
+
+	for (const auto& Edge : Edges)
+	{
+		OutLines.Emplace(Vertices[Edge[0]], Vertices[Edge[1]], Color, Thickness);
+	}
+}
+
+void UTrickyDebugShapesComponent::SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState)
+{
+	if (GroupState == InGroupState)
+	{
+		return;
+	}
+
+	GroupState = InGroupState;
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UTrickyDebugShapesComponent::CreateDebugSceneProxy()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (Lines.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return new FTrickyDebugShapesSceneProxy(this, Lines, GroupState);
+}
+
+FBoxSphereBounds UTrickyDebugShapesComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	// The lines are already in world space.
+	return LinesBounds.IsValid ? FBoxSphereBounds(LinesBounds) : FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+}
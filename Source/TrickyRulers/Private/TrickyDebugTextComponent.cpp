@@ -3,10 +3,30 @@
 
 #include "TrickyDebugTextComponent.h"
 
+#include "CanvasItem.h"
+#include "Algo/StableSort.h"
 #include "Engine/Canvas.h"
+#include "Engine/Font.h"
 #include "Engine/World.h"
 #include "Engine/Engine.h"
 
+FString FTrickyNumericLabel::ToString() const
+{
+	switch (Kind)
+	{
+	case ETrickyNumericLabelKind::SplinePoint:
+		return FString::Printf(TEXT("----------\nPoint %d\n----------\nLength: %.2f m\n----------"), Index, Value);
+
+	case ETrickyNumericLabelKind::SplineSection:
+		return FString::Printf(TEXT("----------\nSection %d\n----------\nLength: %.2f m\n----------"), Index, Value);
+
+	case ETrickyNumericLabelKind::GridLine:
+		return FString::Printf(TEXT("%.2f m"), Value);
+	}
+
+	return FString();
+}
+
 FDebugSceneProxy::FDebugSceneProxy(const UPrimitiveComponent* InComponent,
                                    FDebugSceneProxyData* ProxyData) : FDebugRenderSceneProxy(InComponent)
 {
@@ -20,55 +40,181 @@ FDebugSceneProxy::FDebugSceneProxy(const UPrimitiveComponent* InComponent,
 		ViewFlagName = "Game";
 	}
 
-
-	for (const auto& Text : ProxyData->DebugLabels)
-	{
-		this->Texts.Add({
-			Text.Text,
-			Text.Location,
-			Text.Color,
-		});
-	}
+	// Texts aren't copied into the base proxy, they're drawn by FDebugTextDelegateHelper from the cached labels.
 }
 
 void FDebugTextDelegateHelper::DrawDebugLabels(UCanvas* Canvas, APlayerController* PlayerController)
 {
-	if (!Canvas || !bDrawDebug)
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (!Canvas || !bDrawDebug || (GroupState.IsValid() && GroupState->IsHidden()))
 	{
 		return;
 	}
 
-	const FDebugSceneProxyData::FDebugText* DebugText = DebugLabels.GetData();
-	const FColor OldDrawColor = Canvas->DrawColor;
-	Canvas->SetDrawColor(DebugText->Color);
 	const FSceneView* View = Canvas->SceneView;
-	const UFont* Font = GEngine->GetSmallFont();
+	FCanvasTextItem TextItem(FVector2D::ZeroVector, FText::GetEmpty(), GEngine->GetSmallFont(), FLinearColor::White);
+	TextItem.EnableShadow(FLinearColor::Black);
+	bool bHasPreviousStyle = false;
+	FColor PreviousColor = FColor::White;
+	float PreviousScale = 1.f;
 
-	FFontRenderInfo FontRenderInfo;
-	FontRenderInfo.bEnableShadow = true;
+	for (int32 i = 0; i < DebugLabels.Num(); ++i)
+	{
+		const FDebugSceneProxyData::FDebugText& DebugText = DebugLabels[i];
+
+		if (!View->ViewFrustum.IntersectSphere(DebugText.Location, 1.0f))
+		{
+			continue;
+		}
+
+		const FVector ScreenLoc = Canvas->Project(DebugText.Location);
+
+		if (MinScreenSize > 0.f && DebugText.CullSize > 0.f)
+		{
+			const FVector EdgeLoc = Canvas->Project(DebugText.Location + View->GetViewRight() * DebugText.CullSize);
+
+			if (FVector2D::DistSquared(FVector2D(ScreenLoc), FVector2D(EdgeLoc)) < FMath::Square(MinScreenSize))
+			{
+				continue;
+			}
+		}
+
+		const FLabelText& LabelText = LabelTexts[LabelTextIndices[i]];
+		const FVector2D Size = LabelText.Size * DebugText.Scale;
+
+		if (ScreenLoc.X > Canvas->ClipX || ScreenLoc.Y > Canvas->ClipY
+			|| ScreenLoc.X + Size.X < 0.f || ScreenLoc.Y + Size.Y < 0.f)
+		{
+			continue;
+		}
 
-	for (int32 i = 0; i < DebugLabels.Num(); ++i, ++DebugText)
+		// Labels are sorted, so the item is only updated when the next group starts.
+		if (!bHasPreviousStyle || PreviousColor != DebugText.Color || PreviousScale != DebugText.Scale)
+		{
+			TextItem.SetColor(GroupState.IsValid() ? GroupState->GetColor(DebugText.Color) : DebugText.Color);
+			TextItem.Scale = FVector2D(DebugText.Scale);
+			bHasPreviousStyle = true;
+			PreviousColor = DebugText.Color;
+			PreviousScale = DebugText.Scale;
+		}
+
+		TextItem.Position = FVector2D(ScreenLoc.X, ScreenLoc.Y);
+		TextItem.Text = LabelText.Text;
+		Canvas->DrawItem(TextItem);
+	}
+
+	// Viewports drawn in the same frame share the formatted labels.
+	if (FormattedFrame != GFrameCounter)
+	{
+		Swap(FormattedLabels, PreviousFormattedLabels);
+		FormattedLabels.Reset();
+		FormattedFrame = GFrameCounter;
+	}
+
+	for (int32 i = 0; i < NumericLabels.Num(); ++i)
 	{
-		if (View->ViewFrustum.IntersectSphere(DebugText->Location, 1.0f))
+		const FTrickyNumericLabel& Label = NumericLabels[i];
+
+		if (!View->ViewFrustum.IntersectSphere(Label.Location, 1.0f))
+		{
+			continue;
+		}
+
+		const FVector ScreenLoc = Canvas->Project(Label.Location);
+
+		if (MinScreenSize > 0.f && Label.CullSize > 0.f)
+		{
+			const FVector EdgeLoc = Canvas->Project(Label.Location + View->GetViewRight() * Label.CullSize);
+
+			if (FVector2D::DistSquared(FVector2D(ScreenLoc), FVector2D(EdgeLoc)) < FMath::Square(MinScreenSize))
+			{
+				continue;
+			}
+		}
+
+		if (ScreenLoc.X > Canvas->ClipX || ScreenLoc.Y > Canvas->ClipY)
+		{
+			continue;
+		}
+
+		if (!bHasPreviousStyle || PreviousColor != Label.Color || PreviousScale != 1.f)
 		{
-			const FVector ScreenLoc = Canvas->Project(DebugText->Location);
-			Canvas->DrawText(Font,
-			                 DebugText->Text,
-			                 ScreenLoc.X,
-			                 ScreenLoc.Y,
-			                 DebugText->Scale,
-			                 DebugText->Scale,
-			                 FontRenderInfo);
+			TextItem.SetColor(GroupState.IsValid() ? GroupState->GetColor(Label.Color) : Label.Color);
+			TextItem.Scale = FVector2D::UnitVector;
+			bHasPreviousStyle = true;
+			PreviousColor = Label.Color;
+			PreviousScale = 1.f;
 		}
+
+		TextItem.Position = FVector2D(ScreenLoc.X, ScreenLoc.Y);
+		TextItem.Text = FormatNumericLabel(i);
+		Canvas->DrawItem(TextItem);
+	}
+}
+
+const FText& FDebugTextDelegateHelper::FormatNumericLabel(const int32 Index)
+{
+	if (const FText* Text = FormattedLabels.Find(Index))
+	{
+		return *Text;
 	}
 
-	Canvas->SetDrawColor(OldDrawColor);
+	if (FText* Text = PreviousFormattedLabels.Find(Index))
+	{
+		return FormattedLabels.Add(Index, MoveTemp(*Text));
+	}
+
+	return FormattedLabels.Add(Index, FText::FromString(NumericLabels[Index].ToString()));
 }
 
 void FDebugTextDelegateHelper::SetupFromProxy(const FDebugSceneProxy* InSceneProxy)
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	NumericLabels = InSceneProxy->ProxyData.NumericLabels;
+	FormattedLabels.Reset();
+	PreviousFormattedLabels.Reset();
+
 	DebugLabels.Reset();
 	DebugLabels.Append(InSceneProxy->ProxyData.DebugLabels);
+	Algo::StableSort(DebugLabels, [](const FDebugSceneProxyData::FDebugText& A, const FDebugSceneProxyData::FDebugText& B)
+	{
+		return A.Color.DWColor() != B.Color.DWColor() ? A.Color.DWColor() < B.Color.DWColor() : A.Scale < B.Scale;
+	});
+
+	LabelTexts.Reset();
+	LabelTextIndices.Reset(DebugLabels.Num());
+	TMap<FString, int32> TextIndices;
+	const UFont* Font = GEngine ? GEngine->GetSmallFont() : nullptr;
+
+	for (const FDebugSceneProxyData::FDebugText& DebugText : DebugLabels)
+	{
+		if (const int32* TextIndex = TextIndices.Find(DebugText.Text))
+		{
+			LabelTextIndices.Add(*TextIndex);
+			continue;
+		}
+
+		FLabelText& LabelText = LabelTexts.AddDefaulted_GetRef();
+		LabelText.Text = FText::FromString(DebugText.Text);
+
+		if (Font)
+		{
+			TArray<FString> Lines;
+			DebugText.Text.ParseIntoArrayLines(Lines, false);
+			int32 Width = 0;
+
+			for (const FString& Line : Lines)
+			{
+				Width = FMath::Max(Width, Font->GetStringSize(*Line));
+			}
+
+			LabelText.Size = FVector2D(Width, Font->GetMaxCharHeight() * Lines.Num());
+		}
+
+		LabelTextIndices.Add(TextIndices.Add(DebugText.Text, LabelTexts.Num() - 1));
+	}
 }
 
 UTrickyDebugTextComponent::UTrickyDebugTextComponent()
@@ -79,6 +225,8 @@ UTrickyDebugTextComponent::UTrickyDebugTextComponent()
 
 FDebugRenderSceneProxy* UTrickyDebugTextComponent::CreateDebugSceneProxy()
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	FDebugSceneProxyData ProxyData;
 	ProxyData.bDrawInGame = bDrawInGame;
 
@@ -88,11 +236,13 @@ FDebugRenderSceneProxy* UTrickyDebugTextComponent::CreateDebugSceneProxy()
 		ProxyData.DebugLabels.Add({Label, Location});
 	};
 
-	if (DebugLabels.Num() == 0)
+	if (DebugLabels.Num() == 0 && NumericLabels.Num() == 0)
 	{
 		return nullptr;
 	}
 
+	ProxyData.NumericLabels = NumericLabels;
+
 	for (const FTrickyDebugTextData& Label : DebugLabels)
 	{
 		AddLabelData(Label);
@@ -101,6 +251,7 @@ FDebugRenderSceneProxy* UTrickyDebugTextComponent::CreateDebugSceneProxy()
 	FDebugSceneProxy* DebugSceneProxy = new FDebugSceneProxy(this, &ProxyData);
 
 	DebugDrawDelegateManager.bDrawDebug = bDrawDebug;
+	DebugDrawDelegateManager.MinScreenSize = MinScreenSize;
 
 	if (DebugSceneProxy)
 	{
@@ -117,6 +268,8 @@ FBoxSphereBounds UTrickyDebugTextComponent::CalcBounds(const FTransform& LocalTo
 
 void UTrickyDebugTextComponent::SetDebugLabel(const FTrickyDebugTextData& LabelData)
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	DebugLabels.Empty();
 	DebugLabels.Add(LabelData);
 	MarkRenderStateDirty();
@@ -124,11 +277,21 @@ void UTrickyDebugTextComponent::SetDebugLabel(const FTrickyDebugTextData& LabelD
 
 void UTrickyDebugTextComponent::SetDebugLabels(const TArray<FTrickyDebugTextData>& LabelsData)
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	DebugLabels.Empty();
 	DebugLabels = LabelsData;
 	MarkRenderStateDirty();
 }
 
+void UTrickyDebugTextComponent::SetNumericLabels(const TArray<FTrickyNumericLabel>& Labels)
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	NumericLabels = Labels;
+	MarkRenderStateDirty();
+}
+
 void UTrickyDebugTextComponent::SetDrawDebug(const bool Value)
 {
 	bDrawDebug = Value;
@@ -141,3 +304,31 @@ void UTrickyDebugTextComponent::SetDrawInGame(const bool Value)
 	bIsEditorOnly = !bDrawInGame;
 	MarkRenderStateDirty();
 }
+
+void UTrickyDebugTextComponent::SetMinScreenSize(const float Value)
+{
+	if (FMath::IsNearlyEqual(MinScreenSize, Value))
+	{
+		return;
+	}
+
+	MinScreenSize = Value;
+	MarkRenderStateDirty();
+}
+
+void UTrickyDebugTextComponent::SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState)
+{
+	DebugDrawDelegateManager.GroupState = InGroupState;
+}
+
+SIZE_T UTrickyDebugTextComponent::GetLabelsAllocatedSize() const
+{
+	SIZE_T Size = DebugLabels.GetAllocatedSize() + NumericLabels.GetAllocatedSize();
+
+	for (const FTrickyDebugTextData& Label : DebugLabels)
+	{
+		Size += Label.Text.GetAllocatedSize();
+	}
+
+	return Size;
+}
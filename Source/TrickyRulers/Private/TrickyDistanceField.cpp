@@ -0,0 +1,256 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyDistanceField.h"
+
+#include "TrickySpatialHash.h"
+#include "Async/ParallelFor.h"
+
+
+void FTrickyDistanceField::Init(const FIntPoint& InNodesNum, const double InCellSize, const FTransform& InPlaneTransform)
+{
+	NodesNum = FIntPoint(FMath::Max(InNodesNum.X, 2), FMath::Max(InNodesNum.Y, 2));
+	CellSize = FMath::Max(InCellSize, 1.0);
+
+	const FVector Origin = FVector(-(NodesNum.X - 1) * CellSize, -(NodesNum.Y - 1) * CellSize, 0.0) * 0.5;
+	NodeLocations.SetNumUninitialized(NodesNum.X * NodesNum.Y);
+	Distances.Init(MAX_flt, NodeLocations.Num());
+	Colors.Init(ColorRamp.Num() > 0 ? ColorRamp.Last() : FColor::Black, NodeLocations.Num());
+
+	for (int32 Y = 0; Y < NodesNum.Y; ++Y)
+	{
+		for (int32 X = 0; X < NodesNum.X; ++X)
+		{
+			const FVector LocalLocation = Origin + FVector(X * CellSize, Y * CellSize, 0.0);
+			NodeLocations[Y * NodesNum.X + X] = InPlaneTransform.TransformPosition(LocalLocation);
+		}
+	}
+
+	Tiles.Reset();
+
+	for (int32 FirstY = 0; FirstY < NodesNum.Y; FirstY += TileSize)
+	{
+		for (int32 FirstX = 0; FirstX < NodesNum.X; FirstX += TileSize)
+		{
+			FTile& Tile = Tiles.AddDefaulted_GetRef();
+			Tile.FirstNode = FIntPoint(FirstX, FirstY);
+			Tile.LastNode = FIntPoint(FMath::Min(FirstX + TileSize, NodesNum.X) - 1,
+			                          FMath::Min(FirstY + TileSize, NodesNum.Y) - 1);
+
+			for (int32 Y = Tile.FirstNode.Y; Y <= Tile.LastNode.Y; ++Y)
+			{
+				for (int32 X = Tile.FirstNode.X; X <= Tile.LastNode.X; ++X)
+				{
+					Tile.Bounds += NodeLocations[Y * NodesNum.X + X];
+				}
+			}
+		}
+	}
+
+	DirtyTiles.Init(true, Tiles.Num());
+}
+
+void FTrickyDistanceField::SetTargets(TConstArrayView<FVector> InTargets)
+{
+	// Removed targets shift the indices of the rest, so everything is recomputed.
+	if (InTargets.Num() != Targets.Num())
+	{
+		Targets = TArray<FVector>(InTargets);
+		DirtyTiles.Init(true, Tiles.Num());
+		return;
+	}
+
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		if (!Targets[i].Equals(InTargets[i]))
+		{
+			MarkTilesAffectedByTarget(i, InTargets[i]);
+			Targets[i] = InTargets[i];
+		}
+	}
+}
+
+void FTrickyDistanceField::SetColorRamp(const FLinearColor& NearColor,
+                                        const FLinearColor& FarColor,
+                                        const float InMaxDistance)
+{
+	const float NewMaxDistance = FMath::Max(InMaxDistance, 1.f);
+
+	if (ColorRamp.Num() == ColorRampSize && RampNearColor == NearColor && RampFarColor == FarColor
+		&& MaxDistance == NewMaxDistance)
+	{
+		return;
+	}
+
+	RampNearColor = NearColor;
+	RampFarColor = FarColor;
+	MaxDistance = NewMaxDistance;
+	ColorRamp.SetNumUninitialized(ColorRampSize);
+
+	for (int32 i = 0; i < ColorRampSize; ++i)
+	{
+		ColorRamp[i] = FLinearColor::LerpUsingHSV(NearColor, FarColor, i / (ColorRampSize - 1.f)).ToFColor(true);
+	}
+
+	DirtyTiles.Init(true, Tiles.Num());
+}
+
+int32 FTrickyDistanceField::GetCoveredNum() const
+{
+	int32 CoveredNum = 0;
+
+	for (const FTile& Tile : Tiles)
+	{
+		CoveredNum += Tile.CoveredNum;
+	}
+
+	return CoveredNum;
+}
+
+float FTrickyDistanceField::GetMaxNodeDistance() const
+{
+	float MaxNodeDistance = 0.f;
+
+	for (const FTile& Tile : Tiles)
+	{
+		MaxNodeDistance = FMath::Max(MaxNodeDistance, Tile.MaxDistance);
+	}
+
+	return MaxNodeDistance;
+}
+
+bool FTrickyDistanceField::Update()
+{
+	TArray<int32> TilesToCompute;
+
+	for (TConstSetBitIterator<> It(DirtyTiles); It; ++It)
+	{
+		TilesToCompute.Add(It.GetIndex());
+	}
+
+	if (TilesToCompute.Num() == 0)
+	{
+		return false;
+	}
+
+	DirtyTiles.Init(false, Tiles.Num());
+
+	// Cells of the hash are large enough to not walk through many empty rings for the tiles far from the targets.
+	const FBox TargetsBounds(Targets);
+	const double TileWorldSize = TileSize * CellSize;
+	const double HashCellSize = TargetsBounds.IsValid
+		                            ? FMath::Max(TileWorldSize, TargetsBounds.GetExtent().GetMax() / 8.0)
+		                            : TileWorldSize;
+	const FTrickySpatialHash SpatialHash(Targets, HashCellSize);
+
+	ParallelFor(TilesToCompute.Num(), [this, &TilesToCompute, &SpatialHash](const int32 Index)
+	{
+		ComputeTile(Tiles[TilesToCompute[Index]], SpatialHash);
+	});
+
+	return true;
+}
+
+void FTrickyDistanceField::MarkTilesAffectedByTarget(const int32 TargetIndex, const FVector& NewLocation)
+{
+	for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+	{
+		const FTile& Tile = Tiles[TileIndex];
+
+		// The target was the nearest one for some node and it can move away from it,
+		// or it moved close enough to become the nearest one for some node.
+		if (Tile.NearestTargets.Contains(TargetIndex)
+			|| Tile.Bounds.ComputeSquaredDistanceToPoint(NewLocation) < FMath::Square(Tile.MaxDistance))
+		{
+			DirtyTiles[TileIndex] = true;
+		}
+	}
+}
+
+void FTrickyDistanceField::ComputeTile(FTile& Tile, const FTrickySpatialHash& SpatialHash)
+{
+	Tile.NearestTargets.Reset();
+	Tile.MaxDistance = MAX_flt;
+	Tile.CoveredNum = 0;
+
+	double CenterDistance = 0.0;
+
+	if (SpatialHash.FindNearestTo(Tile.Bounds.GetCenter(), CenterDistance) == INDEX_NONE)
+	{
+		for (int32 Y = Tile.FirstNode.Y; Y <= Tile.LastNode.Y; ++Y)
+		{
+			for (int32 X = Tile.FirstNode.X; X <= Tile.LastNode.X; ++X)
+			{
+				SetNodeDistance(Tile, Y * NodesNum.X + X, MAX_flt);
+			}
+		}
+
+		return;
+	}
+
+	// No node is farther than CenterDistance + HalfDiagonal from its nearest target,
+	// so only the targets within that distance from any node can be the nearest ones.
+	const double HalfDiagonal = Tile.Bounds.GetExtent().Size();
+	const FVector Center = Tile.Bounds.GetCenter();
+	TArray<float, TInlineAllocator<64>> CandidatesX;
+	TArray<float, TInlineAllocator<64>> CandidatesY;
+	TArray<float, TInlineAllocator<64>> CandidatesZ;
+	TArray<int32, TInlineAllocator<64>> CandidateIndices;
+
+	SpatialHash.ForEachInRadius(Center, CenterDistance + HalfDiagonal * 2.0, [&](const int32 Index, const double)
+	{
+		// Candidates are relative to the tile center to keep the float precision in big worlds.
+		const FVector Location = Targets[Index] - Center;
+		CandidatesX.Add(Location.X);
+		CandidatesY.Add(Location.Y);
+		CandidatesZ.Add(Location.Z);
+		CandidateIndices.Add(Index);
+	});
+
+	const int32 CandidatesNum = CandidateIndices.Num();
+	const float* RESTRICT X = CandidatesX.GetData();
+	const float* RESTRICT Y = CandidatesY.GetData();
+	const float* RESTRICT Z = CandidatesZ.GetData();
+	float MaxDistanceSquared = 0.f;
+
+	for (int32 NodeY = Tile.FirstNode.Y; NodeY <= Tile.LastNode.Y; ++NodeY)
+	{
+		for (int32 NodeX = Tile.FirstNode.X; NodeX <= Tile.LastNode.X; ++NodeX)
+		{
+			const int32 NodeIndex = NodeY * NodesNum.X + NodeX;
+			const FVector3f Node(NodeLocations[NodeIndex] - Center);
+			float NearestDistanceSquared = MAX_flt;
+			int32 NearestCandidate = 0;
+
+			// Branchless structure of arrays loop, so the compiler can vectorise it.
+			for (int32 i = 0; i < CandidatesNum; ++i)
+			{
+				const float DeltaX = X[i] - Node.X;
+				const float DeltaY = Y[i] - Node.Y;
+				const float DeltaZ = Z[i] - Node.Z;
+				const float DistanceSquared = DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ;
+				const bool bIsNearer = DistanceSquared < NearestDistanceSquared;
+				NearestDistanceSquared = bIsNearer ? DistanceSquared : NearestDistanceSquared;
+				NearestCandidate = bIsNearer ? i : NearestCandidate;
+			}
+
+			SetNodeDistance(Tile, NodeIndex, FMath::Sqrt(NearestDistanceSquared));
+			MaxDistanceSquared = FMath::Max(MaxDistanceSquared, NearestDistanceSquared);
+			Tile.NearestTargets.AddUnique(CandidateIndices[NearestCandidate]);
+		}
+	}
+
+	Tile.MaxDistance = FMath::Sqrt(MaxDistanceSquared);
+}
+
+void FTrickyDistanceField::SetNodeDistance(FTile& Tile, const int32 NodeIndex, const float Distance)
+{
+	Distances[NodeIndex] = Distance;
+	Tile.CoveredNum += Distance <= MaxDistance ? 1 : 0;
+
+	if (ColorRamp.Num() > 0)
+	{
+		const float Alpha = FMath::Clamp(Distance / MaxDistance, 0.f, 1.f);
+		Colors[NodeIndex] = ColorRamp[FMath::RoundToInt32(Alpha * (ColorRamp.Num() - 1))];
+	}
+}
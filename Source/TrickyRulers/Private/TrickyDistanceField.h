@@ -0,0 +1,112 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Distance from the nodes of a planar grid to the nearest of the targets.
+ * The grid is split into tiles, moving a target recomputes only the tiles where the nearest target can change.
+ */
+class FTrickyDistanceField
+{
+public:
+	/**
+	 * Places the nodes in world space and marks all tiles dirty.
+	 */
+	void Init(const FIntPoint& InNodesNum, const double InCellSize, const FTransform& InPlaneTransform);
+
+	/**
+	 * Replaces the targets and marks the tiles affected by the moved ones dirty.
+	 */
+	void SetTargets(TConstArrayView<FVector> InTargets);
+
+	/**
+	 * Colors of the nodes are blended from near to far by the distance. Changing the ramp marks all tiles dirty.
+	 */
+	void SetColorRamp(const FLinearColor& NearColor, const FLinearColor& FarColor, const float InMaxDistance);
+
+	/**
+	 * Recomputes the distances and the colors of the dirty tiles on the worker threads.
+	 * @return true if any tile was recomputed.
+	 */
+	bool Update();
+
+	FIntPoint GetNodesNum() const { return NodesNum; }
+
+	/**
+	 * Distances in cm per node, MAX_flt if there are no targets.
+	 */
+	const TArray<float>& GetDistances() const { return Distances; }
+
+	const TArray<FColor>& GetColors() const { return Colors; }
+
+	/**
+	 * Number of the nodes within the max distance of the color ramp from a target.
+	 */
+	int32 GetCoveredNum() const;
+
+	/**
+	 * The largest distance from a node to its nearest target.
+	 */
+	float GetMaxNodeDistance() const;
+
+	int32 GetDirtyTilesNum() const { return DirtyTiles.CountSetBits(); }
+
+private:
+	constexpr static int32 TileSize = 16;
+
+	constexpr static int32 ColorRampSize = 256;
+
+	struct FTile
+	{
+		FIntPoint FirstNode = FIntPoint::ZeroValue;
+		FIntPoint LastNode = FIntPoint::ZeroValue;
+		FBox Bounds{ForceInit};
+
+		/**
+		 * The largest distance to the nearest target among the nodes of the tile.
+		 */
+		float MaxDistance = MAX_flt;
+
+		int32 CoveredNum = 0;
+
+		/**
+		 * Targets which are the nearest ones for at least one node of the tile.
+		 */
+		TArray<int32> NearestTargets;
+	};
+
+	FIntPoint NodesNum = FIntPoint::ZeroValue;
+
+	double CellSize = 100.0;
+
+	TArray<FVector> NodeLocations;
+
+	TArray<float> Distances;
+
+	TArray<FColor> Colors;
+
+	/**
+	 * Precomputed HSV blend, so the nodes only look up their colors.
+	 */
+	TArray<FColor> ColorRamp;
+
+	float MaxDistance = 1.f;
+
+	FLinearColor RampNearColor = FLinearColor::Transparent;
+
+	FLinearColor RampFarColor = FLinearColor::Transparent;
+
+	TArray<FVector> Targets;
+
+	TArray<FTile> Tiles;
+
+	TBitArray<> DirtyTiles;
+
+	void MarkTilesAffectedByTarget(const int32 TargetIndex, const FVector& NewLocation);
+
+	void ComputeTile(FTile& Tile, const class FTrickySpatialHash& SpatialHash);
+
+	void SetNodeDistance(FTile& Tile, const int32 NodeIndex, const float Distance);
+};
@@ -0,0 +1,157 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyDistanceGraphComponent.h"
+
+#include "DebugRenderSceneProxy.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+#include "TrickyRulersMemory.h"
+
+class FTrickyDistanceGraphSceneProxy : public FDebugRenderSceneProxy
+{
+public:
+	FTrickyDistanceGraphSceneProxy(const UPrimitiveComponent* InComponent,
+	                               const TArray<FTrickyDistanceGraphData>& InGraphs,
+	                               const FVector2D& InGraphSize,
+	                               const float InThickness)
+		: FDebugRenderSceneProxy(InComponent),
+		  Graphs(InGraphs),
+		  GraphSize(InGraphSize),
+		  Thickness(InThickness)
+	{
+		int32 MaxCapacity = 0;
+
+		for (const FTrickyDistanceGraphData& Graph : Graphs)
+		{
+			MaxCapacity = FMath::Max(MaxCapacity, Graph.History->GetCapacity());
+		}
+
+		SamplesBuffer.SetNumUninitialized(MaxCapacity);
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		// Recorded in PIE and simulate, so the graph doesn't depend on the Editor or Game show flags.
+		FPrimitiveViewRelevance Result;
+		Result.bDrawRelevance = IsShown(View);
+		Result.bDynamicRelevance = true;
+		Result.bSeparateTranslucency = Result.bNormalTranslucency = true;
+		return Result;
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views,
+	                                    const FSceneViewFamily& ViewFamily,
+	                                    uint32 VisibilityMap,
+	                                    FMeshElementCollector& Collector) const override
+	{
+		const FVector Origin = GetLocalToWorld().GetOrigin();
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+		{
+			if (!(VisibilityMap & (1 << ViewIndex)))
+			{
+				continue;
+			}
+
+			const FSceneView* View = Views[ViewIndex];
+			FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
+			const FVector Right = View->GetViewRight() * GraphSize.X;
+			const FVector Up = View->GetViewUp() * GraphSize.Y;
+
+			for (int32 GraphIndex = 0; GraphIndex < Graphs.Num(); ++GraphIndex)
+			{
+				const FVector Corner = Origin + View->GetViewUp() * (GraphSize.Y * 1.2f * (GraphIndex + 1));
+				DrawGraph(PDI, Graphs[GraphIndex], Corner, Right, Up);
+			}
+		}
+	}
+
+private:
+	TArray<FTrickyDistanceGraphData> Graphs;
+
+	FVector2D GraphSize;
+
+	float Thickness;
+
+	/**
+	 * Used only on the render thread, allocated once to avoid allocations per frame.
+	 */
+	mutable TArray<float> SamplesBuffer;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::DistanceGraph};
+
+	void DrawGraph(FPrimitiveDrawInterface* PDI,
+	               const FTrickyDistanceGraphData& Graph,
+	               const FVector& Corner,
+	               const FVector& Right,
+	               const FVector& Up) const
+	{
+		const FColor FrameColor = FColor(Graph.Color.R, Graph.Color.G, Graph.Color.B, 128);
+		PDI->DrawLine(Corner, Corner + Right, FrameColor, SDPG_World, 1.f);
+		PDI->DrawLine(Corner, Corner + Up, FrameColor, SDPG_World, 1.f);
+
+		const int32 SamplesNum = Graph.History->CopyLatest(SamplesBuffer);
+
+		if (SamplesNum < 2)
+		{
+			return;
+		}
+
+		float MinSample = SamplesBuffer[0];
+		float MaxSample = SamplesBuffer[0];
+
+		for (int32 i = 1; i < SamplesNum; ++i)
+		{
+			MinSample = FMath::Min(MinSample, SamplesBuffer[i]);
+			MaxSample = FMath::Max(MaxSample, SamplesBuffer[i]);
+		}
+
+		const float Range = FMath::Max(MaxSample - MinSample, UE_KINDA_SMALL_NUMBER);
+		const float Step = 1.f / (Graph.History->GetCapacity() - 1);
+		FVector PreviousPoint = Corner + Up * ((SamplesBuffer[0] - MinSample) / Range);
+
+		for (int32 i = 1; i < SamplesNum; ++i)
+		{
+			const FVector Point = Corner + Right * (i * Step) + Up * ((SamplesBuffer[i] - MinSample) / Range);
+			PDI->DrawLine(PreviousPoint, Point, Graph.Color, SDPG_World, Thickness);
+			PreviousPoint = Point;
+		}
+	}
+};
+
+UTrickyDistanceGraphComponent::UTrickyDistanceGraphComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bIsEditorOnly = true;
+}
+
+void UTrickyDistanceGraphComponent::SetGraphs(const TArray<FTrickyDistanceGraphData>& InGraphs)
+{
+	Graphs = InGraphs;
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UTrickyDistanceGraphComponent::CreateDebugSceneProxy()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (Graphs.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return new FTrickyDistanceGraphSceneProxy(this, Graphs, GraphSize, Thickness);
+}
+
+FBoxSphereBounds UTrickyDistanceGraphComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	const float Extent = FMath::Max(GraphSize.X, GraphSize.Y * 1.2f * (Graphs.Num() + 1));
+	return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector(Extent), Extent);
+}
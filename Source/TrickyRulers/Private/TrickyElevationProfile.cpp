@@ -0,0 +1,386 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyElevationProfile.h"
+
+#include "Components/SplineComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+void FTrickyElevationProfile::Update(UWorld* World,
+                                     const USplineComponent* SplineComponent,
+                                     const FTrickyElevationSettings& Settings,
+                                     const bool bForceFullUpdate)
+{
+	if (!World || !SplineComponent)
+	{
+		return;
+	}
+
+	TBitArray<> DirtySections;
+	bool bIsFullUpdate = ChangeTracker.Update(SplineComponent, DirtySections);
+
+	// The tracker works in local space, while the traces depend on the world transform.
+	const FTransform& Transform = SplineComponent->GetComponentTransform();
+
+	if (bForceFullUpdate || Settings != CachedSettings || !Transform.Equals(CachedTransform))
+	{
+		bIsFullUpdate = true;
+		DirtySections.Init(true, DirtySections.Num());
+	}
+
+	CachedSettings = Settings;
+	CachedTransform = Transform;
+	IgnoredActor = SplineComponent->GetOwner();
+
+	if (bIsFullUpdate)
+	{
+		ResetSections(DirtySections.Num());
+	}
+
+	const double SampleStep = FMath::Max(CachedSettings.SampleStep, 1.f);
+
+	for (TConstSetBitIterator<> It(DirtySections); It; ++It)
+	{
+		const int32 SectionIndex = It.GetIndex();
+		const double StartDistance = SplineComponent->GetDistanceAlongSplineAtSplinePoint(SectionIndex);
+		const double EndDistance = SplineComponent->GetDistanceAlongSplineAtSplinePoint(SectionIndex + 1);
+		const int32 SegmentsNum = FMath::Clamp(FMath::CeilToInt32((EndDistance - StartDistance) / SampleStep),
+		                                       1,
+		                                       MaxSegmentsPerSection);
+		TArray<FVector>& Samples = Sections[SectionIndex].Samples;
+		Samples.SetNumUninitialized(SegmentsNum + 1);
+
+		for (int32 i = 0; i <= SegmentsNum; ++i)
+		{
+			const double Distance = FMath::Lerp(StartDistance, EndDistance, static_cast<double>(i) / SegmentsNum);
+			Samples[i] = SplineComponent->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+		}
+
+		TraceSection(World, SectionIndex);
+	}
+}
+
+void FTrickyElevationProfile::Update(UWorld* World,
+                                     const FVector& Start,
+                                     const FVector& Direction,
+                                     const double Length,
+                                     const AActor* Owner,
+                                     const FTrickyElevationSettings& Settings,
+                                     const bool bForceFullUpdate)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	const double SampleStep = FMath::Max(Settings.SampleStep, 1.f);
+	const double SectionLength = SampleStep * MaxSegmentsPerSection;
+	const int32 SectionsNum = FMath::Max(FMath::CeilToInt32(Length / SectionLength), 1);
+	const bool bIsFullUpdate = bForceFullUpdate || Settings != CachedSettings || Owner != IgnoredActor.Get();
+	CachedSettings = Settings;
+	IgnoredActor = Owner;
+
+	if (bIsFullUpdate)
+	{
+		ResetSections(SectionsNum);
+	}
+	else if (SectionsNum != Sections.Num())
+	{
+		for (int32 SectionIndex = SectionsNum; SectionIndex < Sections.Num(); ++SectionIndex)
+		{
+			for (const uint64 TraceHandle : Sections[SectionIndex].TraceHandles)
+			{
+				PendingTracesNum -= TraceHandle != 0;
+			}
+		}
+
+		Sections.SetNum(SectionsNum);
+		MarkResultsChanged();
+	}
+
+	TArray<FVector> Samples;
+
+	for (int32 SectionIndex = 0; SectionIndex < SectionsNum; ++SectionIndex)
+	{
+		const double StartDistance = SectionIndex * SectionLength;
+		const double EndDistance = FMath::Min(StartDistance + SectionLength, Length);
+		const int32 SegmentsNum = FMath::Max(FMath::CeilToInt32((EndDistance - StartDistance) / SampleStep), 1);
+		Samples.Reset(SegmentsNum + 1);
+
+		// Samples keep the fixed step from the start, so they stay the same when only the end of the line moves.
+		for (int32 i = 0; i < SegmentsNum; ++i)
+		{
+			Samples.Add(Start + Direction * (StartDistance + i * SampleStep));
+		}
+
+		Samples.Add(Start + Direction * EndDistance);
+		FTrickyElevationSection& Section = Sections[SectionIndex];
+
+		if (Section.Samples == Samples)
+		{
+			continue;
+		}
+
+		Section.Samples = Samples;
+		TraceSection(World, SectionIndex);
+	}
+}
+
+void FTrickyElevationProfile::Invalidate(UWorld* World, const AActor* ChangedActor)
+{
+	if (!World || !ChangedActor || ChangedActor == IgnoredActor.Get())
+	{
+		return;
+	}
+
+	const FBox ActorBounds = ChangedActor->GetComponentsBoundingBox();
+
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+	{
+		const FTrickyElevationSection& Section = Sections[SectionIndex];
+
+		// The hit actors catch the surfaces moved away from the section, the bounds catch the ones moved under it.
+		if (Section.HitActors.Contains(ChangedActor) || (ActorBounds.IsValid && Section.Bounds.Intersect(ActorBounds)))
+		{
+			TraceSection(World, SectionIndex);
+		}
+	}
+}
+
+void FTrickyElevationProfile::Reset()
+{
+	ChangeTracker.Reset();
+	Sections.Empty();
+	CachedSettings = FTrickyElevationSettings();
+	CachedTransform = FTransform::Identity;
+	IgnoredActor.Reset();
+	PendingTracesNum = 0;
+	MarkResultsChanged();
+}
+
+bool FTrickyElevationProfile::ConsumeResultsChanged()
+{
+	const bool bResult = bHaveResultsChanged;
+	bHaveResultsChanged = false;
+	return bResult;
+}
+
+const FTrickyElevationStats& FTrickyElevationProfile::GetStats() const
+{
+	if (bAreStatsDirty)
+	{
+		CachedStats = CalculateStats();
+		bAreStatsDirty = false;
+	}
+
+	return CachedStats;
+}
+
+void FTrickyElevationProfile::GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const
+{
+	const FTrickyElevationStats& Stats = GetStats();
+	OutMeasurements.Add({TEXT("Climb"), Stats.Climb / 100.0});
+	OutMeasurements.Add({TEXT("Descent"), Stats.Descent / 100.0});
+	OutMeasurements.Add({TEXT("MaxSlope"), Stats.MaxSlope});
+}
+
+FString FTrickyElevationProfile::GetStatsText() const
+{
+	if (IsTracing())
+	{
+		return TEXT("Elevation: tracing...");
+	}
+
+	const FTrickyElevationStats& Stats = GetStats();
+
+	if (Stats.HitSamplesNum == 0)
+	{
+		return TEXT("Elevation: no surface");
+	}
+
+	return FString::Printf(TEXT("Climb: %.2f m\nDescent: %.2f m\nMax slope: %.1f deg\nHeight: %.2f - %.2f m"),
+	                       Stats.Climb / 100.0,
+	                       Stats.Descent / 100.0,
+	                       Stats.MaxSlope,
+	                       Stats.MinHeight / 100.0,
+	                       Stats.MaxHeight / 100.0);
+}
+
+void FTrickyElevationProfile::BuildSlopeLines(const FElevationProfileProperties& Properties,
+                                              TArray<FDebugRenderSceneProxy::FDebugLine>& OutLines) const
+{
+	const FVector Offset = FVector::UpVector * Properties.SurfaceOffset;
+
+	ForEachSlopeSegment([&Properties, &OutLines, &Offset](const FVector& Start, const FVector& End, const double Slope)
+	{
+		OutLines.Emplace(Start + Offset, End + Offset, Properties.GetSlopeColor(Slope), Properties.Thickness);
+	});
+}
+
+FTrickyElevationStats FTrickyElevationProfile::CalculateStats() const
+{
+	FTrickyElevationStats Stats;
+	Stats.MinHeight = TNumericLimits<double>::Max();
+	Stats.MaxHeight = TNumericLimits<double>::Lowest();
+
+	for (const FTrickyElevationSection& Section : Sections)
+	{
+		for (TConstSetBitIterator<> It(Section.HitSamples); It; ++It)
+		{
+			const double Height = Section.SurfacePoints[It.GetIndex()].Z;
+			Stats.MinHeight = FMath::Min(Stats.MinHeight, Height);
+			Stats.MaxHeight = FMath::Max(Stats.MaxHeight, Height);
+			++Stats.HitSamplesNum;
+		}
+	}
+
+	if (Stats.HitSamplesNum == 0)
+	{
+		Stats.MinHeight = 0.0;
+		Stats.MaxHeight = 0.0;
+		return Stats;
+	}
+
+	ForEachSlopeSegment([&Stats](const FVector& Start, const FVector& End, const double Slope)
+	{
+		const double HeightDelta = End.Z - Start.Z;
+		Stats.Climb += FMath::Max(HeightDelta, 0.0);
+		Stats.Descent += FMath::Max(-HeightDelta, 0.0);
+		Stats.MaxSlope = FMath::Max(Stats.MaxSlope, Slope);
+	});
+
+	return Stats;
+}
+
+void FTrickyElevationProfile::ForEachSlopeSegment(
+	TFunctionRef<void(const FVector&, const FVector&, double)> Function) const
+{
+	const FVector* PreviousPoint = nullptr;
+
+	for (const FTrickyElevationSection& Section : Sections)
+	{
+		for (int32 i = 0; i < Section.Samples.Num(); ++i)
+		{
+			// Samples without the surface break the profile.
+			if (!Section.HitSamples[i])
+			{
+				PreviousPoint = nullptr;
+				continue;
+			}
+
+			const FVector& Point = Section.SurfacePoints[i];
+
+			// Neighbour sections share the samples on their borders.
+			if (PreviousPoint && FVector::DistSquared2D(*PreviousPoint, Point) > UE_KINDA_SMALL_NUMBER)
+			{
+				const double Run = FVector::Dist2D(*PreviousPoint, Point);
+				const double Slope = FMath::RadiansToDegrees(FMath::Atan2(FMath::Abs(Point.Z - PreviousPoint->Z), Run));
+				Function(*PreviousPoint, Point, Slope);
+			}
+
+			PreviousPoint = &Point;
+		}
+	}
+}
+
+void FTrickyElevationProfile::MarkResultsChanged()
+{
+	bHaveResultsChanged = true;
+	bAreStatsDirty = true;
+}
+
+void FTrickyElevationProfile::ResetSections(const int32 SectionsNum)
+{
+	Sections.Reset();
+	Sections.SetNum(SectionsNum);
+	PendingTracesNum = 0;
+	MarkResultsChanged();
+}
+
+void FTrickyElevationProfile::TraceSection(UWorld* World, const int32 SectionIndex)
+{
+	FTrickyElevationSection& Section = Sections[SectionIndex];
+
+	for (const uint64 TraceHandle : Section.TraceHandles)
+	{
+		PendingTracesNum -= TraceHandle != 0;
+	}
+
+	const int32 SamplesNum = Section.Samples.Num();
+	const FVector Range = FVector::UpVector * CachedSettings.TraceRange;
+	Section.TraceHandles.Init(0, SamplesNum);
+	Section.SurfacePoints.SetNumZeroed(SamplesNum);
+	Section.HitSamples.Init(false, SamplesNum);
+	Section.HitActors.Reset();
+	Section.Bounds = FBox(Section.Samples).ExpandBy(FVector(0.0, 0.0, CachedSettings.TraceRange));
+
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrickyElevationProfile), true, IgnoredActor.Get());
+
+	FTraceDelegate TraceDelegate;
+	TraceDelegate.BindSP(AsShared(), &FTrickyElevationProfile::HandleTraceDone);
+
+	// All traces are requested in the same frame, so the async trace system processes them as one batch.
+	for (int32 i = 0; i < SamplesNum; ++i)
+	{
+		const FTraceHandle Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+		                                                           Section.Samples[i] + Range,
+		                                                           Section.Samples[i] - Range,
+		                                                           CachedSettings.Channel,
+		                                                           QueryParams,
+		                                                           FCollisionResponseParams::DefaultResponseParam,
+		                                                           &TraceDelegate,
+		                                                           static_cast<uint32>(SectionIndex));
+		Section.TraceHandles[i] = Handle._Handle;
+		PendingTracesNum += Handle._Handle != 0;
+	}
+
+	MarkResultsChanged();
+}
+
+void FTrickyElevationProfile::HandleTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const int32 SectionIndex = static_cast<int32>(TraceDatum.UserData);
+
+	if (!Sections.IsValidIndex(SectionIndex))
+	{
+		return;
+	}
+
+	FTrickyElevationSection& Section = Sections[SectionIndex];
+	const int32 Sample = Section.TraceHandles.Find(TraceHandle._Handle);
+
+	// The section has been traced again since the request, the result is outdated.
+	if (Sample == INDEX_NONE || TraceHandle._Handle == 0)
+	{
+		return;
+	}
+
+	Section.TraceHandles[Sample] = 0;
+	--PendingTracesNum;
+
+	if (PendingTracesNum == 0)
+	{
+		MarkResultsChanged();
+	}
+
+	const FHitResult* Hit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& HitResult)
+	{
+		return HitResult.bBlockingHit;
+	});
+
+	if (!Hit)
+	{
+		return;
+	}
+
+	Section.HitSamples[Sample] = true;
+	Section.SurfacePoints[Sample] = Hit->ImpactPoint;
+
+	if (const AActor* HitActor = Hit->GetActor())
+	{
+		Section.HitActors.AddUnique(HitActor);
+	}
+
+	MarkResultsChanged();
+}
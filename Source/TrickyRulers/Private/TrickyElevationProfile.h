@@ -0,0 +1,188 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DebugRenderSceneProxy.h"
+#include "WorldCollision.h"
+#include "TrickyMeasurement.h"
+#include "TrickyRulerProperties.h"
+#include "TrickySplineChangeTracker.h"
+
+class USplineComponent;
+
+struct FTrickyElevationSettings
+{
+	float SampleStep = 0.f;
+	float TraceRange = 0.f;
+	TEnumAsByte<ECollisionChannel> Channel = ECC_Visibility;
+
+	bool operator==(const FTrickyElevationSettings& Other) const
+	{
+		return SampleStep == Other.SampleStep
+			&& TraceRange == Other.TraceRange
+			&& Channel == Other.Channel;
+	}
+
+	bool operator!=(const FTrickyElevationSettings& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+struct FTrickyElevationSection
+{
+	/**
+	 * Locations on the ruler in world space, the surface is traced under and above each of them.
+	 */
+	TArray<FVector> Samples;
+
+	/**
+	 * Handles of the traces in flight, indexed by sample. Zero means the result has arrived.
+	 */
+	TArray<uint64> TraceHandles;
+
+	/**
+	 * Surface locations, valid only for the samples with a hit.
+	 */
+	TArray<FVector> SurfacePoints;
+
+	TBitArray<> HitSamples;
+
+	/**
+	 * Actors hit by the traces, moving them invalidates the section.
+	 */
+	TArray<TWeakObjectPtr<const AActor>> HitActors;
+
+	/**
+	 * Volume covered by the traces of the section.
+	 */
+	FBox Bounds{ForceInit};
+};
+
+struct FTrickyElevationStats
+{
+	/**
+	 * Sum of the height gained along the ruler in cm.
+	 */
+	double Climb = 0.0;
+
+	/**
+	 * Sum of the height lost along the ruler in cm.
+	 */
+	double Descent = 0.0;
+
+	/**
+	 * The steepest slope between two neighbour samples in degrees.
+	 */
+	double MaxSlope = 0.0;
+
+	double MinHeight = 0.0;
+
+	double MaxHeight = 0.0;
+
+	int32 HitSamplesNum = 0;
+};
+
+/**
+ * Samples the surface height along a spline or a line with batched async line traces.
+ * The results are cached per section, only the sections with changed samples or changed geometry under them
+ * are traced again.
+ */
+class FTrickyElevationProfile : public TSharedFromThis<FTrickyElevationProfile>
+{
+public:
+	/**
+	 * Samples the spline. Only the sections next to changed spline points are traced again.
+	 */
+	void Update(UWorld* World,
+	            const USplineComponent* SplineComponent,
+	            const FTrickyElevationSettings& Settings,
+	            const bool bForceFullUpdate = false);
+
+	/**
+	 * Samples the line split into sections of equal length. The sections which keep their samples,
+	 * e.g. when only the length of the line changes, aren't traced again.
+	 */
+	void Update(UWorld* World,
+	            const FVector& Start,
+	            const FVector& Direction,
+	            const double Length,
+	            const AActor* Owner,
+	            const FTrickyElevationSettings& Settings,
+	            const bool bForceFullUpdate = false);
+
+	/**
+	 * Traces again the sections hit by the actor or overlapping its bounds.
+	 */
+	void Invalidate(UWorld* World, const AActor* ChangedActor);
+
+	void Reset();
+
+	/**
+	 * Returns true once after some trace results have changed.
+	 */
+	bool ConsumeResultsChanged();
+
+	bool IsTracing() const { return PendingTracesNum > 0; }
+
+	/**
+	 * Returns the stats of the current results, they're recalculated only after the results change.
+	 */
+	const FTrickyElevationStats& GetStats() const;
+
+	/**
+	 * Adds the climb, the descent in meters and the max slope in degrees.
+	 */
+	void GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const;
+
+	/**
+	 * Formats the stats for the debug text of the ruler.
+	 */
+	FString GetStatsText() const;
+
+	/**
+	 * Builds the lines over the surface colored by the slope.
+	 */
+	void BuildSlopeLines(const FElevationProfileProperties& Properties,
+	                     TArray<FDebugRenderSceneProxy::FDebugLine>& OutLines) const;
+
+	/**
+	 * Calls the function for each pair of neighbour surface points with the slope between them in degrees.
+	 */
+	void ForEachSlopeSegment(TFunctionRef<void(const FVector&, const FVector&, double)> Function) const;
+
+private:
+	constexpr static int32 MaxSegmentsPerSection = 256;
+
+	FTrickySplineChangeTracker ChangeTracker;
+
+	TArray<FTrickyElevationSection> Sections;
+
+	FTrickyElevationSettings CachedSettings;
+
+	FTransform CachedTransform = FTransform::Identity;
+
+	TWeakObjectPtr<const AActor> IgnoredActor;
+
+	mutable FTrickyElevationStats CachedStats;
+
+	int32 PendingTracesNum = 0;
+
+	bool bHaveResultsChanged = false;
+
+	mutable bool bAreStatsDirty = true;
+
+	void MarkResultsChanged();
+
+	FTrickyElevationStats CalculateStats() const;
+
+	/**
+	 * Drops the sections and forgets the traces in flight.
+	 */
+	void ResetSections(const int32 SectionsNum);
+
+	void TraceSection(UWorld* World, const int32 SectionIndex);
+
+	void HandleTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+};
@@ -0,0 +1,275 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyGridComponent.h"
+
+#include "DebugRenderSceneProxy.h"
+#include "SceneView.h"
+#include "TrickyRulersMemory.h"
+
+class FTrickyGridSceneProxy : public FDebugRenderSceneProxy
+{
+public:
+	FTrickyGridSceneProxy(const UPrimitiveComponent* InComponent,
+	                      const FTrickyGridGeometryPtr& InGeometry,
+	                      const FTrickyGridSettings& InSettings,
+	                      const FTrickyRulerGroupStatePtr& InGroupState)
+		: FDebugRenderSceneProxy(InComponent),
+		  Geometry(InGeometry),
+		  Settings(InSettings),
+		  GroupState(InGroupState)
+	{
+		DrawType = EDrawType::WireMesh;
+		ViewFlagName = TEXT("Editor");
+		ViewFlagIndex = static_cast<uint32>(FEngineShowFlags::FindIndexByName(*ViewFlagName));
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views,
+	                                    const FSceneViewFamily& ViewFamily,
+	                                    uint32 VisibilityMap,
+	                                    FMeshElementCollector& Collector) const override
+	{
+		if (GroupState.IsValid() && GroupState->IsHidden())
+		{
+			return;
+		}
+
+		const FColor LineColor = GroupState.IsValid() ? GroupState->GetColor(Settings.Color) : Settings.Color;
+
+		// Cell size is set by the ruler properties, so the actor scale is ignored.
+		FMatrix LocalToWorld = GetLocalToWorld();
+		LocalToWorld.RemoveScaling();
+		const TArray<FVector3f>& Points = Geometry->LinePoints;
+		const int32 MajorLinesNum = Geometry->LevelLinesNum[1];
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+		{
+			if (!(VisibilityMap & (1 << ViewIndex)))
+			{
+				continue;
+			}
+
+			const int32 LinesNum = Geometry->LevelLinesNum[GetMinLevel(Views[ViewIndex])];
+			FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
+			PDI->AddReserveLines(SDPG_World, LinesNum, false, true);
+
+			for (int32 i = 0; i < LinesNum; ++i)
+			{
+				PDI->DrawLine(LocalToWorld.TransformPosition(FVector(Points[i * 2])),
+				              LocalToWorld.TransformPosition(FVector(Points[i * 2 + 1])),
+				              LineColor,
+				              SDPG_World,
+				              i < MajorLinesNum ? Settings.MajorThickness : Settings.Thickness,
+				              0.f,
+				              true);
+			}
+		}
+	}
+
+private:
+	/**
+	 * Shared with the component, so recreating the proxy doesn't copy the lines.
+	 */
+	FTrickyGridGeometryPtr Geometry;
+
+	FTrickyGridSettings Settings;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::Grid};
+
+	/**
+	 * Finds the finest level with the lines not closer than the min spacing at the nearest point of the grid.
+	 */
+	int32 GetMinLevel(const FSceneView* View) const
+	{
+		const FMatrix& Projection = View->ViewMatrices.GetProjectionMatrix();
+		double PixelsPerUnit = Projection.M[0][0] * View->UnscaledViewRect.Width() * 0.5;
+
+		if (View->IsPerspectiveProjection())
+		{
+			const FVector ViewOrigin = View->ViewMatrices.GetViewOrigin();
+			const double Distance = FMath::Sqrt(GetBounds().GetBox().ComputeSquaredDistanceToPoint(ViewOrigin));
+			PixelsPerUnit /= FMath::Max(Distance, static_cast<double>(Settings.CellSize));
+		}
+
+		double Spacing = Settings.CellSize * PixelsPerUnit;
+		int32 Level = 0;
+
+		while (Level < FTrickyGridGeometry::MaxLevel && Spacing < Settings.MinLineSpacing)
+		{
+			Spacing *= Settings.MajorLineInterval;
+			++Level;
+		}
+
+		return Level;
+	}
+};
+
+TSharedRef<const FTrickyGridGeometry, ESPMode::ThreadSafe> FTrickyGridGeometry::Build(
+	const FTrickyGridSettings& Settings)
+{
+	const TSharedRef<FTrickyGridGeometry, ESPMode::ThreadSafe> Geometry =
+		MakeShared<FTrickyGridGeometry, ESPMode::ThreadSafe>();
+	TArray<FVector3f> LevelPoints[MaxLevel + 1];
+	const FIntVector MinCell = Settings.FirstCell;
+	const FIntVector MaxCell = Settings.FirstCell + Settings.CellsNum;
+	const float CellSize = Settings.CellSize;
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		// Lines along the axis without cells would be points.
+		if (Settings.CellsNum[Axis] <= 0)
+		{
+			continue;
+		}
+
+		const int32 AxisU = (Axis + 1) % 3;
+		const int32 AxisV = (Axis + 2) % 3;
+
+		for (int32 U = MinCell[AxisU]; U <= MaxCell[AxisU]; ++U)
+		{
+			const int32 LevelU = GetLineLevel(U, Settings.MajorLineInterval);
+
+			for (int32 V = MinCell[AxisV]; V <= MaxCell[AxisV]; ++V)
+			{
+				FVector3f Start = FVector3f::ZeroVector;
+				Start[Axis] = MinCell[Axis] * CellSize;
+				Start[AxisU] = U * CellSize;
+				Start[AxisV] = V * CellSize;
+				FVector3f End = Start;
+				End[Axis] = MaxCell[Axis] * CellSize;
+
+				TArray<FVector3f>& Points = LevelPoints[FMath::Min(LevelU, GetLineLevel(V, Settings.MajorLineInterval))];
+				Points.Add(Start);
+				Points.Add(End);
+			}
+		}
+	}
+
+	int32 PointsNum = 0;
+
+	for (const TArray<FVector3f>& Points : LevelPoints)
+	{
+		PointsNum += Points.Num();
+	}
+
+	Geometry->LinePoints.Reserve(PointsNum);
+
+	for (int32 Level = MaxLevel; Level >= 0; --Level)
+	{
+		Geometry->LinePoints.Append(LevelPoints[Level]);
+		Geometry->LevelLinesNum[Level] = Geometry->LinePoints.Num() / 2;
+	}
+
+	Geometry->Bounds = FBox3f(FVector3f(MinCell) * CellSize, FVector3f(MaxCell) * CellSize);
+	return Geometry;
+}
+
+int32 FTrickyGridGeometry::GetLineLevel(const int32 Index, const int32 MajorLineInterval)
+{
+	int32 Value = FMath::Abs(Index);
+
+	if (Value == 0)
+	{
+		return MaxLevel;
+	}
+
+	int32 Level = 0;
+
+	while (Level < MaxLevel && MajorLineInterval > 1 && Value % MajorLineInterval == 0)
+	{
+		Value /= MajorLineInterval;
+		++Level;
+	}
+
+	return Level;
+}
+
+UTrickyGridComponent::UTrickyGridComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bIsEditorOnly = true;
+}
+
+void UTrickyGridComponent::SetGrid(const FTrickyGridSettings& InSettings)
+{
+	FTrickyGridGeometryPtr NewGeometry;
+
+	if (NeedsGeometry(InSettings))
+	{
+		NewGeometry = FTrickyGridGeometry::Build(InSettings);
+	}
+
+	SetGrid(InSettings, NewGeometry);
+}
+
+void UTrickyGridComponent::SetGrid(const FTrickyGridSettings& InSettings, const FTrickyGridGeometryPtr& InGeometry)
+{
+	if (InGeometry.IsValid())
+	{
+		Geometry = InGeometry;
+	}
+
+	Settings = InSettings;
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+bool UTrickyGridComponent::NeedsGeometry(const FTrickyGridSettings& InSettings) const
+{
+	return !Geometry.IsValid() || !Settings.HasSameLines(InSettings);
+}
+
+void UTrickyGridComponent::ClearGrid()
+{
+	if (!Geometry.IsValid())
+	{
+		return;
+	}
+
+	Geometry.Reset();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTrickyGridComponent::SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState)
+{
+	if (GroupState == InGroupState)
+	{
+		return;
+	}
+
+	GroupState = InGroupState;
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UTrickyGridComponent::CreateDebugSceneProxy()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (!Geometry.IsValid() || Geometry->LinePoints.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return new FTrickyGridSceneProxy(this, Geometry, Settings, GroupState);
+}
+
+FBoxSphereBounds UTrickyGridComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!Geometry.IsValid() || !Geometry->Bounds.IsValid)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+	}
+
+	FTransform UnscaledLocalToWorld = LocalToWorld;
+	UnscaledLocalToWorld.SetScale3D(FVector::OneVector);
+	return FBoxSphereBounds(FBox(Geometry->Bounds).TransformBy(UnscaledLocalToWorld));
+}
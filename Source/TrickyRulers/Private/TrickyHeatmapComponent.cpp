@@ -0,0 +1,287 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyHeatmapComponent.h"
+
+#include "DebugRenderSceneProxy.h"
+#include "Engine/Engine.h"
+#include "LocalVertexFactory.h"
+#include "Materials/Material.h"
+#include "RawIndexBuffer.h"
+#include "RenderingThread.h"
+#include "SceneView.h"
+#include "StaticMeshResources.h"
+#include "TrickyRulersMemory.h"
+
+
+/**
+ * Keeps the grid in static buffers, so the frames only submit the mesh and the colors are uploaded once per change.
+ */
+class FTrickyHeatmapSceneProxy : public FDebugRenderSceneProxy
+{
+public:
+	FTrickyHeatmapSceneProxy(const UPrimitiveComponent* InComponent,
+	                         const FTrickyHeatmapGeometryPtr& InGeometry,
+	                         const FTrickyHeatmapColorsPtr& InColors)
+		: FDebugRenderSceneProxy(InComponent),
+		  Geometry(InGeometry),
+		  Colors(InColors),
+		  VertexFactory(GetScene().GetFeatureLevel(), "FTrickyHeatmapSceneProxy"),
+		  MaterialProxy(GEngine->VertexColorMaterial->GetRenderProxy())
+	{
+		DrawType = EDrawType::SolidMesh;
+		ViewFlagName = TEXT("Editor");
+		ViewFlagIndex = static_cast<uint32>(FEngineShowFlags::FindIndexByName(*ViewFlagName));
+	}
+
+	virtual ~FTrickyHeatmapSceneProxy() override
+	{
+		VertexBuffers.PositionVertexBuffer.ReleaseResource();
+		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+		VertexBuffers.ColorVertexBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override
+	{
+		LLM_SCOPE_BYTAG(TrickyRulers);
+
+		FDebugRenderSceneProxy::CreateRenderThreadResources(RHICmdList);
+
+		const TArray<FVector3f>& Positions = Geometry->Positions;
+		const TArray<FColor>& NodeColors = *Colors;
+		const FVector2f UVStep(1.f / FMath::Max(Geometry->NodesNum.X - 1, 1),
+		                       1.f / FMath::Max(Geometry->NodesNum.Y - 1, 1));
+
+		VertexBuffers.PositionVertexBuffer.Init(Positions.Num(), false);
+		VertexBuffers.StaticMeshVertexBuffer.Init(Positions.Num(), 1, false);
+		VertexBuffers.ColorVertexBuffer.Init(Positions.Num(), false);
+
+		for (int32 i = 0; i < Positions.Num(); ++i)
+		{
+			const FVector2f UV((i % Geometry->NodesNum.X) * UVStep.X, (i / Geometry->NodesNum.X) * UVStep.Y);
+			VertexBuffers.PositionVertexBuffer.VertexPosition(i) = Positions[i];
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(i,
+			                                                      FVector3f::ForwardVector,
+			                                                      FVector3f::RightVector,
+			                                                      FVector3f::UpVector);
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, 0, UV);
+			VertexBuffers.ColorVertexBuffer.VertexColor(i) = NodeColors[i];
+		}
+
+		IndexBuffer.SetIndices(Geometry->Indices, EIndexBufferStride::Force32Bit);
+
+		VertexBuffers.PositionVertexBuffer.InitResource(RHICmdList);
+		VertexBuffers.StaticMeshVertexBuffer.InitResource(RHICmdList);
+		VertexBuffers.ColorVertexBuffer.InitResource(RHICmdList);
+		IndexBuffer.InitResource(RHICmdList);
+
+		FLocalVertexFactory::FDataType Data;
+		VertexBuffers.PositionVertexBuffer.BindPositionVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindTangentVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindLightMapVertexBuffer(&VertexFactory, Data, 0);
+		VertexBuffers.ColorVertexBuffer.BindColorVertexBuffer(&VertexFactory, Data);
+		VertexFactory.SetData(RHICmdList, Data);
+		VertexFactory.InitResource(RHICmdList);
+	}
+
+	/**
+	 * Uploads the new colors into the existing color buffer, the grid isn't touched.
+	 */
+	void UpdateColors_RenderThread(FRHICommandListImmediate& RHICmdList, const FTrickyHeatmapColorsPtr& InColors)
+	{
+		check(IsInRenderingThread());
+
+		FRHIBuffer* ColorBuffer = VertexBuffers.ColorVertexBuffer.VertexBufferRHI;
+
+		if (!ColorBuffer || !InColors.IsValid() || InColors->Num() != Geometry->Positions.Num())
+		{
+			return;
+		}
+
+		Colors = InColors;
+		const uint32 Size = Colors->Num() * sizeof(FColor);
+		void* Data = RHICmdList.LockBuffer(ColorBuffer, 0, Size, RLM_WriteOnly);
+		FMemory::Memcpy(Data, Colors->GetData(), Size);
+		RHICmdList.UnlockBuffer(ColorBuffer);
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		FPrimitiveViewRelevance Result = FDebugRenderSceneProxy::GetViewRelevance(View);
+		Result.bOpaque = true;
+		Result.bRenderInMainPass = true;
+		return Result;
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views,
+	                                    const FSceneViewFamily& ViewFamily,
+	                                    uint32 VisibilityMap,
+	                                    FMeshElementCollector& Collector) const override
+	{
+		if (IndexBuffer.GetNumIndices() == 0)
+		{
+			return;
+		}
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+		{
+			if (!(VisibilityMap & (1 << ViewIndex)))
+			{
+				continue;
+			}
+
+			FMeshBatch& Mesh = Collector.AllocateMesh();
+			Mesh.VertexFactory = &VertexFactory;
+			Mesh.MaterialRenderProxy = MaterialProxy;
+			Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+			Mesh.Type = PT_TriangleList;
+			Mesh.DepthPriorityGroup = SDPG_World;
+			Mesh.bCanApplyViewModeOverrides = false;
+
+			FMeshBatchElement& BatchElement = Mesh.Elements[0];
+			BatchElement.IndexBuffer = &IndexBuffer;
+			BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+			BatchElement.FirstIndex = 0;
+			BatchElement.NumPrimitives = IndexBuffer.GetNumIndices() / 3;
+			BatchElement.MinVertexIndex = 0;
+			BatchElement.MaxVertexIndex = VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
+
+			Collector.AddMesh(ViewIndex, Mesh);
+		}
+	}
+
+private:
+	FTrickyHeatmapGeometryPtr Geometry;
+
+	FTrickyHeatmapColorsPtr Colors;
+
+	FStaticMeshVertexBuffers VertexBuffers;
+
+	FRawStaticIndexBuffer IndexBuffer;
+
+	FLocalVertexFactory VertexFactory;
+
+	const FMaterialRenderProxy* MaterialProxy = nullptr;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::Heatmap};
+};
+
+TSharedRef<const FTrickyHeatmapGeometry, ESPMode::ThreadSafe> FTrickyHeatmapGeometry::Build(
+	const FIntPoint& InNodesNum,
+	const float CellSize)
+{
+	TSharedRef<FTrickyHeatmapGeometry, ESPMode::ThreadSafe> Geometry = MakeShared<
+		FTrickyHeatmapGeometry, ESPMode::ThreadSafe>();
+	Geometry->NodesNum = InNodesNum;
+
+	const FVector3f Origin = FVector3f(-(InNodesNum.X - 1) * CellSize, -(InNodesNum.Y - 1) * CellSize, 0.f) * 0.5f;
+	Geometry->Positions.Reserve(InNodesNum.X * InNodesNum.Y);
+
+	for (int32 Y = 0; Y < InNodesNum.Y; ++Y)
+	{
+		for (int32 X = 0; X < InNodesNum.X; ++X)
+		{
+			const FVector3f& Position = Geometry->Positions.Add_GetRef(Origin + FVector3f(X * CellSize, Y * CellSize, 0.f));
+			Geometry->Bounds += Position;
+		}
+	}
+
+	Geometry->Indices.Reserve((InNodesNum.X - 1) * (InNodesNum.Y - 1) * 6);
+
+	for (int32 Y = 0; Y < InNodesNum.Y - 1; ++Y)
+	{
+		for (int32 X = 0; X < InNodesNum.X - 1; ++X)
+		{
+			const uint32 Corner = Y * InNodesNum.X + X;
+			const uint32 NextRowCorner = Corner + InNodesNum.X;
+			Geometry->Indices.Append({Corner, NextRowCorner, Corner + 1, Corner + 1, NextRowCorner, NextRowCorner + 1});
+		}
+	}
+
+	return Geometry;
+}
+
+UTrickyHeatmapComponent::UTrickyHeatmapComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bIsEditorOnly = true;
+}
+
+void UTrickyHeatmapComponent::SetGrid(const FIntPoint& InNodesNum, const float InCellSize)
+{
+	if (Geometry.IsValid() && Geometry->NodesNum == InNodesNum && CellSize == InCellSize)
+	{
+		return;
+	}
+
+	CellSize = InCellSize;
+	Geometry = FTrickyHeatmapGeometry::Build(InNodesNum, InCellSize);
+	Colors.Reset();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTrickyHeatmapComponent::SetColors(TArray<FColor>&& InColors)
+{
+	const bool bHadColors = Colors.IsValid();
+	Colors = MakeShared<const TArray<FColor>, ESPMode::ThreadSafe>(MoveTemp(InColors));
+
+	// The proxy exists only for the current grid, so it only needs the new colors.
+	if (!bHadColors || !SceneProxy || !Geometry.IsValid() || Colors->Num() != Geometry->Positions.Num())
+	{
+		MarkRenderStateDirty();
+		return;
+	}
+
+	FTrickyHeatmapSceneProxy* HeatmapProxy = static_cast<FTrickyHeatmapSceneProxy*>(SceneProxy);
+
+	ENQUEUE_RENDER_COMMAND(TrickyUpdateHeatmapColors)(
+		[HeatmapProxy, NewColors = Colors](FRHICommandListImmediate& RHICmdList)
+		{
+			HeatmapProxy->UpdateColors_RenderThread(RHICmdList, NewColors);
+		});
+}
+
+void UTrickyHeatmapComponent::ClearHeatmap()
+{
+	if (!Geometry.IsValid())
+	{
+		return;
+	}
+
+	Geometry.Reset();
+	Colors.Reset();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UTrickyHeatmapComponent::CreateDebugSceneProxy()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (!Geometry.IsValid() || !Colors.IsValid() || Colors->Num() != Geometry->Positions.Num())
+	{
+		return nullptr;
+	}
+
+	return new FTrickyHeatmapSceneProxy(this, Geometry, Colors);
+}
+
+FBoxSphereBounds UTrickyHeatmapComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!Geometry.IsValid() || !Geometry->Bounds.IsValid)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+	}
+
+	return FBoxSphereBounds(FBox(Geometry->Bounds).TransformBy(LocalToWorld));
+}
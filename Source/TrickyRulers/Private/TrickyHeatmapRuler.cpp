@@ -0,0 +1,218 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyHeatmapRuler.h"
+
+#include "EngineUtils.h"
+#include "TrickyDebugTextComponent.h"
+#include "TrickyDistanceField.h"
+#include "TrickyHeatmapComponent.h"
+#include "Components/BillboardComponent.h"
+#include "Engine/Texture2D.h"
+
+
+ATrickyHeatmapRuler::ATrickyHeatmapRuler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bIsEditorOnlyActor = true;
+
+	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
+	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+
+	HeatmapComponent = CreateEditorOnlyDefaultSubobject<UTrickyHeatmapComponent>(TEXT("Heatmap"));
+	HeatmapComponent->SetupAttachment(GetRootComponent());
+
+	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
+
+	if (BillboardComponent)
+	{
+		BillboardComponent->SetupAttachment(GetRootComponent());
+		UTexture2D* BillboardTexture = LoadObject<UTexture2D>(this, TEXT("/Engine/EditorResources/S_TargetPoint"));
+		BillboardComponent->SetSprite(BillboardTexture);
+		SpriteScale = 0.5;
+	}
+
+	DistanceField = MakeUnique<FTrickyDistanceField>();
+}
+
+ATrickyHeatmapRuler::~ATrickyHeatmapRuler() = default;
+
+bool ATrickyHeatmapRuler::ShouldTickIfViewportsOnly() const
+{
+	return true;
+}
+
+void ATrickyHeatmapRuler::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	ResetField();
+}
+
+void ATrickyHeatmapRuler::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	if (HasAnyFlags(RF_ClassDefaultObject) || !GetWorld())
+	{
+		return;
+	}
+
+	BindTargets();
+}
+
+void ATrickyHeatmapRuler::PostUnregisterAllComponents()
+{
+	UnbindTargets();
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+void ATrickyHeatmapRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BindTargets();
+	ResetField();
+}
+
+void ATrickyHeatmapRuler::PostEditMove(bool bFinished)
+{
+	Super::PostEditMove(bFinished);
+
+	ResetField();
+}
+#endif
+
+void ATrickyHeatmapRuler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateField();
+
+	// Nothing has to be done until one of the targets moves.
+	SetActorTickEnabled(false);
+}
+
+void ATrickyHeatmapRuler::RefreshTargets()
+{
+	if (!TargetClass || !GetWorld())
+	{
+		return;
+	}
+
+	for (TActorIterator<AActor> It(GetWorld(), TargetClass); It; ++It)
+	{
+		if (*It != this)
+		{
+			Targets.AddUnique(*It);
+		}
+	}
+
+	BindTargets();
+	SetActorTickEnabled(true);
+}
+
+void ATrickyHeatmapRuler::BindTargets()
+{
+	UnbindTargets();
+
+	for (const AActor* Target : Targets)
+	{
+		USceneComponent* Component = IsValid(Target) ? Target->GetRootComponent() : nullptr;
+
+		if (Component && !TransformHandles.Contains(Component))
+		{
+			TransformHandles.Add(Component,
+			                     Component->TransformUpdated.AddUObject(
+				                     this, &ATrickyHeatmapRuler::HandleTransformUpdated));
+		}
+	}
+
+	SetActorTickEnabled(true);
+}
+
+void ATrickyHeatmapRuler::UnbindTargets()
+{
+	for (const TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>& Handle : TransformHandles)
+	{
+		if (USceneComponent* Component = Handle.Key.Get())
+		{
+			Component->TransformUpdated.Remove(Handle.Value);
+		}
+	}
+
+	TransformHandles.Reset();
+}
+
+void ATrickyHeatmapRuler::ResetField()
+{
+	bIsFieldDirty = true;
+	SetActorTickEnabled(true);
+}
+
+void ATrickyHeatmapRuler::UpdateField()
+{
+	const float Step = FMath::Max3(CellSize, LengthX / (MaxNodesPerAxis - 1), LengthY / (MaxNodesPerAxis - 1));
+	const FIntPoint NodesNum(FMath::CeilToInt32(LengthX / Step) + 1, FMath::CeilToInt32(LengthY / Step) + 1);
+
+	if (bIsFieldDirty)
+	{
+		DistanceField->Init(NodesNum, Step, GetActorTransform());
+		HeatmapComponent->SetGrid(DistanceField->GetNodesNum(), Step);
+		bIsFieldDirty = false;
+	}
+
+	TArray<FVector> TargetLocations;
+	TargetLocations.Reserve(Targets.Num());
+
+	for (const AActor* Target : Targets)
+	{
+		if (IsValid(Target))
+		{
+			TargetLocations.Add(Target->GetActorLocation());
+		}
+	}
+
+	DistanceField->SetTargets(TargetLocations);
+	DistanceField->SetColorRamp(NearColor, FarColor, MaxDistance);
+
+	if (!DistanceField->Update())
+	{
+		return;
+	}
+
+	// The colors of the recomputed tiles are updated on the worker threads too, only the copy is left here.
+	const int32 NodesNum = DistanceField->GetDistances().Num();
+	HeatmapComponent->SetColors(TArray<FColor>(DistanceField->GetColors()));
+
+	const bool bHasTargets = TargetLocations.Num() > 0;
+	Coverage = NodesNum > 0 ? DistanceField->GetCoveredNum() * 100.f / NodesNum : 0.f;
+	MaxGap = bHasTargets ? DistanceField->GetMaxNodeDistance() / 100.f : 0.f;
+
+	TArray<FTrickyDebugTextData> DebugTextData;
+
+	if (bShowDebugText)
+	{
+		FTrickyDebugTextData& Label = DebugTextData.AddDefaulted_GetRef();
+		Label.Text = bHasTargets
+			             ? FString::Printf(TEXT("Coverage: %.1f%%\nMax Gap: %.2f m"), Coverage, MaxGap)
+			             : TEXT("No targets");
+		Label.Color = FarColor;
+		Label.TextScale = DebugTextScale;
+	}
+
+	TrickyDebugTextComponent->SetDebugLabels(DebugTextData);
+	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+}
+
+void ATrickyHeatmapRuler::HandleTransformUpdated(USceneComponent* Component,
+                                                 EUpdateTransformFlags Flags,
+                                                 ETeleportType Teleport)
+{
+	SetActorTickEnabled(true);
+}
@@ -0,0 +1,88 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyLoopAreaCache.h"
+
+#include "TrickyRulersGeometry.h"
+#include "Components/SplineComponent.h"
+
+void FTrickyLoopAreaCache::Update(const USplineComponent* SplineComponent,
+                                  const ERulerPlane Plane,
+                                  const int32 SamplesPerSection)
+{
+	TBitArray<> DirtySections;
+	bool bIsFullUpdate = ChangeTracker.Update(SplineComponent, DirtySections);
+
+	if (Plane != CachedPlane || SamplesPerSection != CachedSamplesPerSection)
+	{
+		bIsFullUpdate = true;
+		DirtySections.Init(true, DirtySections.Num());
+	}
+
+	CachedPlane = Plane;
+	CachedSamplesPerSection = SamplesPerSection;
+
+	if (bIsFullUpdate)
+	{
+		SectionSums.Init(0.0, DirtySections.Num());
+	}
+
+	for (TConstSetBitIterator<> It(DirtySections); It; ++It)
+	{
+		const int32 SectionIndex = It.GetIndex();
+		SectionSums[SectionIndex] = CalculateSectionSum(SplineComponent, SectionIndex, Plane, SamplesPerSection);
+	}
+
+	// Summing up is cheap compared to sampling and doesn't accumulate errors like incremental updates.
+	TotalSum = 0.0;
+
+	for (const double SectionSum : SectionSums)
+	{
+		TotalSum += SectionSum;
+	}
+}
+
+void FTrickyLoopAreaCache::Reset()
+{
+	ChangeTracker.Reset();
+	SectionSums.Empty();
+	TotalSum = 0.0;
+	CachedSamplesPerSection = 0;
+}
+
+double FTrickyLoopAreaCache::CalculateSectionSum(const USplineComponent* SplineComponent,
+                                                 const int32 SectionIndex,
+                                                 const ERulerPlane Plane,
+                                                 const int32 SamplesPerSection)
+{
+	const bool bIsLinear = SplineComponent->GetSplinePointType(SectionIndex) == ESplinePointType::Linear;
+	const int32 Samples = bIsLinear ? 1 : FMath::Max(SamplesPerSection, 1);
+	SamplesX.SetNumUninitialized(Samples + 1, EAllowShrinking::No);
+	SamplesY.SetNumUninitialized(Samples + 1, EAllowShrinking::No);
+
+	for (int32 i = 0; i <= Samples; ++i)
+	{
+		const float InputKey = static_cast<float>(SectionIndex) + static_cast<float>(i) / Samples;
+		const FVector Location = SplineComponent->GetLocationAtSplineInputKey(InputKey, ESplineCoordinateSpace::Local);
+
+		switch (Plane)
+		{
+		case ERulerPlane::XY:
+			SamplesX[i] = Location.X;
+			SamplesY[i] = Location.Y;
+			break;
+
+		case ERulerPlane::XZ:
+			SamplesX[i] = Location.X;
+			SamplesY[i] = Location.Z;
+			break;
+
+		case ERulerPlane::YZ:
+			SamplesX[i] = Location.Y;
+			SamplesY[i] = Location.Z;
+			break;
+		}
+	}
+
+	return TrickyRulersGeometry::CalculateShoelaceSum(SamplesX, SamplesY);
+}
@@ -0,0 +1,83 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyMeasurementConstraint.h"
+
+#include "Misc/DataValidation.h"
+
+
+bool FTrickyMeasurementConstraint::Check(TConstArrayView<FTrickyMeasurement> Measurements,
+                                         FString& OutViolation) const
+{
+	const FString RuleName = Description.IsEmpty() ? Measurement.ToString() : Description;
+	const FTrickyMeasurement* Found = Measurements.FindByPredicate([this](const FTrickyMeasurement& Other)
+	{
+		return Other.Name == Measurement;
+	});
+
+	if (!Found)
+	{
+		OutViolation = FString::Printf(TEXT("%s: %s isn't measured by the ruler"),
+		                               *RuleName,
+		                               *Measurement.ToString());
+		return false;
+	}
+
+	if (bUseMin && Found->Value < Min)
+	{
+		OutViolation = FString::Printf(TEXT("%s: %s %.2f < %.2f"), *RuleName, *Measurement.ToString(), Found->Value, Min);
+		return false;
+	}
+
+	if (bUseMax && Found->Value > Max)
+	{
+		OutViolation = FString::Printf(TEXT("%s: %s %.2f > %.2f"), *RuleName, *Measurement.ToString(), Found->Value, Max);
+		return false;
+	}
+
+	return true;
+}
+
+void FTrickyMeasurementConstraint::CheckAll(TConstArrayView<FTrickyMeasurementConstraint> Constraints,
+                                           TConstArrayView<FTrickyMeasurement> Measurements,
+                                           TArray<FString>& OutViolations)
+{
+	FString Violation;
+
+	for (const FTrickyMeasurementConstraint& Constraint : Constraints)
+	{
+		if (!Constraint.Check(Measurements, Violation))
+		{
+			OutViolations.Add(MoveTemp(Violation));
+		}
+	}
+}
+
+void FTrickyMeasurementConstraint::CheckAll(TConstArrayView<FTrickyMeasurementConstraint> Constraints,
+                                           TFunctionRef<void(TArray<FTrickyMeasurement>&)> GetMeasurements,
+                                           TArray<FString>& OutViolations)
+{
+	if (Constraints.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FTrickyMeasurement> Measurements;
+	GetMeasurements(Measurements);
+	CheckAll(Constraints, Measurements, OutViolations);
+}
+
+#if WITH_EDITOR
+EDataValidationResult FTrickyMeasurementConstraint::Validate(TConstArrayView<FString> Violations,
+                                                             const FString& ActorName,
+                                                             FDataValidationContext& Context,
+                                                             const EDataValidationResult Result)
+{
+	for (const FString& Violation : Violations)
+	{
+		Context.AddError(FText::FromString(FString::Printf(TEXT("%s: %s"), *ActorName, *Violation)));
+	}
+
+	return Violations.Num() > 0 ? EDataValidationResult::Invalid : Result;
+}
+#endif
@@ -0,0 +1,297 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyNavPathRuler.h"
+
+#include "NavigationData.h"
+#include "NavigationSystem.h"
+#include "TrickyDebugTextComponent.h"
+#include "Components/BillboardComponent.h"
+#include "Engine/Texture2D.h"
+#include "NavFilters/NavigationQueryFilter.h"
+
+
+ATrickyNavPathRuler::ATrickyNavPathRuler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bIsEditorOnlyActor = true;
+
+	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
+	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
+
+	if (BillboardComponent)
+	{
+		BillboardComponent->SetupAttachment(GetRootComponent());
+		UTexture2D* BillboardTexture = LoadObject<UTexture2D>(this, TEXT("/Engine/EditorResources/S_TargetPoint"));
+		BillboardComponent->SetSprite(BillboardTexture);
+		SpriteScale = 0.5;
+	}
+}
+
+bool ATrickyNavPathRuler::ShouldTickIfViewportsOnly() const
+{
+	return true;
+}
+
+#if WITH_EDITOR
+void ATrickyNavPathRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bIsPathRequired = true;
+	UpdateDimensions();
+}
+#endif
+
+void ATrickyNavPathRuler::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AbortPathRequest();
+	ClearPath();
+	UnbindFromNavigation();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATrickyNavPathRuler::Destroyed()
+{
+	AbortPathRequest();
+	ClearPath();
+	UnbindFromNavigation();
+
+	Super::Destroyed();
+}
+
+void ATrickyNavPathRuler::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	BindToNavigation();
+}
+
+void ATrickyNavPathRuler::PostUnregisterAllComponents()
+{
+	UnbindFromNavigation();
+
+	Super::PostUnregisterAllComponents();
+}
+
+void ATrickyNavPathRuler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (QueryId == INVALID_NAVQUERYID && (bIsPathRequired || HasEndPointsChanged()))
+	{
+		RequestPath();
+	}
+
+	DrawPath();
+}
+
+FVector ATrickyNavPathRuler::GetEndLocation() const
+{
+	return IsValid(TargetActor) ? TargetActor->GetActorLocation() : GetActorTransform().TransformPosition(EndPoint);
+}
+
+bool ATrickyNavPathRuler::HasEndPointsChanged() const
+{
+	return !QueriedStart.Equals(GetActorLocation(), EndPointTolerance)
+		|| !QueriedEnd.Equals(GetEndLocation(), EndPointTolerance);
+}
+
+void ATrickyNavPathRuler::RequestPath()
+{
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!NavigationSystem)
+	{
+		return;
+	}
+
+	BindToNavigation();
+
+	bIsPathRequired = false;
+	QueriedStart = GetActorLocation();
+	QueriedEnd = GetEndLocation();
+
+	const FNavAgentProperties& AgentProperties = FNavAgentProperties::DefaultProperties;
+	const ANavigationData* NavData = NavigationSystem->GetNavDataForProps(AgentProperties);
+
+	if (!NavData)
+	{
+		ClearPath();
+		UpdateDimensions();
+		return;
+	}
+
+	FPathFindingQuery Query(this,
+	                        *NavData,
+	                        QueriedStart,
+	                        QueriedEnd,
+	                        UNavigationQueryFilter::GetQueryFilter(*NavData, this, FilterClass));
+	Query.SetAllowPartialPaths(bAllowPartialPath);
+
+	auto HandlePathFound = [this](const uint32 InQueryId,
+	                              const ENavigationQueryResult::Type Result,
+	                              FNavPathSharedPtr InPath)
+	{
+		if (InQueryId != QueryId)
+		{
+			return;
+		}
+
+		QueryId = INVALID_NAVQUERYID;
+
+		if (Result == ENavigationQueryResult::Success && InPath.IsValid())
+		{
+			SetPath(InPath);
+		}
+		else
+		{
+			ClearPath();
+		}
+
+		UpdateDimensions();
+	};
+
+	QueryId = NavigationSystem->FindPathAsync(AgentProperties,
+	                                          Query,
+	                                          FNavPathQueryDelegate::CreateWeakLambda(this, HandlePathFound));
+}
+
+void ATrickyNavPathRuler::AbortPathRequest()
+{
+	if (QueryId == INVALID_NAVQUERYID)
+	{
+		return;
+	}
+
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavigationSystem->AbortAsyncFindPathRequest(QueryId);
+	}
+
+	QueryId = INVALID_NAVQUERYID;
+}
+
+void ATrickyNavPathRuler::SetPath(FNavPathSharedPtr NewPath)
+{
+	ClearPath();
+
+	Path = NewPath;
+
+	// The path is re-queried asynchronously instead of being recalculated by the navigation data.
+	Path->EnableRecalculationOnInvalidation(false);
+	PathObserverHandle = Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateWeakLambda(
+		this,
+		[this](FNavigationPath*, const ENavPathEvent::Type Event)
+		{
+			if (Event == ENavPathEvent::Invalidated)
+			{
+				bIsPathRequired = true;
+			}
+		}));
+
+	if (ANavigationData* NavData = Path->GetNavigationDataUsed())
+	{
+		NavData->RegisterActivePath(Path);
+	}
+
+	PathPoints.Reserve(Path->GetPathPoints().Num());
+
+	for (const FNavPathPoint& PathPoint : Path->GetPathPoints())
+	{
+		PathPoints.Add(PathPoint.Location);
+	}
+
+	PathLength = Path->GetLength();
+}
+
+void ATrickyNavPathRuler::ClearPath()
+{
+	if (Path.IsValid())
+	{
+		Path->RemoveObserver(PathObserverHandle);
+		Path.Reset();
+	}
+
+	PathObserverHandle.Reset();
+	PathPoints.Reset();
+	PathLength = 0.f;
+}
+
+void ATrickyNavPathRuler::BindToNavigation()
+{
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(
+			this, &ATrickyNavPathRuler::HandleNavigationGenerationFinished);
+	}
+}
+
+void ATrickyNavPathRuler::UnbindFromNavigation()
+{
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.RemoveDynamic(
+			this, &ATrickyNavPathRuler::HandleNavigationGenerationFinished);
+	}
+}
+
+void ATrickyNavPathRuler::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	// Valid paths are re-queried by invalidation, here only the paths which weren't found are retried.
+	if (!Path.IsValid())
+	{
+		bIsPathRequired = true;
+	}
+}
+
+void ATrickyNavPathRuler::UpdateDimensions()
+{
+	const float DirectLength = FVector::Dist(QueriedStart, QueriedEnd) / 100.f;
+
+	if (Path.IsValid())
+	{
+		Dimensions = FString::Printf(TEXT("Path: %.2f m%s\nDirect: %.2f m"),
+		                             PathLength / 100.f,
+		                             Path->IsPartial() ? TEXT(" (partial)") : TEXT(""),
+		                             DirectLength);
+	}
+	else
+	{
+		Dimensions = FString::Printf(TEXT("Path: not found\nDirect: %.2f m"), DirectLength);
+	}
+
+	const FString Delimiter = TEXT("\n==========\n");
+	FTrickyDebugTextData DebugTextData;
+	DebugTextData.Text = FString::Printf(TEXT("%s%s%s%s%s"),
+	                                     *Delimiter,
+	                                     *GetActorNameOrLabel(),
+	                                     *Delimiter,
+	                                     *Dimensions,
+	                                     *Delimiter);
+	DebugTextData.Color = Color;
+	DebugTextData.TextScale = DebugTextScale;
+	TrickyDebugTextComponent->SetDebugLabel(DebugTextData);
+	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+}
+
+void ATrickyNavPathRuler::DrawPath() const
+{
+	const UWorld* World = GetWorld();
+
+	if (PathPoints.Num() < 2)
+	{
+		DrawDebugDashedLine(World, GetActorLocation(), GetEndLocation(), Color, 25.f, false, 0.f, 0);
+		return;
+	}
+
+	for (int32 i = 1; i < PathPoints.Num(); ++i)
+	{
+		DrawDebugLine(World, PathPoints[i - 1], PathPoints[i], Color, false, 0.f, 0, Thickness);
+		DrawDebugPoint(World, PathPoints[i], Thickness * 3.f, Color, false, 0.f, 0);
+	}
+}
@@ -0,0 +1,238 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyPolylineRuler.h"
+
+#include "TrickyDebugTextComponent.h"
+#include "TrickyRulerShapeComponent.h"
+#include "TrickyRulersGeometry.h"
+#include "TrickyUnitWireframeCache.h"
+#include "Algo/BinarySearch.h"
+#include "Components/BillboardComponent.h"
+#include "Engine/Texture2D.h"
+
+
+ATrickyPolylineRuler::ATrickyPolylineRuler()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bIsEditorOnlyActor = true;
+
+	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
+	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+	ShapeComponent = CreateEditorOnlyDefaultSubobject<UTrickyRulerShapeComponent>(TEXT("Shape"));
+	ShapeComponent->SetupAttachment(GetRootComponent());
+	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
+
+	if (BillboardComponent)
+	{
+		BillboardComponent->SetupAttachment(GetRootComponent());
+		UTexture2D* BillboardTexture = LoadObject<UTexture2D>(this, TEXT("/Engine/EditorResources/S_TargetPoint"));
+		BillboardComponent->SetSprite(BillboardTexture);
+		SpriteScale = 0.5;
+	}
+}
+
+void ATrickyPolylineRuler::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+	UpdateGroupState();
+
+	// Moving the ruler only moves the shape component, the cached lines stay valid.
+	if (bArePointsDirty)
+	{
+		UpdateLengths();
+	}
+
+	UpdateShape();
+	UpdateDebugText();
+}
+
+void ATrickyPolylineRuler::PostLoad()
+{
+	Super::PostLoad();
+	UpdateLengths();
+}
+
+#if WITH_EDITOR
+void ATrickyPolylineRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(ATrickyPolylineRuler, Points)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATrickyPolylineRuler, bIsClosedLoop))
+	{
+		bArePointsDirty = true;
+	}
+
+	SetActorScale3D(FVector::One());
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+
+void ATrickyPolylineRuler::PostEditUndo()
+{
+	bArePointsDirty = true;
+	Super::PostEditUndo();
+}
+
+EDataValidationResult ATrickyPolylineRuler::IsDataValid(FDataValidationContext& Context) const
+{
+	const EDataValidationResult Result = Super::IsDataValid(Context);
+	TArray<FString> Violations;
+	GetConstraintViolations(Violations);
+	return FTrickyMeasurementConstraint::Validate(Violations, GetActorNameOrLabel(), Context, Result);
+}
+
+bool ATrickyPolylineRuler::CanEditChange(const FProperty* InProperty) const
+{
+	return Super::CanEditChange(InProperty) && FTrickyRulerGroups::CanEdit(GroupState);
+}
+#endif
+
+void ATrickyPolylineRuler::SetPoints(const TArray<FVector>& NewPoints)
+{
+	Points = NewPoints;
+	UpdateLengths();
+	UpdateShape();
+	UpdateDebugText();
+}
+
+double ATrickyPolylineRuler::GetDistanceAtPoint(const int32 PointIndex) const
+{
+	return PrefixLengths.IsValidIndex(PointIndex) ? PrefixLengths[PointIndex] : 0.0;
+}
+
+FVector ATrickyPolylineRuler::GetLocationAtDistance(const double Distance) const
+{
+	if (Points.Num() == 0 || PrefixLengths.Num() != Points.Num())
+	{
+		return GetActorLocation();
+	}
+
+	const double ClampedDistance = FMath::Clamp(Distance, 0.0, GetTotalLength());
+	const int32 Index = Algo::LowerBound(PrefixLengths, ClampedDistance);
+	FVector Location = Points[0];
+
+	if (Index >= PrefixLengths.Num())
+	{
+		// The distance is on the closing segment of the loop.
+		const double SegmentLength = GetTotalLength() - PrefixLengths.Last();
+		const double Alpha = SegmentLength > 0.0 ? (ClampedDistance - PrefixLengths.Last()) / SegmentLength : 0.0;
+		Location = FMath::Lerp(Points.Last(), Points[0], Alpha);
+	}
+	else if (Index > 0)
+	{
+		const double SegmentLength = PrefixLengths[Index] - PrefixLengths[Index - 1];
+		const double Alpha = SegmentLength > 0.0 ? (ClampedDistance - PrefixLengths[Index - 1]) / SegmentLength : 0.0;
+		Location = FMath::Lerp(Points[Index - 1], Points[Index], Alpha);
+	}
+
+	return GetActorTransform().TransformPosition(Location);
+}
+
+void ATrickyPolylineRuler::GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const
+{
+	OutMeasurements.Add({bIsClosedLoop ? TEXT("Perimeter") : TEXT("Length"), Length});
+	OutMeasurements.Add({TEXT("Points"), static_cast<double>(Points.Num())});
+}
+
+void ATrickyPolylineRuler::GetConstraintViolations(TArray<FString>& OutViolations) const
+{
+	FTrickyMeasurementConstraint::CheckAll(Constraints, [this](TArray<FTrickyMeasurement>& OutMeasurements)
+	{
+		GetMeasurements(OutMeasurements);
+	}, OutViolations);
+}
+
+double ATrickyPolylineRuler::GetTotalLength() const
+{
+	if (PrefixLengths.Num() == 0)
+	{
+		return 0.0;
+	}
+
+	const double ClosingLength = bIsClosedLoop && Points.Num() > 2 ? FVector::Dist(Points.Last(), Points[0]) : 0.0;
+	return PrefixLengths.Last() + ClosingLength;
+}
+
+void ATrickyPolylineRuler::UpdateLengths()
+{
+	bArePointsDirty = false;
+	TrickyRulersGeometry::CalculatePrefixLengths(Points, PrefixLengths);
+	Length = GetTotalLength() / 100.0;
+	Wireframe.Reset();
+}
+
+void ATrickyPolylineRuler::UpdateShape()
+{
+	if (!ShapeComponent)
+	{
+		return;
+	}
+
+	if (Points.Num() < 2)
+	{
+		ShapeComponent->ClearShapes();
+		return;
+	}
+
+	if (!Wireframe.IsValid())
+	{
+		const TSharedRef<FTrickyUnitWireframe, ESPMode::ThreadSafe> NewWireframe =
+			MakeShared<FTrickyUnitWireframe, ESPMode::ThreadSafe>();
+		const int32 SegmentsNum = bIsClosedLoop && Points.Num() > 2 ? Points.Num() : Points.Num() - 1;
+		NewWireframe->LinePoints.SetNumUninitialized(SegmentsNum * 2);
+
+		for (int32 i = 0; i < SegmentsNum; ++i)
+		{
+			NewWireframe->LinePoints[i * 2] = FVector3f(Points[i]);
+			NewWireframe->LinePoints[i * 2 + 1] = FVector3f(Points[(i + 1) % Points.Num()]);
+		}
+
+		NewWireframe->Bounds = FBox3f(NewWireframe->LinePoints);
+		Wireframe = NewWireframe;
+	}
+
+	TArray<FTrickyWireframeInstance> Shapes;
+	Shapes.Add({Wireframe, FTransform::Identity});
+	ShapeComponent->SetShapes(MoveTemp(Shapes), Color, Thickness);
+}
+
+void ATrickyPolylineRuler::UpdateDebugText()
+{
+	if (!TrickyDebugTextComponent)
+	{
+		return;
+	}
+
+	FString Dimensions = FString::Printf(TEXT("%s: %.2f m\nPoints: %d"),
+	                                     bIsClosedLoop ? TEXT("Perimeter") : TEXT("Length"),
+	                                     Length,
+	                                     Points.Num());
+	TArray<FString> Violations;
+	GetConstraintViolations(Violations);
+
+	for (const FString& Violation : Violations)
+	{
+		Dimensions += FString::Printf(TEXT("\nViolated: %s"), *Violation);
+	}
+
+	const FString Delimiter = TEXT("\n==========\n");
+	FTrickyDebugTextData DebugTextData;
+	DebugTextData.Text = FString::Printf(TEXT("%s%s%s%s%s"),
+	                                     *Delimiter,
+	                                     *GetActorNameOrLabel(),
+	                                     *Delimiter,
+	                                     *Dimensions,
+	                                     *Delimiter);
+	DebugTextData.Color = Color;
+	DebugTextData.TextScale = DebugTextScale;
+	TrickyDebugTextComponent->SetDebugLabel(DebugTextData);
+	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+}
+
+void ATrickyPolylineRuler::UpdateGroupState()
+{
+	GroupState = FTrickyRulerGroups::BindComponents(Group, TrickyDebugTextComponent, ShapeComponent);
+}
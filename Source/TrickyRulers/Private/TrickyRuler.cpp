@@ -3,21 +3,44 @@
 
 #include "TrickyRuler.h"
 
+#include "TrickyDebugShapesComponent.h"
 #include "TrickyDebugTextComponent.h"
+#include "TrickyElevationProfile.h"
+#include "TrickyGridComponent.h"
+#include "TrickyRulerActorDesc.h"
+#include "TrickyRulerRebuild.h"
+#include "TrickyRulerShapeComponent.h"
+#include "TrickyRulerSubsystem.h"
+#include "TrickyRulersMemory.h"
+#include "TrickyUnitWireframeCache.h"
 #include "Components/BillboardComponent.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Engine/Engine.h"
+#include "Engine/OverlapResult.h"
 #include "Engine/Texture2D.h"
+#include "Engine/World.h"
 
 
 ATrickyRuler::ATrickyRuler()
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	PrimaryActorTick.bCanEverTick = true;
 	bIsEditorOnlyActor = true;
 
-	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+	// The root keeps the transform of the runtime rulers, so it isn't editor only.
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 
 	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
 	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+	DebugShapesComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugShapesComponent>(TEXT("DebugShapes"));
+	DebugShapesComponent->SetupAttachment(GetRootComponent());
+	ShapeComponent = CreateEditorOnlyDefaultSubobject<UTrickyRulerShapeComponent>(TEXT("Shape"));
+	ShapeComponent->SetupAttachment(GetRootComponent());
+	GridComponent = CreateEditorOnlyDefaultSubobject<UTrickyGridComponent>(TEXT("Grid"));
+	GridComponent->SetupAttachment(GetRootComponent());
+	ElevationShapesComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugShapesComponent>(TEXT("ElevationShapes"));
+	ElevationShapesComponent->SetupAttachment(GetRootComponent());
 	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
 
 	if (BillboardComponent)
@@ -34,141 +57,534 @@ bool ATrickyRuler::ShouldTickIfViewportsOnly() const
 	return true;
 }
 
+#if WITH_EDITOR
 void ATrickyRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
 
 	SetActorScale3D(FVector::One());
-	UpdateDimensions();
+	MarkContainedActorsDirty();
+	UTrickyRulerSubsystem::RequestRebuild(this);
 }
 
-void ATrickyRuler::PostInitProperties()
+void ATrickyRuler::PostEditMove(bool bFinished)
 {
-	Super::PostInitProperties();
+	Super::PostEditMove(bFinished);
+	MarkContainedActorsDirty();
+	UTrickyRulerSubsystem::RequestRebuild(this);
+}
+#endif
+
+void ATrickyRuler::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!bShowInGame)
+	{
+		return;
+	}
 
-	UpdateDimensions();
+	bIsRuntimeRuler = true;
+	SetActorTickEnabled(false);
+	UpdateGroupState();
+	UTrickyRulerSubsystem::RegisterRuntimeRuler(this, this);
+
+	if (RootComponent)
+	{
+		RootComponent->TransformUpdated.AddUObject(this, &ATrickyRuler::HandleRuntimeRulerMoved);
+	}
 }
 
-void ATrickyRuler::PostEditMove(bool bFinished)
+void ATrickyRuler::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::PostEditMove(bFinished);
-	UpdateDimensions();
+	if (bIsRuntimeRuler)
+	{
+		bIsRuntimeRuler = false;
+		UTrickyRulerSubsystem::UnregisterRuntimeRuler(this);
+
+		if (RootComponent)
+		{
+			RootComponent->TransformUpdated.RemoveAll(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void ATrickyRuler::PostLoad()
+bool ATrickyRuler::IsEditorOnly() const
 {
-	Super::PostLoad();
-	UpdateDimensions();
+	return IsEditorOnlyRuler(bShowInGame);
 }
 
+void ATrickyRuler::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	if (bIsUpdateDeferred && !HasAnyFlags(RF_ClassDefaultObject))
+	{
+		UTrickyRulerSubsystem::RequestUpdate(this);
+	}
+
+#if WITH_EDITOR
+	if (GEngine && !HasAnyFlags(RF_ClassDefaultObject) && !ActorMovedHandle.IsValid())
+	{
+		ActorMovedHandle = GEngine->OnActorMoved().AddUObject(this, &ATrickyRuler::HandleActorMoved);
+	}
+#endif
+}
+
+void ATrickyRuler::PostUnregisterAllComponents()
+{
+#if WITH_EDITOR
+	if (GEngine)
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+	}
+#endif
+
+	ActorMovedHandle.Reset();
+
+	// The debug text and the shapes are rebuilt when the components are registered again.
+	bIsUpdateDeferred = true;
+
+	Super::PostUnregisterAllComponents();
+}
+
+#if WITH_EDITOR
+EDataValidationResult ATrickyRuler::IsDataValid(FDataValidationContext& Context) const
+{
+	const EDataValidationResult Result = Super::IsDataValid(Context);
+	TArray<FString> Violations;
+	GetConstraintViolations(Violations);
+	return FTrickyMeasurementConstraint::Validate(Violations, GetActorNameOrLabel(), Context, Result);
+}
+
+bool ATrickyRuler::CanEditChange(const FProperty* InProperty) const
+{
+	return Super::CanEditChange(InProperty) && FTrickyRulerGroups::CanEdit(GroupState);
+}
+
+TUniquePtr<FWorldPartitionActorDesc> ATrickyRuler::CreateClassActorDesc() const
+{
+	return MakeUnique<FTrickyRulerActorDesc>();
+}
+#endif
+
 void ATrickyRuler::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateContainedActors(DeltaTime);
+
+	if (Elevation.IsValid() && Elevation->ConsumeResultsChanged())
+	{
+		UpdateElevationShapes();
+		UpdateDimensions();
+	}
+
+	if (GroupState.IsValid() && GroupState->IsHidden())
+	{
+		return;
+	}
+
+	// Other shapes are drawn by the shape component.
 	switch (RulerType)
 	{
 	case ERulerType::Line:
 		DrawLineRuler();
 		break;
+	case ERulerType::Box:
+		DrawBoxRuler();
+		break;
+	default:
+		break;
+	}
+}
+
+void ATrickyRuler::SetupLineRuler(const FVector& Start, const FVector& End)
+{
+	RulerType = ERulerType::Line;
+	LineRuler.Length = FMath::Max(FMath::RoundToInt32(FVector::Dist(Start, End)), 1);
+	SetActorLocationAndRotation(Start, (End - Start).Rotation());
+	UTrickyRulerSubsystem::RequestRebuild(this);
+}
+
+void ATrickyRuler::SetLineRulerColor(const FColor& Color)
+{
+	LineRuler.Color = Color;
+	UTrickyRulerSubsystem::RequestRebuild(this);
+}
+
+void ATrickyRuler::GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const
+{
+	switch (RulerType)
+	{
+	case ERulerType::Line:
+		OutMeasurements.Add({TEXT("Length"), LineRuler.GetLengthInMeters()});
+		break;
+
 	case ERulerType::Circle:
-		DrawCircleRuler();
+		OutMeasurements.Add({TEXT("Radius"), CircleRuler.GetRadiusInMeters()});
 		break;
+
 	case ERulerType::Sphere:
-		DrawSphereRuler();
+		OutMeasurements.Add({TEXT("Radius"), SphereRuler.GetRadiusInMeters()});
 		break;
+
 	case ERulerType::Cylinder:
-		DrawCylinderRuler();
+		OutMeasurements.Add({TEXT("Radius"), CylinderRuler.GetDimensionsInMeters().X});
+		OutMeasurements.Add({TEXT("Height"), CylinderRuler.GetDimensionsInMeters().Y});
 		break;
+
 	case ERulerType::Capsule:
-		DrawCapsuleRuler();
+		OutMeasurements.Add({TEXT("Radius"), CapsuleRuler.GetDimensionsInMeters().X});
+		OutMeasurements.Add({TEXT("Height"), CapsuleRuler.GetDimensionsInMeters().Y});
 		break;
+
 	case ERulerType::Box:
-		DrawBoxRuler();
+		OutMeasurements.Add({TEXT("X"), BoxRuler.GetLengthInMeters().X});
+		OutMeasurements.Add({TEXT("Y"), BoxRuler.GetLengthInMeters().Y});
+		OutMeasurements.Add({TEXT("Z"), BoxRuler.GetLengthInMeters().Z});
 		break;
+
 	case ERulerType::Cone:
-		DrawConeRuler();
+		OutMeasurements.Add({TEXT("Length"), ConeRuler.GetLengthInMeters()});
+		OutMeasurements.Add({TEXT("Angle"), static_cast<double>(ConeRuler.Angle)});
 		break;
-	default:
+
+	case ERulerType::Grid:
+		OutMeasurements.Add({TEXT("X"), GridRuler.GetLengthInMeters().X});
+		OutMeasurements.Add({TEXT("Y"), GridRuler.GetLengthInMeters().Y});
+
+		if (GridRuler.bIs3D)
+		{
+			OutMeasurements.Add({TEXT("Z"), GridRuler.GetLengthInMeters().Z});
+		}
+
+		OutMeasurements.Add({TEXT("Cell"), GridRuler.GetCellSizeInMeters()});
 		break;
 	}
+
+	if (CanContainActors() && bHasContainedActorsQueryFinished)
+	{
+		OutMeasurements.Add({TEXT("Contains"), static_cast<double>(ContainedActors.Num())});
+	}
+
+	if (Elevation.IsValid())
+	{
+		Elevation->GetMeasurements(OutMeasurements);
+	}
+}
+
+void ATrickyRuler::GetConstraintViolations(TArray<FString>& OutViolations) const
+{
+	FTrickyMeasurementConstraint::CheckAll(Constraints, [this](TArray<FTrickyMeasurement>& OutMeasurements)
+	{
+		GetMeasurements(OutMeasurements);
+	}, OutViolations);
+}
+
+void ATrickyRuler::FinishDeferredUpdate()
+{
+	// Rulers unregistered while pending are requested again by PostRegisterAllComponents.
+	if (bIsUpdateDeferred && HasActorRegisteredAllComponents())
+	{
+		UpdateDimensions();
+	}
 }
 
 void ATrickyRuler::UpdateDimensions()
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	FTrickyRulerRebuild Rebuild;
+	PrepareRebuild(Rebuild);
+	BuildRebuild(Rebuild);
+	ApplyRebuild(Rebuild);
+}
+
+void ATrickyRuler::PrepareRebuild(FTrickyRulerRebuild& Rebuild)
+{
+	bIsUpdateDeferred = false;
+	UpdateGroupState();
+	UpdateElevation(false);
+
+	if (RulerType == ERulerType::Capsule)
+	{
+		CapsuleRuler.ClampHeight();
+	}
+
+	Rebuild.Ruler = this;
+	Rebuild.Name = GetActorNameOrLabel();
+	Rebuild.ElevationText = Elevation.IsValid() ? Elevation->GetStatsText() : FString();
+	GetMeasurements(Rebuild.Measurements);
+
+	if (CanContainActors())
+	{
+		Rebuild.ContainedActorsNum = ContainedActors.Num();
+
+		if (ContainedActorsSettings.bListInDebugText)
+		{
+			const int32 ListedNum = FMath::Min(ContainedActors.Num(), MaxListedContainedActors);
+
+			for (int32 i = 0; i < ListedNum; ++i)
+			{
+				if (const AActor* Actor = ContainedActors[i].Get())
+				{
+					Rebuild.ContainedActorNames.Add(Actor->GetActorNameOrLabel());
+				}
+			}
+		}
+	}
+
+	if (RulerType == ERulerType::Grid)
+	{
+		Rebuild.GridSettings = MakeGridSettings();
+		Rebuild.bNeedsGridGeometry = GridComponent && GridComponent->NeedsGeometry(Rebuild.GridSettings);
+	}
+}
+
+void ATrickyRuler::BuildRebuild(FTrickyRulerRebuild& Rebuild) const
+{
+	FString& Text = Rebuild.Dimensions;
+
 	switch (RulerType)
 	{
 	case ERulerType::Line:
-		Dimensions = FString::Printf(TEXT("Length: %.2f m"), LineRuler.GetLengthInMeters());
-		DebugTextData.Color = LineRuler.Color;
+		Text = FString::Printf(TEXT("Length: %.2f m"), LineRuler.GetLengthInMeters());
+		Rebuild.TextColor = LineRuler.Color;
 		break;
 
 	case ERulerType::Circle:
-		Dimensions = FString::Printf(TEXT("Radius: %.2f m"), CircleRuler.GetRadiusInMeters());
-		DebugTextData.Color = CircleRuler.Color;
+		Text = FString::Printf(TEXT("Radius: %.2f m"), CircleRuler.GetRadiusInMeters());
+		Rebuild.TextColor = CircleRuler.Color;
 		break;
 
 	case ERulerType::Sphere:
-		Dimensions = FString::Printf(TEXT("Radius: %.2f m"), SphereRuler.GetRadiusInMeters());
-		DebugTextData.Color = SphereRuler.Color;
+		Text = FString::Printf(TEXT("Radius: %.2f m"), SphereRuler.GetRadiusInMeters());
+		Rebuild.TextColor = SphereRuler.Color;
 		break;
 
 	case ERulerType::Cylinder:
-		const FVector2D CylinderDimensions = CylinderRuler.GetDimensionsInMeters();
-		Dimensions =
-			FString::Printf(TEXT("Radius: %.2f m\nHeight: %.2f m"), CylinderDimensions.X, CylinderDimensions.Y);
-		DebugTextData.Color = CylinderRuler.Color;
-		break;
+		{
+			const FVector2D CylinderDimensions = CylinderRuler.GetDimensionsInMeters();
+			Text = FString::Printf(TEXT("Radius: %.2f m\nHeight: %.2f m"), CylinderDimensions.X, CylinderDimensions.Y);
+			Rebuild.TextColor = CylinderRuler.Color;
+			break;
+		}
 
 	case ERulerType::Capsule:
-		CapsuleRuler.ClampHeight();
-		const FVector2D CapsuleDimensions = CapsuleRuler.GetDimensionsInMeters();
-		Dimensions =
-			FString::Printf(TEXT("Radius: %.2f m\nHeight: %.2f m"), CapsuleDimensions.X, CapsuleDimensions.Y);
-		DebugTextData.Color = CapsuleRuler.Color;
-		break;
+		{
+			const FVector2D CapsuleDimensions = CapsuleRuler.GetDimensionsInMeters();
+			Text = FString::Printf(TEXT("Radius: %.2f m\nHeight: %.2f m"), CapsuleDimensions.X, CapsuleDimensions.Y);
+			Rebuild.TextColor = CapsuleRuler.Color;
+			break;
+		}
 
 	case ERulerType::Box:
-		const FVector Length = BoxRuler.GetLengthInMeters();
-		Dimensions = FString::Printf(TEXT("X: %.2f m\nY: %.2f m\nZ: %.2f m"), Length.X, Length.Y, Length.Z);
-		DebugTextData.Color = BoxRuler.Color;
-		break;
+		{
+			const FVector Length = BoxRuler.GetLengthInMeters();
+			Text = FString::Printf(TEXT("X: %.2f m\nY: %.2f m\nZ: %.2f m"), Length.X, Length.Y, Length.Z);
+			Rebuild.TextColor = BoxRuler.Color;
+			break;
+		}
 
 	case ERulerType::Cone:
-		Dimensions = FString::Printf(
-			TEXT("Length: %.2f m\nAngle: %d deg"), ConeRuler.GetLengthInMeters(), ConeRuler.Angle);
-		DebugTextData.Color = ConeRuler.Color;
+		Text = FString::Printf(TEXT("Length: %.2f m\nAngle: %d deg"), ConeRuler.GetLengthInMeters(), ConeRuler.Angle);
+		Rebuild.TextColor = ConeRuler.Color;
 		break;
+
+	case ERulerType::Grid:
+		{
+			const FVector GridLength = GridRuler.GetLengthInMeters();
+			Text = FString::Printf(TEXT("X: %.2f m\nY: %.2f m"), GridLength.X, GridLength.Y);
+
+			if (GridRuler.bIs3D)
+			{
+				Text += FString::Printf(TEXT("\nZ: %.2f m"), GridLength.Z);
+			}
+
+			Text += FString::Printf(TEXT("\nCell: %.2f m"), GridRuler.GetCellSizeInMeters());
+			Rebuild.TextColor = GridRuler.Color;
+			break;
+		}
+	}
+
+	if (!Rebuild.ElevationText.IsEmpty())
+	{
+		Text += TEXT("\n") + Rebuild.ElevationText;
+	}
+
+	if (CanContainActors())
+	{
+		Text += FString::Printf(TEXT("\nContains: %d"), Rebuild.ContainedActorsNum);
+
+		for (const FString& ActorName : Rebuild.ContainedActorNames)
+		{
+			Text += FString::Printf(TEXT("\n- %s"), *ActorName);
+		}
+
+		const int32 UnlistedNum = Rebuild.ContainedActorsNum - MaxListedContainedActors;
+
+		if (ContainedActorsSettings.bListInDebugText && UnlistedNum > 0)
+		{
+			Text += FString::Printf(TEXT("\n- ...and %d more"), UnlistedNum);
+		}
+	}
+
+	TArray<FString> Violations;
+	FTrickyMeasurementConstraint::CheckAll(Constraints, Rebuild.Measurements, Violations);
+
+	for (const FString& Violation : Violations)
+	{
+		Text += FString::Printf(TEXT("\nViolated: %s"), *Violation);
+	}
+
+	BuildGridLabels(Rebuild.GridLabels);
+
+	if (Rebuild.bNeedsGridGeometry)
+	{
+		Rebuild.GridGeometry = FTrickyGridGeometry::Build(Rebuild.GridSettings);
+	}
+}
+
+void ATrickyRuler::ApplyRebuild(FTrickyRulerRebuild& Rebuild)
+{
+	UpdateShape();
+
+	if (GridComponent)
+	{
+		if (RulerType == ERulerType::Grid)
+		{
+			GridComponent->SetGrid(Rebuild.GridSettings, Rebuild.GridGeometry);
+		}
+		else
+		{
+			GridComponent->ClearGrid();
+		}
 	}
 
 	const FString Delimiter = TEXT("\n==========\n");
-	const FString DebugText = FString::Printf(TEXT("%s%s%s%s%s"),
-	                                          *Delimiter,
-	                                          *GetActorNameOrLabel(),
-	                                          *Delimiter,
-	                                          *Dimensions,
-	                                          *Delimiter);
-	DebugTextData.Text = DebugText;
+	Dimensions = MoveTemp(Rebuild.Dimensions);
+	DebugTextData.Text = FString::Printf(TEXT("%s%s%s%s%s"),
+	                                     *Delimiter,
+	                                     *Rebuild.Name,
+	                                     *Delimiter,
+	                                     *Dimensions,
+	                                     *Delimiter);
+	DebugTextData.Color = Rebuild.TextColor;
 	DebugTextData.TextScale = DebugTextScale;
-	TrickyDebugTextComponent->SetDebugLabel(DebugTextData);
-	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+
+	if (TrickyDebugTextComponent)
+	{
+		TrickyDebugTextComponent->SetNumericLabels(Rebuild.GridLabels);
+		TrickyDebugTextComponent->SetMinScreenSize(RulerType == ERulerType::Grid ? MinGridLabelScreenSize : 0.f);
+		TrickyDebugTextComponent->SetDebugLabel(DebugTextData);
+		TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+	}
+
+	if (bIsRuntimeRuler)
+	{
+		UTrickyRulerSubsystem::MarkRuntimeRulerDirty(this);
+	}
+}
+
+void ATrickyRuler::RefreshElevation()
+{
+	UpdateElevation(true);
+}
+
+void ATrickyRuler::UpdateElevation(const bool bForceFullUpdate)
+{
+	// Runtime rulers don't tick, so they can't receive the results.
+	if (RulerType != ERulerType::Line || !ElevationProfile.bIsEnabled || bIsRuntimeRuler)
+	{
+		if (Elevation.IsValid())
+		{
+			Elevation.Reset();
+			UpdateElevationShapes();
+		}
+
+		return;
+	}
+
+	if (!Elevation.IsValid())
+	{
+		Elevation = MakeShared<FTrickyElevationProfile>();
+	}
+
+	FTrickyElevationSettings Settings;
+	Settings.SampleStep = ElevationProfile.SampleStep;
+	Settings.TraceRange = ElevationProfile.TraceRange;
+	Settings.Channel = ElevationProfile.Channel;
+	Elevation->Update(GetWorld(),
+	                  GetActorLocation(),
+	                  GetActorForwardVector(),
+	                  LineRuler.Length,
+	                  this,
+	                  Settings,
+	                  bForceFullUpdate);
+}
+
+void ATrickyRuler::UpdateElevationShapes()
+{
+	if (!ElevationShapesComponent)
+	{
+		return;
+	}
+
+	if (!Elevation.IsValid())
+	{
+		ElevationShapesComponent->ClearShapes();
+		return;
+	}
+
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+	Elevation->BuildSlopeLines(ElevationProfile, Lines);
+	ElevationShapesComponent->SetLines(MoveTemp(Lines));
+}
+
+void ATrickyRuler::UpdateGroupState()
+{
+	GroupState = FTrickyRulerGroups::BindComponents(Group,
+	                                                TrickyDebugTextComponent,
+	                                                DebugShapesComponent,
+	                                                ShapeComponent,
+	                                                GridComponent,
+	                                                ElevationShapesComponent);
+}
+
+FColor ATrickyRuler::GetGroupColor(const FColor& Color) const
+{
+	if (!GroupState.IsValid())
+	{
+		return Color;
+	}
+
+	FColor GroupColor = GroupState->GetColor(Color);
+	GroupColor.A = Color.A;
+	return GroupColor;
 }
 
 void ATrickyRuler::DrawLineRuler() const
+{
+	const FColor Color = GetGroupColor(LineRuler.Color);
+
+	ForEachLineRulerSegment([this, &Color](const FVector& Start, const FVector& End)
+	{
+		DrawDebugLine(GetWorld(), Start, End, Color, false, 0.f, 0, LineRuler.Thickness);
+	});
+}
+
+void ATrickyRuler::ForEachLineRulerSegment(TFunctionRef<void(const FVector&, const FVector&)> Function) const
 {
 	const FVector Direction = GetActorForwardVector();
 	const FVector LineStart = GetActorLocation();
 	const FVector LineEnd = LineStart + Direction * LineRuler.Length;
-	DrawDebugLine(GetWorld(),
-	              LineStart,
-	              LineEnd,
-	              LineRuler.Color,
-	              false,
-	              0.f,
-	              0,
-	              LineRuler.Thickness);
-
-	DrawMarker(LineStart);
-	DrawMarker(LineEnd);
+	Function(LineStart, LineEnd);
+
+	ForEachMarkerSegment(LineStart, Function);
+	ForEachMarkerSegment(LineEnd, Function);
 
 	if (LineRuler.bShowMarkers)
 	{
@@ -183,7 +599,7 @@ void ATrickyRuler::DrawLineRuler() const
 		for (int32 i = 1; i < MarkersAmount; ++i)
 		{
 			FVector MarkerLocation = LineStart + Direction * (i * LineRuler.MarkersDistance);
-			DrawMarker(MarkerLocation);
+			ForEachMarkerSegment(MarkerLocation, Function);
 		}
 	}
 }
@@ -197,184 +613,488 @@ void ATrickyRuler::CalculateMarkerPositions(const FVector& Origin,
 	EndPos = StartPos + Direction * (LineRuler.MarkerLength * 2);
 }
 
-void ATrickyRuler::DrawMarker(const FVector& Origin) const
+void ATrickyRuler::ForEachMarkerSegment(const FVector& Origin,
+                                        TFunctionRef<void(const FVector&, const FVector&)> Function) const
 {
 	const FVector Direction = GetActorForwardVector();
 	FVector MarkerDirection = Direction.RotateAngleAxis(-90.f, GetActorRightVector());
 	FVector MarkerStart = FVector::ZeroVector;
 	FVector MarkerEnd = FVector::ZeroVector;
 	CalculateMarkerPositions(Origin, MarkerDirection, MarkerStart, MarkerEnd);
-	DrawDebugLine(GetWorld(),
-	              MarkerStart,
-	              MarkerEnd,
-	              LineRuler.Color,
-	              false,
-	              0.f,
-	              0,
-	              LineRuler.Thickness);
+	Function(MarkerStart, MarkerEnd);
 
 	MarkerDirection = Direction.RotateAngleAxis(90.f, GetActorUpVector());
 	CalculateMarkerPositions(Origin, MarkerDirection, MarkerStart, MarkerEnd);
-	DrawDebugLine(GetWorld(),
-	              MarkerStart,
-	              MarkerEnd,
-	              LineRuler.Color,
-	              false,
-	              0.f,
-	              0,
-	              LineRuler.Thickness);
-}
-
-void ATrickyRuler::DrawCircleRuler() const
-{
-	DrawDebugCircle(GetWorld(),
-	                GetActorLocation(),
-	                CircleRuler.Radius,
-	                CircleRuler.Segments,
-	                CircleRuler.Color,
-	                false,
-	                0.f,
-	                0,
-	                CircleRuler.Thickness,
-	                GetActorRightVector(),
-	                GetActorForwardVector());
-}
-
-void ATrickyRuler::DrawSphereRuler() const
-{
-	const FVector Center = GetActorLocation();
-	DrawDebugSphere(GetWorld(),
-	                Center,
-	                SphereRuler.Radius,
-	                SphereRuler.Segments,
-	                SphereRuler.Color,
-	                false,
-	                0.f,
-	                0,
-	                SphereRuler.Thickness);
-
-	DrawRadiusLines(Center,
-	                GetActorForwardVector(),
-	                SphereRuler.Radius,
-	                SphereRuler.Color,
-	                SphereRuler.Thickness);
-	DrawRadiusLines(Center,
-	                GetActorRightVector(),
-	                SphereRuler.Radius,
-	                SphereRuler.Color,
-	                SphereRuler.Thickness);
-}
-
-void ATrickyRuler::DrawCylinderRuler() const
-{
-	const FVector Location = GetActorLocation();
-	const FVector UpVector = GetActorUpVector();
-	const FVector StartLocation = CylinderRuler.bCenterOrigin
-		                              ? Location - UpVector * CylinderRuler.GetHalfHeight()
-		                              : Location;
-	const FVector EndLocation = StartLocation + UpVector * CylinderRuler.Height;
-	DrawDebugCylinder(GetWorld(),
-	                  StartLocation,
-	                  EndLocation,
-	                  CylinderRuler.Radius,
-	                  CylinderRuler.Segments,
-	                  CylinderRuler.Color,
-	                  false,
-	                  0.f,
-	                  0,
-	                  CylinderRuler.Thickness);
-
-	DrawRadiusLines(Location,
-	                GetActorForwardVector(),
-	                CylinderRuler.Radius,
-	                CylinderRuler.Color,
-	                CylinderRuler.Thickness);
-	DrawRadiusLines(Location,
-	                GetActorRightVector(),
-	                CylinderRuler.Radius,
-	                CylinderRuler.Color,
-	                CylinderRuler.Thickness);
-}
-
-void ATrickyRuler::DrawRadiusLines(const FVector& Origin,
-                                   const FVector& Direction,
-                                   const float Radius,
-                                   const FColor& Color,
-                                   const float Thickness) const
-{
-	FVector LineStart = Origin - Direction * Radius;
-	FVector LineEnd = Origin + Direction * Radius;
-	DrawDebugLine(GetWorld(),
-	              LineStart,
-	              LineEnd,
-	              Color,
-	              false,
-	              0,
-	              0,
-	              Thickness);
-}
-
-void ATrickyRuler::DrawCapsuleRuler() const
-{
-	const FVector Center = CapsuleRuler.bCenterOrigin
-		                       ? GetActorLocation()
-		                       : GetActorLocation() + GetActorUpVector() * CapsuleRuler.GetHalfHeight();
-	DrawDebugCapsule(GetWorld(),
-	                 Center,
-	                 CapsuleRuler.GetHalfHeight(),
-	                 CapsuleRuler.Radius,
-	                 GetActorRotation().Quaternion(),
-	                 CapsuleRuler.Color,
-	                 false,
-	                 0.f,
-	                 0,
-	                 CapsuleRuler.Thickness);
+	Function(MarkerStart, MarkerEnd);
 }
 
 void ATrickyRuler::DrawBoxRuler() const
 {
-	const UWorld* World = GetWorld();
+	if (!BoxRuler.bIsFilled)
+	{
+		return;
+	}
+
 	const FVector Center = BoxRuler.bCenterOrigin
 		                       ? GetActorLocation()
 		                       : GetActorLocation() + GetActorUpVector() * BoxRuler.LengthZ * 0.5f;
-	const FQuat Rotation = GetActorRotation().Quaternion();
 	const FVector Extent = FVector(BoxRuler.LengthX, BoxRuler.LengthY, BoxRuler.LengthZ) * 0.5f;
-	DrawDebugBox(World,
-	             Center,
-	             Extent,
-	             Rotation,
-	             BoxRuler.Color,
-	             false,
-	             0.f,
-	             0,
-	             BoxRuler.Thickness);
-
-	if (BoxRuler.bIsFilled)
-	{
-		DrawDebugSolidBox(World,
-		                  Center,
-		                  Extent - 0.1,
-		                  Rotation,
-		                  BoxRuler.GetFillColor(),
-		                  false,
-		                  0.f,
-		                  0);
-	}
-}
-
-void ATrickyRuler::DrawConeRuler() const
-{
-	const float AngleRad = FMath::DegreesToRadians(ConeRuler.GetHalfAngle());
-	DrawDebugCone(GetWorld(),
-	              GetActorLocation(),
-	              GetActorForwardVector(),
-	              ConeRuler.Length,
-	              AngleRad,
-	              AngleRad * !ConeRuler.bIsFlat,
-	              ConeRuler.Segments,
-	              ConeRuler.Color,
-	              false,
-	              0.f,
-	              0,
-	              ConeRuler.Thickness);
+	DrawDebugSolidBox(GetWorld(),
+	                  Center,
+	                  Extent - 0.1,
+	                  GetActorRotation().Quaternion(),
+	                  GetGroupColor(BoxRuler.GetFillColor()),
+	                  false,
+	                  0.f,
+	                  0);
+}
+
+void ATrickyRuler::UpdateShape()
+{
+	if (!ShapeComponent)
+	{
+		return;
+	}
+
+	TArray<FTrickyWireframeInstance> Shapes;
+	FColor Color = FColor::White;
+	float Thickness = 1.f;
+	BuildShapes(Shapes, Color, Thickness);
+
+	if (Shapes.Num() == 0)
+	{
+		ShapeComponent->ClearShapes();
+		return;
+	}
+
+	ShapeComponent->SetShapes(MoveTemp(Shapes), Color, Thickness);
+}
+
+void ATrickyRuler::BuildShapes(TArray<FTrickyWireframeInstance>& OutShapes, FColor& OutColor, float& OutThickness) const
+{
+	FTrickyUnitWireframeCache& Cache = FTrickyUnitWireframeCache::Get();
+
+	auto AddShape = [&Cache, &OutShapes](const FTrickyWireframeKey& Key, const FVector& Offset, const FVector& Scale)
+	{
+		OutShapes.Add({Cache.FindOrCreate(Key), FTransform(FQuat::Identity, Offset, Scale)});
+	};
+
+	switch (RulerType)
+	{
+	case ERulerType::Line:
+	case ERulerType::Grid:
+		return;
+
+	case ERulerType::Circle:
+		AddShape({ETrickyWireframeShape::Circle, CircleRuler.Segments}, FVector::ZeroVector, FVector(CircleRuler.Radius));
+		OutColor = CircleRuler.Color;
+		OutThickness = CircleRuler.Thickness;
+		break;
+
+	case ERulerType::Sphere:
+		AddShape({ETrickyWireframeShape::Sphere, SphereRuler.Segments}, FVector::ZeroVector, FVector(SphereRuler.Radius));
+		AddShape({ETrickyWireframeShape::Cross}, FVector::ZeroVector, FVector(SphereRuler.Radius));
+		OutColor = SphereRuler.Color;
+		OutThickness = SphereRuler.Thickness;
+		break;
+
+	case ERulerType::Cylinder:
+		AddShape({ETrickyWireframeShape::Cylinder, CylinderRuler.Segments},
+		         FVector(0.f, 0.f, CylinderRuler.bCenterOrigin ? -CylinderRuler.GetHalfHeight() : 0.f),
+		         FVector(CylinderRuler.Radius, CylinderRuler.Radius, CylinderRuler.Height));
+		AddShape({ETrickyWireframeShape::Cross}, FVector::ZeroVector, FVector(CylinderRuler.Radius));
+		OutColor = CylinderRuler.Color;
+		OutThickness = CylinderRuler.Thickness;
+		break;
+
+	case ERulerType::Capsule:
+		{
+			// Hemispheres can't be scaled non-uniformly, so the proportions are a part of the key.
+			const float Radius = CapsuleRuler.Radius;
+			const float HalfAxis = FMath::Max(CapsuleRuler.GetHalfHeight() - Radius, 1.f);
+			AddShape({ETrickyWireframeShape::Capsule, 0, HalfAxis / Radius},
+			         FVector(0.f, 0.f, CapsuleRuler.bCenterOrigin ? 0.f : CapsuleRuler.GetHalfHeight()),
+			         FVector(Radius));
+			OutColor = CapsuleRuler.Color;
+			OutThickness = CapsuleRuler.Thickness;
+			break;
+		}
+
+	case ERulerType::Box:
+		AddShape({ETrickyWireframeShape::Box},
+		         FVector(0.f, 0.f, BoxRuler.bCenterOrigin ? 0.f : BoxRuler.LengthZ * 0.5f),
+		         FVector(BoxRuler.LengthX, BoxRuler.LengthY, BoxRuler.LengthZ));
+		OutColor = BoxRuler.Color;
+		OutThickness = BoxRuler.Thickness;
+		break;
+
+	case ERulerType::Cone:
+		AddShape({ETrickyWireframeShape::Cone, ConeRuler.Segments, ConeRuler.GetHalfAngle(), ConeRuler.bIsFlat},
+		         FVector::ZeroVector,
+		         FVector(ConeRuler.Length));
+		OutColor = ConeRuler.Color;
+		OutThickness = ConeRuler.Thickness;
+		break;
+	}
+}
+
+FTrickyGridSettings ATrickyRuler::MakeGridSettings() const
+{
+	FTrickyGridSettings Settings;
+	Settings.FirstCell = GridRuler.GetFirstCell();
+	Settings.CellsNum = GridRuler.GetCellsNum();
+	Settings.CellSize = GridRuler.CellSize;
+	Settings.MajorLineInterval = GridRuler.MajorLineInterval;
+	Settings.Color = GridRuler.Color;
+	Settings.Thickness = GridRuler.Thickness;
+	Settings.MajorThickness = GridRuler.MajorThickness;
+	Settings.MinLineSpacing = GridRuler.MinLineSpacing;
+	return Settings;
+}
+
+void ATrickyRuler::BuildGridLabels(TArray<FTrickyNumericLabel>& OutLabels) const
+{
+	if (RulerType != ERulerType::Grid || !GridRuler.bShowMajorLabels)
+	{
+		return;
+	}
+
+	const FTransform& ActorTransform = GetActorTransform();
+	const FIntVector FirstCell = GridRuler.GetFirstCell();
+	const FIntVector LastCell = FirstCell + GridRuler.GetCellsNum();
+	const float CellSize = GridRuler.CellSize;
+	FTrickyNumericLabel Label;
+	Label.Kind = ETrickyNumericLabelKind::GridLine;
+	Label.Color = GridRuler.Color;
+
+	// Coarser lines keep their labels longer, as the distance between them is larger.
+	auto AddLabel = [&](const int32 Index, const FVector& Location)
+	{
+		const int32 Level = FTrickyGridGeometry::GetLineLevel(Index, GridRuler.MajorLineInterval);
+
+		if (Level == 0)
+		{
+			return;
+		}
+
+		Label.Index = Index;
+		Label.Value = Index * CellSize / 100.f;
+		Label.Location = ActorTransform.TransformPosition(Location);
+		Label.CullSize = CellSize * FMath::Pow(static_cast<float>(GridRuler.MajorLineInterval), Level);
+		OutLabels.Add(Label);
+	};
+
+	for (int32 X = FirstCell.X; X <= LastCell.X; ++X)
+	{
+		AddLabel(X, FVector(X * CellSize, FirstCell.Y * CellSize, 0.f));
+	}
+
+	for (int32 Y = FirstCell.Y; Y <= LastCell.Y; ++Y)
+	{
+		AddLabel(Y, FVector(FirstCell.X * CellSize, Y * CellSize, 0.f));
+	}
+}
+
+void ATrickyRuler::GetRuntimeLines(TArray<FBatchedLine>& OutLines) const
+{
+	if (RulerType == ERulerType::Line)
+	{
+		ForEachLineRulerSegment([this, &OutLines](const FVector& Start, const FVector& End)
+		{
+			OutLines.Emplace(Start, End, FLinearColor(LineRuler.Color), 0.f, LineRuler.Thickness, SDPG_World);
+		});
+
+		return;
+	}
+
+	if (RulerType == ERulerType::Grid)
+	{
+		// Runtime lines are persistent, so all levels of the grid are drawn.
+		const TSharedRef<const FTrickyGridGeometry, ESPMode::ThreadSafe> Geometry =
+			FTrickyGridGeometry::Build(MakeGridSettings());
+		const FMatrix ActorToWorld = GetActorTransform().ToMatrixNoScale();
+
+		for (int32 i = 0; i < Geometry->LevelLinesNum[0]; ++i)
+		{
+			OutLines.Emplace(ActorToWorld.TransformPosition(FVector(Geometry->LinePoints[i * 2])),
+			                 ActorToWorld.TransformPosition(FVector(Geometry->LinePoints[i * 2 + 1])),
+			                 FLinearColor(GridRuler.Color),
+			                 0.f,
+			                 i < Geometry->LevelLinesNum[1] ? GridRuler.MajorThickness : GridRuler.Thickness,
+			                 SDPG_World);
+		}
+
+		return;
+	}
+
+	TArray<FTrickyWireframeInstance> Shapes;
+	FColor Color = FColor::White;
+	float Thickness = 1.f;
+	BuildShapes(Shapes, Color, Thickness);
+
+	const FMatrix ActorToWorld = GetActorTransform().ToMatrixNoScale();
+
+	for (const FTrickyWireframeInstance& Shape : Shapes)
+	{
+		const FMatrix ShapeToWorld = Shape.Transform.ToMatrixWithScale() * ActorToWorld;
+		const TArray<FVector3f>& Points = Shape.Wireframe->LinePoints;
+
+		for (int32 i = 0; i + 1 < Points.Num(); i += 2)
+		{
+			OutLines.Emplace(ShapeToWorld.TransformPosition(FVector(Points[i])),
+			                 ShapeToWorld.TransformPosition(FVector(Points[i + 1])),
+			                 FLinearColor(Color),
+			                 0.f,
+			                 Thickness,
+			                 SDPG_World);
+		}
+	}
+}
+
+void ATrickyRuler::GetRuntimeLabels(TArray<FTrickyRuntimeLabel>& OutLabels) const
+{
+	if (bShowDebugText)
+	{
+		OutLabels.Add({GetActorLocation(), DebugTextData.Text, DebugTextData.Color.ToFColor(true)});
+	}
+
+	TArray<FTrickyNumericLabel> GridLabels;
+	BuildGridLabels(GridLabels);
+
+	for (const FTrickyNumericLabel& Label : GridLabels)
+	{
+		OutLabels.Add({Label.Location, Label.ToString(), Label.Color});
+	}
+}
+
+FTrickyRulerGroupStatePtr ATrickyRuler::GetRuntimeGroupState() const
+{
+	return GroupState;
+}
+
+#if WITH_EDITOR
+void ATrickyRuler::GetDescriptorShape(TArray<FVector>& OutPoints) const
+{
+	OutPoints.Reset();
+
+	if (RulerType == ERulerType::Line)
+	{
+		OutPoints.Add(GetActorLocation());
+		OutPoints.Add(GetActorLocation() + GetActorForwardVector() * LineRuler.Length);
+	}
+}
+#endif
+
+void ATrickyRuler::HandleRuntimeRulerMoved(USceneComponent* Component,
+                                           EUpdateTransformFlags UpdateTransformFlags,
+                                           ETeleportType Teleport)
+{
+	UTrickyRulerSubsystem::MarkRuntimeRulerDirty(this);
+}
+
+bool ATrickyRuler::CanContainActors() const
+{
+	return bReportContainedActors && (RulerType == ERulerType::Sphere || RulerType == ERulerType::Cone);
+}
+
+void ATrickyRuler::MarkContainedActorsDirty()
+{
+	bAreContainedActorsDirty = true;
+}
+
+void ATrickyRuler::UpdateContainedActors(const float DeltaTime)
+{
+	TimeSinceContainedActorsQuery += DeltaTime;
+
+	if (!CanContainActors())
+	{
+		bHasContainedActorsQueryFinished = false;
+
+		if (ContainedActors.Num() > 0)
+		{
+			ContainedActors.Empty();
+			UpdateContainedActorsShapes();
+		}
+
+		return;
+	}
+
+	// Actors moved by gameplay don't send editor notifications, so they're polled with the refresh interval.
+	const bool bIsGameWorld = GetWorld() && GetWorld()->IsGameWorld();
+
+	if ((bAreContainedActorsDirty || bIsGameWorld)
+		&& !ContainedActorsQueryHandle.IsValid()
+		&& TimeSinceContainedActorsQuery >= ContainedActorsSettings.RefreshInterval)
+	{
+		StartContainedActorsQuery();
+	}
+}
+
+void ATrickyRuler::StartContainedActorsQuery()
+{
+	UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return;
+	}
+
+	const FCollisionObjectQueryParams ObjectQueryParams = ContainedActorsSettings.ObjectTypes.Num() > 0
+		                                                      ? FCollisionObjectQueryParams(
+			                                                      ContainedActorsSettings.ObjectTypes)
+		                                                      : FCollisionObjectQueryParams(
+			                                                      FCollisionObjectQueryParams::AllObjects);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrickyRulerContainedActors), false, this);
+	const float Radius = RulerType == ERulerType::Sphere ? SphereRuler.Radius : ConeRuler.Length;
+
+	FOverlapDelegate OverlapDelegate;
+	OverlapDelegate.BindUObject(this, &ATrickyRuler::HandleContainedActorsQueryDone);
+	ContainedActorsQueryHandle = World->AsyncOverlapByObjectType(GetActorLocation(),
+	                                                             FQuat::Identity,
+	                                                             ObjectQueryParams,
+	                                                             FCollisionShape::MakeSphere(Radius),
+	                                                             QueryParams,
+	                                                             &OverlapDelegate);
+	bAreContainedActorsDirty = false;
+	TimeSinceContainedActorsQuery = 0.f;
+}
+
+void ATrickyRuler::HandleContainedActorsQueryDone(const FTraceHandle& TraceHandle, FOverlapDatum& OverlapDatum)
+{
+	if (!(TraceHandle == ContainedActorsQueryHandle))
+	{
+		return;
+	}
+
+	ContainedActorsQueryHandle = FTraceHandle();
+
+	if (!CanContainActors())
+	{
+		return;
+	}
+
+	bHasContainedActorsQueryFinished = true;
+	TArray<TWeakObjectPtr<AActor>> FoundActors;
+	TArray<FBox> FoundBounds;
+	TSet<const AActor*> CheckedActors;
+
+	for (const FOverlapResult& Overlap : OverlapDatum.OutOverlaps)
+	{
+		AActor* Actor = Overlap.GetActor();
+		bool bIsAlreadyChecked = false;
+		CheckedActors.Add(Actor, &bIsAlreadyChecked);
+
+		if (bIsAlreadyChecked || !IsValid(Actor) || Actor == this)
+		{
+			continue;
+		}
+
+		if (ContainedActorsSettings.ActorClass && !Actor->IsA(ContainedActorsSettings.ActorClass))
+		{
+			continue;
+		}
+
+		if (IsInsideRuler(Actor->GetActorLocation()))
+		{
+			FoundActors.Add(Actor);
+			FoundBounds.Add(Actor->GetComponentsBoundingBox(true));
+		}
+	}
+
+	// Most of the queries return the same actors at the same places, there's no need to touch the render state then.
+	if (FoundActors == ContainedActors && FoundBounds == ContainedActorsBounds)
+	{
+		return;
+	}
+
+	const bool bHaveActorsChanged = FoundActors != ContainedActors;
+	ContainedActors = MoveTemp(FoundActors);
+	UpdateContainedActorsShapes();
+
+	if (bHaveActorsChanged)
+	{
+		UpdateDimensions();
+	}
+}
+
+bool ATrickyRuler::IsInsideRuler(const FVector& Location) const
+{
+	const FVector ToLocation = Location - GetActorLocation();
+
+	if (RulerType == ERulerType::Sphere)
+	{
+		return ToLocation.SizeSquared() <= FMath::Square(SphereRuler.Radius);
+	}
+
+	if (ToLocation.SizeSquared() > FMath::Square(ConeRuler.Length))
+	{
+		return false;
+	}
+
+	const FVector Direction = ConeRuler.bIsFlat
+		                          ? FVector::VectorPlaneProject(ToLocation, GetActorUpVector())
+		                          : ToLocation;
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(ConeRuler.GetHalfAngle()));
+	return (Direction.GetSafeNormal() | GetActorForwardVector()) >= CosHalfAngle;
+}
+
+void ATrickyRuler::UpdateContainedActorsShapes()
+{
+	if (!DebugShapesComponent)
+	{
+		return;
+	}
+
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+	Lines.Reserve(ContainedActors.Num() * 12);
+	ContainedActorsBounds.Reset();
+
+	for (const TWeakObjectPtr<AActor>& ContainedActor : ContainedActors)
+	{
+		if (const AActor* Actor = ContainedActor.Get())
+		{
+			const FBox& Bounds = ContainedActorsBounds.Add_GetRef(Actor->GetComponentsBoundingBox(true));
+			UTrickyDebugShapesComponent::AddBoxLines(Lines,
+			                                         Bounds,
+			                                         FTransform::Identity,
+			                                         ContainedActorsSettings.Color,
+			                                         ContainedActorsSettings.Thickness);
+		}
+	}
+
+	DebugShapesComponent->SetLines(MoveTemp(Lines));
+}
+
+void ATrickyRuler::HandleActorMoved(AActor* Actor)
+{
+	if (!Actor || Actor == this)
+	{
+		return;
+	}
+
+	if (Elevation.IsValid())
+	{
+		Elevation->Invalidate(GetWorld(), Actor);
+	}
+
+	if (!CanContainActors())
+	{
+		return;
+	}
+
+	const float Radius = RulerType == ERulerType::Sphere ? SphereRuler.Radius : ConeRuler.Length;
+	const bool bIsNearby = FVector::DistSquared(Actor->GetActorLocation(), GetActorLocation()) <= FMath::Square(Radius);
+
+	const bool bIsContained = ContainedActors.Contains(Actor);
+
+	// The box of the moved actor is redrawn now, the query only tells whether it's still inside.
+	if (bIsContained)
+	{
+		UpdateContainedActorsShapes();
+	}
+
+	if (bIsNearby || bIsContained)
+	{
+		MarkContainedActorsDirty();
+	}
 }
@@ -0,0 +1,130 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulerActorDesc.h"
+
+#if WITH_EDITOR
+#include "TrickyRuler.h"
+#include "TrickyRulersGeometry.h"
+#include "TrickySplineRuler.h"
+#include "Serialization/CustomVersion.h"
+
+namespace TrickyRulerActorDescVersion
+{
+	enum Type : int32
+	{
+		Initial = 1,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	const FGuid GUID(0x5A1C3E07, 0x4B8D4F21, 0x9E6A7C30, 0xD2F41B85);
+
+	FCustomVersionRegistration Registration(GUID, LatestVersion, TEXT("TrickyRulerActorDescVersion"));
+}
+
+
+void FTrickyRulerActorDesc::SimplifyShape(TConstArrayView<FVector> Points, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+
+	if (Points.Num() <= MaxShapePoints)
+	{
+		OutPoints.Append(Points.GetData(), Points.Num());
+		return;
+	}
+
+	// Tolerance grows until the polyline fits, flat parts of long splines collapse first.
+	double Tolerance = 1.0;
+
+	do
+	{
+		TrickyRulersGeometry::SimplifyPolyline(Points, Tolerance, OutPoints);
+		Tolerance *= 2.0;
+	}
+	while (OutPoints.Num() > MaxShapePoints);
+}
+
+void FTrickyRulerActorDesc::Init(const AActor* InActor)
+{
+	FWorldPartitionActorDesc::Init(InActor);
+
+	RulerTransform = InActor->GetActorTransform();
+	Measurements.Reset();
+	ShapePoints.Reset();
+
+	if (const ATrickyRuler* Ruler = Cast<ATrickyRuler>(InActor))
+	{
+		Kind = FName(StaticEnum<ERulerType>()->GetNameStringByValue(static_cast<int64>(Ruler->GetRulerType())));
+		Group = Ruler->GetGroup();
+		Ruler->GetMeasurements(Measurements);
+		Ruler->GetDescriptorShape(ShapePoints);
+	}
+	else if (const ATrickySplineRuler* SplineRuler = Cast<ATrickySplineRuler>(InActor))
+	{
+		Kind = TEXT("Spline");
+		Group = SplineRuler->GetGroup();
+		SplineRuler->GetMeasurements(Measurements);
+		SplineRuler->GetDescriptorShape(ShapePoints);
+	}
+}
+
+void FTrickyRulerActorDesc::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(TrickyRulerActorDescVersion::GUID);
+
+	FWorldPartitionActorDesc::Serialize(Ar);
+
+	// Descriptors saved before the rulers had their own ones have no data.
+	if (Ar.CustomVer(TrickyRulerActorDescVersion::GUID) < TrickyRulerActorDescVersion::Initial)
+	{
+		return;
+	}
+
+	Ar << Kind << Group << RulerTransform << ShapePoints;
+
+	int32 MeasurementsNum = Measurements.Num();
+	Ar << MeasurementsNum;
+
+	if (Ar.IsLoading())
+	{
+		Measurements.SetNum(MeasurementsNum);
+	}
+
+	for (FTrickyMeasurement& Measurement : Measurements)
+	{
+		Ar << Measurement.Name << Measurement.Value;
+	}
+}
+
+bool FTrickyRulerActorDesc::Equals(const FWorldPartitionActorDesc* Other) const
+{
+	if (!FWorldPartitionActorDesc::Equals(Other))
+	{
+		return false;
+	}
+
+	const FTrickyRulerActorDesc* OtherDesc = static_cast<const FTrickyRulerActorDesc*>(Other);
+
+	if (Kind != OtherDesc->Kind
+		|| Group != OtherDesc->Group
+		|| !RulerTransform.Equals(OtherDesc->RulerTransform)
+		|| ShapePoints != OtherDesc->ShapePoints
+		|| Measurements.Num() != OtherDesc->Measurements.Num())
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < Measurements.Num(); ++i)
+	{
+		if (Measurements[i].Name != OtherDesc->Measurements[i].Name
+			|| Measurements[i].Value != OtherDesc->Measurements[i].Value)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif
@@ -0,0 +1,154 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulerGroups.h"
+
+#include "Misc/ConfigCacheIni.h"
+
+namespace TrickyRulerGroups
+{
+	const TCHAR* ConfigSection = TEXT("TrickyRulers.Groups");
+
+	bool CanUseConfig()
+	{
+#if WITH_EDITOR
+		return GIsEditor && GConfig && !IsRunningCommandlet();
+#else
+		return false;
+#endif
+	}
+}
+
+
+FTrickyRulerGroups& FTrickyRulerGroups::Get()
+{
+	static FTrickyRulerGroups Instance;
+	return Instance;
+}
+
+FTrickyRulerGroupStatePtr FTrickyRulerGroups::FindOrAdd(const FName Group)
+{
+	check(IsInGameThread());
+
+	if (Group.IsNone())
+	{
+		return nullptr;
+	}
+
+	if (const FTrickyRulerGroupStatePtr* State = Groups.Find(Group))
+	{
+		return *State;
+	}
+
+	const FTrickyRulerGroupStatePtr& State =
+		Groups.Add(Group, MakeShared<FTrickyRulerGroupState, ESPMode::ThreadSafe>());
+	LoadState(Group, *State);
+	return State;
+}
+
+FTrickyRulerGroupStatePtr FTrickyRulerGroups::Find(const FName Group) const
+{
+	check(IsInGameThread());
+
+	const FTrickyRulerGroupStatePtr* State = Groups.Find(Group);
+	return State ? *State : nullptr;
+}
+
+void FTrickyRulerGroups::SetHidden(const FName Group, const bool bIsHidden)
+{
+	if (const FTrickyRulerGroupStatePtr State = Find(Group))
+	{
+		State->bIsHidden = bIsHidden;
+		++Revision;
+		SaveState(Group, *State);
+	}
+}
+
+void FTrickyRulerGroups::SetLocked(const FName Group, const bool bIsLocked)
+{
+	if (const FTrickyRulerGroupStatePtr State = Find(Group))
+	{
+		State->bIsLocked = bIsLocked;
+		SaveState(Group, *State);
+	}
+}
+
+void FTrickyRulerGroups::SetColor(const FName Group, const FColor& Color)
+{
+	if (const FTrickyRulerGroupStatePtr State = Find(Group))
+	{
+		FColor OpaqueColor = Color;
+		OpaqueColor.A = 255;
+		State->ColorOverride = OpaqueColor.DWColor();
+		++Revision;
+		SaveState(Group, *State);
+	}
+}
+
+void FTrickyRulerGroups::ResetColor(const FName Group)
+{
+	if (const FTrickyRulerGroupStatePtr State = Find(Group))
+	{
+		State->ColorOverride = 0;
+		++Revision;
+		SaveState(Group, *State);
+	}
+}
+
+void FTrickyRulerGroups::GetGroupNames(TArray<FName>& OutGroups) const
+{
+	Groups.GetKeys(OutGroups);
+}
+
+void FTrickyRulerGroups::LoadState(const FName Group, FTrickyRulerGroupState& State)
+{
+	FString Value;
+
+	if (!TrickyRulerGroups::CanUseConfig()
+		|| !GConfig->GetString(TrickyRulerGroups::ConfigSection, *Group.ToString(), Value, GEditorPerProjectIni))
+	{
+		return;
+	}
+
+	bool bIsHidden = false;
+	bool bIsLocked = false;
+	FString Color;
+	FParse::Bool(*Value, TEXT("Hidden="), bIsHidden);
+	FParse::Bool(*Value, TEXT("Locked="), bIsLocked);
+	State.bIsHidden = bIsHidden;
+	State.bIsLocked = bIsLocked;
+
+	if (FParse::Value(*Value, TEXT("Color="), Color))
+	{
+		State.ColorOverride = FColor::FromHex(Color).DWColor();
+	}
+}
+
+void FTrickyRulerGroups::SaveState(const FName Group, const FTrickyRulerGroupState& State)
+{
+	if (!TrickyRulerGroups::CanUseConfig())
+	{
+		return;
+	}
+
+	const FString Key = Group.ToString();
+	const FColor Color(State.ColorOverride.load(std::memory_order_relaxed));
+
+	// Groups in the default state are removed, so the settings don't collect every group ever used.
+	if (!State.IsHidden() && !State.IsLocked() && Color.A == 0)
+	{
+		GConfig->RemoveKey(TrickyRulerGroups::ConfigSection, *Key, GEditorPerProjectIni);
+	}
+	else
+	{
+		GConfig->SetString(TrickyRulerGroups::ConfigSection,
+		                   *Key,
+		                   *FString::Printf(TEXT("Hidden=%s Locked=%s Color=%s"),
+		                                    State.IsHidden() ? TEXT("True") : TEXT("False"),
+		                                    State.IsLocked() ? TEXT("True") : TEXT("False"),
+		                                    *Color.ToHex()),
+		                   GEditorPerProjectIni);
+	}
+
+	GConfig->Flush(false, GEditorPerProjectIni);
+}
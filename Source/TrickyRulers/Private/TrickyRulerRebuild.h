@@ -0,0 +1,44 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrickyDebugTextComponent.h"
+#include "TrickyGridComponent.h"
+#include "TrickyMeasurement.h"
+
+class ATrickyRuler;
+
+/**
+ * Rebuild of a single ruler split into three steps. Inputs which touch other objects are gathered on the game thread,
+ * the text and the grid are built on any thread, and the results are passed to the components on the game thread.
+ */
+struct FTrickyRulerRebuild
+{
+	ATrickyRuler* Ruler = nullptr;
+
+	FString Name;
+
+	FString ElevationText;
+
+	int32 ContainedActorsNum = 0;
+
+	TArray<FString> ContainedActorNames;
+
+	TArray<FTrickyMeasurement> Measurements;
+
+	FTrickyGridSettings GridSettings;
+
+	/**
+	 * Set if the grid component can't reuse its current lines.
+	 */
+	bool bNeedsGridGeometry = false;
+
+	FString Dimensions;
+
+	FColor TextColor = FColor::Magenta;
+
+	TArray<FTrickyNumericLabel> GridLabels;
+
+	FTrickyGridGeometryPtr GridGeometry;
+};
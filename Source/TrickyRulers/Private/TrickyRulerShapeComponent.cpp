@@ -0,0 +1,161 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulerShapeComponent.h"
+
+#include "DebugRenderSceneProxy.h"
+#include "TrickyUnitWireframeCache.h"
+#include "TrickyRulersMemory.h"
+
+class FTrickyRulerShapeSceneProxy : public FDebugRenderSceneProxy
+{
+public:
+	FTrickyRulerShapeSceneProxy(const UPrimitiveComponent* InComponent,
+	                            const TArray<FTrickyWireframeInstance>& InShapes,
+	                            const FColor& InColor,
+	                            const float InThickness,
+	                            const FTrickyRulerGroupStatePtr& InGroupState)
+		: FDebugRenderSceneProxy(InComponent),
+		  Shapes(InShapes),
+		  Color(InColor),
+		  Thickness(InThickness),
+		  GroupState(InGroupState)
+	{
+		DrawType = EDrawType::WireMesh;
+		ViewFlagName = TEXT("Editor");
+		ViewFlagIndex = static_cast<uint32>(FEngineShowFlags::FindIndexByName(*ViewFlagName));
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views,
+	                                    const FSceneViewFamily& ViewFamily,
+	                                    uint32 VisibilityMap,
+	                                    FMeshElementCollector& Collector) const override
+	{
+		if (GroupState.IsValid() && GroupState->IsHidden())
+		{
+			return;
+		}
+
+		const FColor LineColor = GroupState.IsValid() ? GroupState->GetColor(Color) : Color;
+
+		// Dimensions are set by the ruler properties, so the actor scale is ignored.
+		FMatrix LocalToWorld = GetLocalToWorld();
+		LocalToWorld.RemoveScaling();
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+		{
+			if (!(VisibilityMap & (1 << ViewIndex)))
+			{
+				continue;
+			}
+
+			FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
+
+			for (const FTrickyWireframeInstance& Shape : Shapes)
+			{
+				const FMatrix ShapeToWorld = Shape.Transform.ToMatrixWithScale() * LocalToWorld;
+				const TArray<FVector3f>& Points = Shape.Wireframe->LinePoints;
+
+				for (int32 i = 0; i + 1 < Points.Num(); i += 2)
+				{
+					PDI->DrawLine(ShapeToWorld.TransformPosition(FVector(Points[i])),
+					              ShapeToWorld.TransformPosition(FVector(Points[i + 1])),
+					              LineColor,
+					              SDPG_World,
+					              Thickness,
+					              0.f,
+					              true);
+				}
+			}
+		}
+	}
+
+private:
+	/**
+	 * Holds references to the wireframes, so they can't be released while the proxy is alive.
+	 */
+	TArray<FTrickyWireframeInstance> Shapes;
+
+	FColor Color;
+
+	float Thickness;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::RulerShape};
+};
+
+UTrickyRulerShapeComponent::UTrickyRulerShapeComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bIsEditorOnly = true;
+}
+
+void UTrickyRulerShapeComponent::SetShapes(TArray<FTrickyWireframeInstance>&& InShapes,
+                                           const FColor& InColor,
+                                           const float InThickness)
+{
+	Shapes = MoveTemp(InShapes);
+	Color = InColor;
+	Thickness = InThickness;
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTrickyRulerShapeComponent::ClearShapes()
+{
+	if (Shapes.Num() == 0)
+	{
+		return;
+	}
+
+	Shapes.Empty();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTrickyRulerShapeComponent::SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState)
+{
+	if (GroupState == InGroupState)
+	{
+		return;
+	}
+
+	GroupState = InGroupState;
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UTrickyRulerShapeComponent::CreateDebugSceneProxy()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	if (Shapes.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return new FTrickyRulerShapeSceneProxy(this, Shapes, Color, Thickness, GroupState);
+}
+
+FBoxSphereBounds UTrickyRulerShapeComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	FBox Bounds(ForceInit);
+	FTransform UnscaledLocalToWorld = LocalToWorld;
+	UnscaledLocalToWorld.SetScale3D(FVector::OneVector);
+
+	for (const FTrickyWireframeInstance& Shape : Shapes)
+	{
+		if (Shape.Wireframe.IsValid() && Shape.Wireframe->Bounds.IsValid)
+		{
+			Bounds += FBox(Shape.Wireframe->Bounds).TransformBy(Shape.Transform * UnscaledLocalToWorld);
+		}
+	}
+
+	return Bounds.IsValid ? FBoxSphereBounds(Bounds) : FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+}
@@ -0,0 +1,433 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulerSubsystem.h"
+
+#include "TrickyRuler.h"
+#include "TrickyRulerRebuild.h"
+#include "TrickyRulersMemory.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+void UTrickyRulerSubsystem::RequestUpdate(ATrickyRuler* Ruler)
+{
+	if (!Ruler)
+	{
+		return;
+	}
+
+	UTrickyRulerSubsystem* Subsystem = GetTickedSubsystem(Ruler->GetWorld());
+
+	if (!Subsystem)
+	{
+		Ruler->FinishDeferredUpdate();
+		return;
+	}
+
+	Subsystem->PendingRulers.Add(Ruler);
+	Subsystem->bArePendingRulersSorted = false;
+}
+
+void UTrickyRulerSubsystem::RequestRebuild(ATrickyRuler* Ruler)
+{
+	if (!Ruler)
+	{
+		return;
+	}
+
+	UTrickyRulerSubsystem* Subsystem = GetTickedSubsystem(Ruler->GetWorld());
+
+	if (!Subsystem)
+	{
+		FTrickyRulerRebuild Rebuild;
+		Ruler->PrepareRebuild(Rebuild);
+		Ruler->BuildRebuild(Rebuild);
+		Ruler->ApplyRebuild(Rebuild);
+		return;
+	}
+
+	Subsystem->DirtyRulers.Add(Ruler);
+}
+
+void UTrickyRulerSubsystem::RegisterRuntimeRuler(AActor* Actor, ITrickyRuntimeRuler* Ruler)
+{
+	const UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+	UTrickyRulerSubsystem* Subsystem = World ? World->GetSubsystem<UTrickyRulerSubsystem>() : nullptr;
+
+	if (!Subsystem || !Ruler)
+	{
+		return;
+	}
+
+	FRuntimeRulerEntry& Entry = Subsystem->RuntimeRulers.AddDefaulted_GetRef();
+	Entry.Actor = Actor;
+	Entry.Ruler = Ruler;
+	Entry.BatchId = Subsystem->NextRuntimeBatchId++;
+	Subsystem->bAreRuntimeRulersDirty = true;
+
+	if (!Subsystem->DrawRuntimeLabelsHandle.IsValid())
+	{
+		Subsystem->DrawRuntimeLabelsHandle = UDebugDrawService::Register(
+			TEXT("Game"),
+			FDebugDrawDelegate::CreateUObject(Subsystem, &UTrickyRulerSubsystem::DrawRuntimeLabels));
+	}
+}
+
+void UTrickyRulerSubsystem::UnregisterRuntimeRuler(AActor* Actor)
+{
+	const UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+	UTrickyRulerSubsystem* Subsystem = World ? World->GetSubsystem<UTrickyRulerSubsystem>() : nullptr;
+
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	ULineBatchComponent* LineBatcher = World->PersistentLineBatcher;
+
+	Subsystem->RuntimeRulers.RemoveAll([Actor, LineBatcher](const FRuntimeRulerEntry& Entry)
+	{
+		if (Entry.Actor.Get() != Actor)
+		{
+			return false;
+		}
+
+		if (LineBatcher)
+		{
+			LineBatcher->ClearBatch(Entry.BatchId);
+		}
+
+		return true;
+	});
+}
+
+void UTrickyRulerSubsystem::MarkRuntimeRulerDirty(AActor* Actor)
+{
+	const UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+	UTrickyRulerSubsystem* Subsystem = World ? World->GetSubsystem<UTrickyRulerSubsystem>() : nullptr;
+
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	for (FRuntimeRulerEntry& Entry : Subsystem->RuntimeRulers)
+	{
+		if (Entry.Actor.Get() == Actor)
+		{
+			Entry.bIsDirty = true;
+			Subsystem->bAreRuntimeRulersDirty = true;
+			return;
+		}
+	}
+}
+
+void UTrickyRulerSubsystem::Deinitialize()
+{
+	if (DrawRuntimeLabelsHandle.IsValid())
+	{
+		UDebugDrawService::Unregister(DrawRuntimeLabelsHandle);
+		DrawRuntimeLabelsHandle.Reset();
+	}
+
+	DirtyRulers.Empty();
+	RuntimeRulers.Empty();
+
+	Super::Deinitialize();
+}
+
+void UTrickyRulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (DirtyRulers.Num() > 0)
+	{
+		RebuildDirtyRulers();
+	}
+
+	if (HaveRuntimeGroupsChanged())
+	{
+		MarkChangedRuntimeGroupsDirty();
+	}
+
+	if (bAreRuntimeRulersDirty)
+	{
+		RebuildRuntimeRulers();
+	}
+
+	if (!bArePendingRulersSorted)
+	{
+		SortPendingRulers();
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + UpdateBudgetSeconds;
+
+	while (NextRulerIndex < PendingRulers.Num() && FPlatformTime::Seconds() < EndTime)
+	{
+		if (ATrickyRuler* Ruler = PendingRulers[NextRulerIndex].Get())
+		{
+			Ruler->FinishDeferredUpdate();
+		}
+
+		++NextRulerIndex;
+	}
+
+	if (NextRulerIndex >= PendingRulers.Num())
+	{
+		PendingRulers.Reset();
+		NextRulerIndex = 0;
+	}
+}
+
+TStatId UTrickyRulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTrickyRulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UTrickyRulerSubsystem::IsTickable() const
+{
+	return PendingRulers.Num() > 0 || DirtyRulers.Num() > 0 || bAreRuntimeRulersDirty || HaveRuntimeGroupsChanged();
+}
+
+bool UTrickyRulerSubsystem::IsTickableInEditor() const
+{
+	return true;
+}
+
+bool UTrickyRulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Editor || WorldType == EWorldType::PIE || WorldType == EWorldType::Game;
+}
+
+UTrickyRulerSubsystem* UTrickyRulerSubsystem::GetTickedSubsystem(const UWorld* World)
+{
+	// Commandlets don't tick the worlds, and outside of the editor only the game worlds are ticked.
+	if (!World || IsRunningCommandlet() || (!World->IsGameWorld() && !GIsEditor))
+	{
+		return nullptr;
+	}
+
+	return World->GetSubsystem<UTrickyRulerSubsystem>();
+}
+
+void UTrickyRulerSubsystem::SortPendingRulers()
+{
+	PendingRulers.RemoveAt(0, NextRulerIndex, EAllowShrinking::No);
+	NextRulerIndex = 0;
+	bArePendingRulersSorted = true;
+
+	const TArray<FVector>& ViewLocations = GetWorld()->ViewLocationsRenderedLastFrame;
+
+	if (ViewLocations.Num() == 0)
+	{
+		return;
+	}
+
+	// The closest rulers are most likely on screen, so their labels appear first.
+	Algo::SortBy(PendingRulers, [&ViewLocations](const TWeakObjectPtr<ATrickyRuler>& Ruler)
+	{
+		if (!Ruler.IsValid())
+		{
+			return 0.0;
+		}
+
+		double MinDistanceSquared = TNumericLimits<double>::Max();
+
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			MinDistanceSquared = FMath::Min(MinDistanceSquared,
+			                                FVector::DistSquared(ViewLocation, Ruler->GetActorLocation()));
+		}
+
+		return MinDistanceSquared;
+	});
+}
+
+void UTrickyRulerSubsystem::RebuildDirtyRulers()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	TArray<ATrickyRuler*> Rulers;
+	Rulers.Reserve(FMath::Min(DirtyRulers.Num(), MaxRebuildsPerTick));
+
+	for (auto It = DirtyRulers.CreateIterator(); It && Rulers.Num() < MaxRebuildsPerTick; ++It)
+	{
+		if (ATrickyRuler* Ruler = It->Get())
+		{
+			Rulers.Add(Ruler);
+		}
+
+		It.RemoveCurrent();
+	}
+
+	TArray<FTrickyRulerRebuild> Rebuilds;
+	Rebuilds.SetNum(Rulers.Num());
+
+	for (int32 i = 0; i < Rulers.Num(); ++i)
+	{
+		Rulers[i]->PrepareRebuild(Rebuilds[i]);
+	}
+
+	// The game thread waits for the workers, so the rulers can't change while their properties are read.
+	ParallelFor(Rebuilds.Num(), [&Rebuilds](const int32 Index)
+	{
+		LLM_SCOPE_BYTAG(TrickyRulers);
+		Rebuilds[Index].Ruler->BuildRebuild(Rebuilds[Index]);
+	});
+
+	for (FTrickyRulerRebuild& Rebuild : Rebuilds)
+	{
+		Rebuild.Ruler->ApplyRebuild(Rebuild);
+	}
+}
+
+bool UTrickyRulerSubsystem::HaveRuntimeGroupsChanged() const
+{
+	return RuntimeRulers.Num() > 0 && RuntimeGroupsRevision != FTrickyRulerGroups::Get().GetRevision();
+}
+
+void UTrickyRulerSubsystem::MarkChangedRuntimeGroupsDirty()
+{
+	RuntimeGroupsRevision = FTrickyRulerGroups::Get().GetRevision();
+
+	for (FRuntimeRulerEntry& Entry : RuntimeRulers)
+	{
+		if (!Entry.Actor.IsValid())
+		{
+			continue;
+		}
+
+		const FTrickyRulerGroupStatePtr GroupState = Entry.Ruler->GetRuntimeGroupState();
+
+		if (!GroupState.IsValid())
+		{
+			continue;
+		}
+
+		if (GroupState->IsHidden() != Entry.bWasGroupHidden
+			|| GroupState->ColorOverride.load(std::memory_order_relaxed) != Entry.GroupColorOverride)
+		{
+			Entry.bIsDirty = true;
+			bAreRuntimeRulersDirty = true;
+		}
+	}
+}
+
+void UTrickyRulerSubsystem::RebuildRuntimeRulers()
+{
+	bAreRuntimeRulersDirty = false;
+	ULineBatchComponent* LineBatcher = GetWorld()->PersistentLineBatcher;
+
+	RuntimeRulers.RemoveAll([LineBatcher](const FRuntimeRulerEntry& Entry)
+	{
+		if (Entry.Actor.IsValid())
+		{
+			return false;
+		}
+
+		if (LineBatcher)
+		{
+			LineBatcher->ClearBatch(Entry.BatchId);
+		}
+
+		return true;
+	});
+
+	for (FRuntimeRulerEntry& Entry : RuntimeRulers)
+	{
+		if (Entry.bIsDirty)
+		{
+			RebuildRuntimeRuler(Entry, LineBatcher);
+		}
+	}
+}
+
+void UTrickyRulerSubsystem::RebuildRuntimeRuler(FRuntimeRulerEntry& Entry, ULineBatchComponent* LineBatcher) const
+{
+	Entry.bIsDirty = false;
+	Entry.Labels.Reset();
+
+	if (LineBatcher)
+	{
+		LineBatcher->ClearBatch(Entry.BatchId);
+	}
+
+	const FTrickyRulerGroupStatePtr GroupState = Entry.Ruler->GetRuntimeGroupState();
+	Entry.bWasGroupHidden = GroupState.IsValid() && GroupState->IsHidden();
+	Entry.GroupColorOverride = GroupState.IsValid() ? GroupState->ColorOverride.load(std::memory_order_relaxed) : 0;
+
+	if (Entry.bWasGroupHidden)
+	{
+		return;
+	}
+
+	Entry.Ruler->GetRuntimeLabels(Entry.Labels);
+
+	for (FTrickyRuntimeLabel& Label : Entry.Labels)
+	{
+		Label.Color = GroupState.IsValid() ? GroupState->GetColor(Label.Color) : Label.Color;
+	}
+
+	if (!LineBatcher)
+	{
+		return;
+	}
+
+	TArray<FBatchedLine> Lines;
+	Entry.Ruler->GetRuntimeLines(Lines);
+
+	if (Lines.Num() == 0)
+	{
+		return;
+	}
+
+	// Zero lifetime keeps the lines in the persistent batcher until the batch is cleared.
+	for (FBatchedLine& Line : Lines)
+	{
+		Line.RemainingLifeTime = 0.f;
+		Line.BatchID = Entry.BatchId;
+
+		if (GroupState.IsValid())
+		{
+			Line.Color = FLinearColor(GroupState->GetColor(Line.Color.ToFColor(true)));
+		}
+	}
+
+	LineBatcher->DrawLines(Lines);
+}
+
+void UTrickyRulerSubsystem::DrawRuntimeLabels(UCanvas* Canvas, APlayerController* PlayerController) const
+{
+	if (!Canvas || !Canvas->SceneView || Canvas->SceneView->Family->Scene != GetWorld()->Scene)
+	{
+		return;
+	}
+
+	const FSceneView* View = Canvas->SceneView;
+	const UFont* Font = GEngine->GetSmallFont();
+	const FColor OldDrawColor = Canvas->DrawColor;
+
+	FFontRenderInfo FontRenderInfo;
+	FontRenderInfo.bEnableShadow = true;
+
+	for (const FRuntimeRulerEntry& Entry : RuntimeRulers)
+	{
+		for (const FTrickyRuntimeLabel& Label : Entry.Labels)
+		{
+			if (!View->ViewFrustum.IntersectSphere(Label.Location, 1.0f))
+			{
+				continue;
+			}
+
+			const FVector ScreenLocation = Canvas->Project(Label.Location);
+			Canvas->SetDrawColor(Label.Color);
+			Canvas->DrawText(Font, Label.Text, ScreenLocation.X, ScreenLocation.Y, 1.f, 1.f, FontRenderInfo);
+		}
+	}
+
+	Canvas->SetDrawColor(OldDrawColor);
+}
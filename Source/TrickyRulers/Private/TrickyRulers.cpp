@@ -2,17 +2,122 @@
 
 #include "TrickyRulers.h"
 
+#include "TrickyRulerGroups.h"
+#include "TrickyRulersMemory.h"
+#include "HAL/IConsoleManager.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
 #define LOCTEXT_NAMESPACE "FTrickyRulersModule"
 
 void FTrickyRulersModule::StartupModule()
 {
-	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.MemReport"),
+		TEXT("Logs the amount of rulers per class, their labels, live scene proxies and memory in bytes."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>&,
+		                                                                      UWorld* World,
+		                                                                      FOutputDevice& Output)
+		{
+			TrickyRulersMemory::Report(World, Output);
+		}),
+		ECVF_Default));
+
+	RegisterGroupCommands();
+}
+
+void FTrickyRulersModule::RegisterGroupCommands()
+{
+	auto RegisterGroupCommand = [this](const TCHAR* Name,
+	                                   const TCHAR* Help,
+	                                   TFunction<void(const FName, const TArray<FString>&)> Command)
+	{
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			Name,
+			Help,
+			FConsoleCommandWithArgsDelegate::CreateLambda([Name, Command](const TArray<FString>& Args)
+			{
+				if (Args.Num() == 0)
+				{
+					UE_LOG(LogConsoleResponse, Warning, TEXT("%s: group name is required."), Name);
+					return;
+				}
+
+				const FName Group(*Args[0]);
+
+				// Groups are created by their rulers, so a mistyped name doesn't add a new one.
+				if (!FTrickyRulerGroups::Get().Find(Group).IsValid())
+				{
+					UE_LOG(LogConsoleResponse, Warning, TEXT("%s: unknown group %s."), Name, *Args[0]);
+					return;
+				}
+
+				Command(Group, Args);
+
+#if WITH_EDITOR
+				if (GEditor)
+				{
+					GEditor->RedrawAllViewports();
+				}
+#endif
+			}),
+			ECVF_Default));
+	};
+
+	RegisterGroupCommand(TEXT("TrickyRulers.Group.Hide"),
+	                     TEXT("Hides all rulers of the group. Arguments: <Group>."),
+	                     [](const FName Group, const TArray<FString>&)
+	                     {
+		                     FTrickyRulerGroups::Get().SetHidden(Group, true);
+	                     });
+
+	RegisterGroupCommand(TEXT("TrickyRulers.Group.Show"),
+	                     TEXT("Shows all rulers of the group. Arguments: <Group>."),
+	                     [](const FName Group, const TArray<FString>&)
+	                     {
+		                     FTrickyRulerGroups::Get().SetHidden(Group, false);
+	                     });
+
+	RegisterGroupCommand(TEXT("TrickyRulers.Group.Lock"),
+	                     TEXT("Locks editing of all rulers of the group. Arguments: <Group>."),
+	                     [](const FName Group, const TArray<FString>&)
+	                     {
+		                     FTrickyRulerGroups::Get().SetLocked(Group, true);
+	                     });
+
+	RegisterGroupCommand(TEXT("TrickyRulers.Group.Unlock"),
+	                     TEXT("Unlocks editing of all rulers of the group. Arguments: <Group>."),
+	                     [](const FName Group, const TArray<FString>&)
+	                     {
+		                     FTrickyRulerGroups::Get().SetLocked(Group, false);
+	                     });
+
+	RegisterGroupCommand(TEXT("TrickyRulers.Group.Color"),
+	                     TEXT("Draws all rulers of the group with one color. Arguments: <Group> <Hex color>. "
+		                     "Without the color the rulers use their own colors again."),
+	                     [](const FName Group, const TArray<FString>& Args)
+	                     {
+		                     if (Args.Num() > 1)
+		                     {
+			                     FTrickyRulerGroups::Get().SetColor(Group, FColor::FromHex(Args[1]));
+		                     }
+		                     else
+		                     {
+			                     FTrickyRulerGroups::Get().ResetColor(Group);
+		                     }
+	                     });
 }
 
 void FTrickyRulersModule::ShutdownModule()
 {
-	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
-	// we call this function before unloading the module.
+	for (IConsoleObject* ConsoleCommand : ConsoleCommands)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(ConsoleCommand);
+	}
+
+	ConsoleCommands.Empty();
 }
 
 #undef LOCTEXT_NAMESPACE
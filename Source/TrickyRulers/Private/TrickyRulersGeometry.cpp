@@ -0,0 +1,172 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulersGeometry.h"
+
+#include "Async/ParallelFor.h"
+
+float TrickyRulersGeometry::GetWorldSizePerPixel(const float Distance)
+{
+	constexpr float ReferenceViewportHeight = 1080.f;
+	constexpr float ReferenceHalfFOVTan = 1.f;
+	return FMath::Max(Distance, 1.f) * 2.f * ReferenceHalfFOVTan / ReferenceViewportHeight;
+}
+
+void TrickyRulersGeometry::SimplifyPolyline(TConstArrayView<FVector> Points,
+                                            const double Tolerance,
+                                            TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+
+	const int32 PointsNum = Points.Num();
+
+	if (PointsNum <= 2 || Tolerance <= 0.0)
+	{
+		OutPoints.Append(Points.GetData(), PointsNum);
+		return;
+	}
+
+	TBitArray<> KeptPoints(false, PointsNum);
+	KeptPoints[0] = true;
+	KeptPoints[PointsNum - 1] = true;
+
+	// Iterative version to avoid deep recursion on long splines.
+	TArray<TPair<int32, int32>, TInlineAllocator<64>> Ranges;
+	Ranges.Emplace(0, PointsNum - 1);
+	const double ToleranceSquared = FMath::Square(Tolerance);
+
+	while (Ranges.Num() > 0)
+	{
+		const TPair<int32, int32> Range = Ranges.Pop(EAllowShrinking::No);
+		const FVector& SegmentStart = Points[Range.Key];
+		const FVector& SegmentEnd = Points[Range.Value];
+
+		double MaxDistanceSquared = 0.0;
+		int32 MaxIndex = INDEX_NONE;
+
+		for (int32 i = Range.Key + 1; i < Range.Value; ++i)
+		{
+			const FVector ClosestPoint = FMath::ClosestPointOnSegment(Points[i], SegmentStart, SegmentEnd);
+			const double DistanceSquared = FVector::DistSquared(Points[i], ClosestPoint);
+
+			if (DistanceSquared > MaxDistanceSquared)
+			{
+				MaxDistanceSquared = DistanceSquared;
+				MaxIndex = i;
+			}
+		}
+
+		if (MaxIndex == INDEX_NONE || MaxDistanceSquared <= ToleranceSquared)
+		{
+			continue;
+		}
+
+		KeptPoints[MaxIndex] = true;
+		Ranges.Emplace(Range.Key, MaxIndex);
+		Ranges.Emplace(MaxIndex, Range.Value);
+	}
+
+	for (TConstSetBitIterator<> It(KeptPoints); It; ++It)
+	{
+		OutPoints.Add(Points[It.GetIndex()]);
+	}
+}
+
+double TrickyRulersGeometry::CalculateShoelaceSum(TConstArrayView<double> X, TConstArrayView<double> Y)
+{
+	check(X.Num() == Y.Num());
+
+	const int32 PairsNum = X.Num() - 1;
+	const double* XData = X.GetData();
+	const double* YData = Y.GetData();
+	VectorRegister4Double Sum = VectorZeroDouble();
+	int32 i = 0;
+
+	for (; i + 4 <= PairsNum; i += 4)
+	{
+		const VectorRegister4Double X0 = VectorLoad(XData + i);
+		const VectorRegister4Double Y0 = VectorLoad(YData + i);
+		const VectorRegister4Double X1 = VectorLoad(XData + i + 1);
+		const VectorRegister4Double Y1 = VectorLoad(YData + i + 1);
+		Sum = VectorAdd(Sum, VectorSubtract(VectorMultiply(X0, Y1), VectorMultiply(X1, Y0)));
+	}
+
+	double Lanes[4];
+	VectorStore(Sum, Lanes);
+	double Result = Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+
+	for (; i < PairsNum; ++i)
+	{
+		Result += XData[i] * YData[i + 1] - XData[i + 1] * YData[i];
+	}
+
+	return Result;
+}
+
+void TrickyRulersGeometry::CalculatePrefixLengths(TConstArrayView<FVector> Points, TArray<double>& OutPrefixLengths)
+{
+	const int32 PointsNum = Points.Num();
+	OutPrefixLengths.SetNumUninitialized(PointsNum);
+
+	if (PointsNum == 0)
+	{
+		return;
+	}
+
+	OutPrefixLengths[0] = 0.0;
+
+	constexpr int32 ChunkSize = 4096;
+	const int32 ChunksNum = FMath::DivideAndRoundUp(PointsNum - 1, ChunkSize);
+	const FVector* PointsData = Points.GetData();
+	double* Lengths = OutPrefixLengths.GetData();
+	TArray<double> ChunkOffsets;
+	ChunkOffsets.SetNumZeroed(ChunksNum + 1);
+	const EParallelForFlags Flags = ChunksNum > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+	ParallelFor(ChunksNum, [PointsData, Lengths, PointsNum, &ChunkOffsets](const int32 Chunk)
+	{
+		const int32 First = 1 + Chunk * ChunkSize;
+		const int32 Last = FMath::Min(First + ChunkSize, PointsNum);
+
+		for (int32 i = First; i < Last; ++i)
+		{
+			const double X = PointsData[i].X - PointsData[i - 1].X;
+			const double Y = PointsData[i].Y - PointsData[i - 1].Y;
+			const double Z = PointsData[i].Z - PointsData[i - 1].Z;
+			Lengths[i] = FMath::Sqrt(X * X + Y * Y + Z * Z);
+		}
+
+		double Sum = 0.0;
+
+		for (int32 i = First; i < Last; ++i)
+		{
+			Sum += Lengths[i];
+			Lengths[i] = Sum;
+		}
+
+		ChunkOffsets[Chunk + 1] = Sum;
+	}, Flags);
+
+	for (int32 Chunk = 1; Chunk <= ChunksNum; ++Chunk)
+	{
+		ChunkOffsets[Chunk] += ChunkOffsets[Chunk - 1];
+	}
+
+	ParallelFor(ChunksNum, [Lengths, PointsNum, &ChunkOffsets](const int32 Chunk)
+	{
+		const double Offset = ChunkOffsets[Chunk];
+
+		if (Offset == 0.0)
+		{
+			return;
+		}
+
+		const int32 First = 1 + Chunk * ChunkSize;
+		const int32 Last = FMath::Min(First + ChunkSize, PointsNum);
+
+		for (int32 i = First; i < Last; ++i)
+		{
+			Lengths[i] += Offset;
+		}
+	}, Flags);
+}
@@ -0,0 +1,33 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace TrickyRulersGeometry
+{
+	/**
+	 * Approximate size in cm of one screen pixel at the given distance from the camera.
+	 * Assumes 90 degrees FOV and 1080p viewport, which is good enough for display LOD decisions.
+	 */
+	float GetWorldSizePerPixel(const float Distance);
+
+	/**
+	 * Simplifies the polyline using Douglas-Peucker algorithm.
+	 * First and last points are always kept.
+	 */
+	void SimplifyPolyline(TConstArrayView<FVector> Points, const double Tolerance, TArray<FVector>& OutPoints);
+
+	/**
+	 * Calculates the shoelace sum (doubled signed area) of the 2D polyline stored as separate X and Y arrays.
+	 * For open polylines the result can be summed with the adjacent ones to get the area of the whole loop.
+	 */
+	double CalculateShoelaceSum(TConstArrayView<double> X, TConstArrayView<double> Y);
+
+	/**
+	 * Calculates the length of the polyline up to each of its points.
+	 * Segment lengths are calculated in parallel chunks by a branchless loop the compiler can vectorise,
+	 * then the chunk sums are offset, so only the sums of the chunks are accumulated sequentially.
+	 */
+	void CalculatePrefixLengths(TConstArrayView<FVector> Points, TArray<double>& OutPrefixLengths);
+}
@@ -0,0 +1,159 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulersMemory.h"
+
+#include "EngineUtils.h"
+#include "TrickyDebugTextComponent.h"
+#include "TrickyUnitWireframeCache.h"
+#include "Engine/World.h"
+#include "Serialization/ArchiveCountMem.h"
+#include <atomic>
+
+LLM_DEFINE_TAG(TrickyRulers);
+
+namespace TrickyRulersMemory
+{
+	std::atomic<int32> LiveProxiesNum[static_cast<int32>(ETrickyProxyKind::Num)];
+
+	const TCHAR* ProxyKindNames[] = {
+		TEXT("DebugText"),
+		TEXT("DebugShapes"),
+		TEXT("RulerShape"),
+		TEXT("Grid"),
+		TEXT("Heatmap"),
+		TEXT("DistanceGraph")
+	};
+
+	static_assert(UE_ARRAY_COUNT(ProxyKindNames) == static_cast<int32>(ETrickyProxyKind::Num));
+
+	struct FClassStats
+	{
+		int32 ActorsNum = 0;
+		SIZE_T Bytes = 0;
+	};
+
+	/**
+	 * Blueprints are counted together with their native ruler class.
+	 */
+	const UClass* GetRulerClass(const AActor* Actor)
+	{
+		const UClass* Class = Actor->GetClass();
+
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+		{
+			Class = Class->GetSuperClass();
+		}
+
+		static const FName PackageName = TEXT("/Script/TrickyRulers");
+		return Class && Class->GetOutermost()->GetFName() == PackageName ? Class : nullptr;
+	}
+
+	SIZE_T CountBytes(UObject* Object)
+	{
+		const FArchiveCountMem CountMem(Object);
+		return CountMem.GetMax();
+	}
+
+	FString FormatBytes(const SIZE_T Bytes)
+	{
+		return FString::Printf(TEXT("%.1f KB"), Bytes / 1024.0);
+	}
+}
+
+
+FTrickyProxyCounter::FTrickyProxyCounter(const ETrickyProxyKind InKind)
+	: Kind(InKind)
+{
+	++TrickyRulersMemory::LiveProxiesNum[static_cast<int32>(Kind)];
+}
+
+FTrickyProxyCounter::~FTrickyProxyCounter()
+{
+	--TrickyRulersMemory::LiveProxiesNum[static_cast<int32>(Kind)];
+}
+
+int32 FTrickyProxyCounter::GetLiveNum(const ETrickyProxyKind Kind)
+{
+	return TrickyRulersMemory::LiveProxiesNum[static_cast<int32>(Kind)];
+}
+
+void TrickyRulersMemory::Report(const UWorld* World, FOutputDevice& Output)
+{
+	if (!World)
+	{
+		Output.Log(TEXT("TrickyRulers: no world to report."));
+		return;
+	}
+
+	TMap<const UClass*, FClassStats> ClassStats;
+	int32 TextComponentsNum = 0;
+	int32 LabelsNum = 0;
+	SIZE_T LabelsBytes = 0;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+		const UClass* RulerClass = GetRulerClass(Actor);
+
+		if (!RulerClass)
+		{
+			continue;
+		}
+
+		FClassStats& Stats = ClassStats.FindOrAdd(RulerClass);
+		++Stats.ActorsNum;
+		Stats.Bytes += CountBytes(Actor);
+
+		TInlineComponentArray<UActorComponent*> Components(Actor);
+
+		for (UActorComponent* Component : Components)
+		{
+			Stats.Bytes += CountBytes(Component);
+
+			if (const UTrickyDebugTextComponent* TextComponent = Cast<UTrickyDebugTextComponent>(Component))
+			{
+				++TextComponentsNum;
+				LabelsNum += TextComponent->GetLabelsNum();
+				LabelsBytes += TextComponent->GetLabelsAllocatedSize();
+			}
+		}
+	}
+
+	ClassStats.ValueSort([](const FClassStats& A, const FClassStats& B)
+	{
+		return A.Bytes > B.Bytes;
+	});
+
+	Output.Logf(TEXT("TrickyRulers memory in %s:"), *World->GetName());
+
+	for (const TPair<const UClass*, FClassStats>& Pair : ClassStats)
+	{
+		Output.Logf(TEXT("  %s: %d actors, %s with components"),
+		            *Pair.Key->GetName(),
+		            Pair.Value.ActorsNum,
+		            *FormatBytes(Pair.Value.Bytes));
+	}
+
+	Output.Logf(TEXT("  Labels: %d in %d text components, %s"),
+	            LabelsNum,
+	            TextComponentsNum,
+	            *FormatBytes(LabelsBytes));
+
+	const FTrickyUnitWireframeCache& WireframeCache = FTrickyUnitWireframeCache::Get();
+	Output.Logf(TEXT("  Unit wireframes: %d shared, %s"),
+	            WireframeCache.GetWireframesNum(),
+	            *FormatBytes(WireframeCache.GetAllocatedSize()));
+
+	// Proxies of all worlds, more proxies than components means the old ones aren't released.
+	FString Proxies;
+
+	for (int32 i = 0; i < static_cast<int32>(ETrickyProxyKind::Num); ++i)
+	{
+		Proxies += FString::Printf(TEXT(" %s=%d"),
+		                           ProxyKindNames[i],
+		                           FTrickyProxyCounter::GetLiveNum(static_cast<ETrickyProxyKind>(i)));
+	}
+
+	Output.Logf(TEXT("  Live proxies:%s"), *Proxies);
+}
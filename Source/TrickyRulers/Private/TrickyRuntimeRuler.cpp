@@ -0,0 +1,24 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRuntimeRuler.h"
+
+#include "Misc/CommandLine.h"
+
+bool ITrickyRuntimeRuler::IsEditorOnlyRuler(const bool bShowInGame)
+{
+	if (!bShowInGame)
+	{
+		return true;
+	}
+
+#if WITH_EDITOR
+	if (IsRunningCookCommandlet())
+	{
+		static const bool bCookRuntimeRulers = FParse::Param(FCommandLine::Get(), TEXT("TrickyRulersRuntime"));
+		return !bCookRuntimeRulers;
+	}
+#endif
+
+	return false;
+}
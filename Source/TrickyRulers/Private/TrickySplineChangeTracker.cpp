@@ -0,0 +1,66 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickySplineChangeTracker.h"
+
+#include "Components/SplineComponent.h"
+
+bool FTrickySplineChangeTracker::Update(const USplineComponent* SplineComponent, TBitArray<>& OutDirtySections)
+{
+	const int32 PointsNum = SplineComponent->GetNumberOfSplinePoints();
+	const bool bWasClosedLoop = bIsClosedLoop;
+	const bool bIsFullUpdate = PointsNum != PointStates.Num() || bWasClosedLoop != SplineComponent->IsClosedLoop();
+
+	PointStates.SetNum(PointsNum);
+	bIsClosedLoop = SplineComponent->IsClosedLoop();
+	OutDirtySections.Init(bIsFullUpdate, GetSectionsNum());
+
+	for (int32 i = 0; i < PointsNum; ++i)
+	{
+		FTrickySplinePointState State;
+		State.Location = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Local);
+		State.ArriveTangent = SplineComponent->GetArriveTangentAtSplinePoint(i, ESplineCoordinateSpace::Local);
+		State.LeaveTangent = SplineComponent->GetLeaveTangentAtSplinePoint(i, ESplineCoordinateSpace::Local);
+		State.Type = static_cast<uint8>(SplineComponent->GetSplinePointType(i));
+
+		if (PointStates[i] == State)
+		{
+			continue;
+		}
+
+		PointStates[i] = State;
+
+		if (bIsFullUpdate)
+		{
+			continue;
+		}
+
+		const int32 SectionsNum = OutDirtySections.Num();
+
+		if (i < SectionsNum)
+		{
+			OutDirtySections[i] = true;
+		}
+
+		const int32 PreviousSection = bIsClosedLoop ? (i + SectionsNum - 1) % SectionsNum : i - 1;
+
+		if (SectionsNum > 0 && PreviousSection >= 0)
+		{
+			OutDirtySections[PreviousSection] = true;
+		}
+	}
+
+	return bIsFullUpdate;
+}
+
+void FTrickySplineChangeTracker::Reset()
+{
+	PointStates.Empty();
+	bIsClosedLoop = false;
+}
+
+int32 FTrickySplineChangeTracker::GetSectionsNum() const
+{
+	const int32 PointsNum = PointStates.Num();
+	return FMath::Max(bIsClosedLoop ? PointsNum : PointsNum - 1, 0);
+}
@@ -0,0 +1,176 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickySplineClearance.h"
+
+#include "Components/SplineComponent.h"
+#include "Engine/World.h"
+
+void FTrickySplineClearance::Update(UWorld* World,
+                                    const USplineComponent* SplineComponent,
+                                    const FTrickyClearanceSettings& Settings,
+                                    const bool bForceFullUpdate)
+{
+	if (!World || !SplineComponent)
+	{
+		return;
+	}
+
+	TBitArray<> DirtySections;
+	bool bIsFullUpdate = ChangeTracker.Update(SplineComponent, DirtySections);
+
+	// The tracker works in local space, while the sweeps depend on the world transform.
+	const FTransform& Transform = SplineComponent->GetComponentTransform();
+
+	if (bForceFullUpdate || Settings != CachedSettings || !Transform.Equals(CachedTransform))
+	{
+		bIsFullUpdate = true;
+		DirtySections.Init(true, DirtySections.Num());
+	}
+
+	CachedSettings = Settings;
+	CachedTransform = Transform;
+
+	if (bIsFullUpdate)
+	{
+		Sections.Reset();
+		Sections.SetNum(DirtySections.Num());
+		PendingSweepsNum = 0;
+		bHaveResultsChanged = true;
+	}
+
+	for (TConstSetBitIterator<> It(DirtySections); It; ++It)
+	{
+		SweepSection(World, SplineComponent, It.GetIndex());
+	}
+}
+
+void FTrickySplineClearance::Reset()
+{
+	ChangeTracker.Reset();
+	Sections.Empty();
+	CachedSettings = FTrickyClearanceSettings();
+	CachedTransform = FTransform::Identity;
+	PendingSweepsNum = 0;
+	bHaveResultsChanged = true;
+}
+
+bool FTrickySplineClearance::ConsumeResultsChanged()
+{
+	const bool bResult = bHaveResultsChanged;
+	bHaveResultsChanged = false;
+	return bResult;
+}
+
+double FTrickySplineClearance::GetBlockedLength() const
+{
+	double Length = 0.0;
+
+	for (const FTrickyClearanceSection& Section : Sections)
+	{
+		for (TConstSetBitIterator<> It(Section.BlockedSegments); It; ++It)
+		{
+			const int32 Segment = It.GetIndex();
+			Length += FVector::Dist(Section.Samples[Segment], Section.Samples[Segment + 1]);
+		}
+	}
+
+	return Length;
+}
+
+void FTrickySplineClearance::SweepSection(UWorld* World,
+                                          const USplineComponent* SplineComponent,
+                                          const int32 SectionIndex)
+{
+	FTrickyClearanceSection& Section = Sections[SectionIndex];
+
+	for (const uint64 SweepHandle : Section.SweepHandles)
+	{
+		PendingSweepsNum -= SweepHandle != 0;
+	}
+
+	const double StartDistance = SplineComponent->GetDistanceAlongSplineAtSplinePoint(SectionIndex);
+	const double EndDistance = SplineComponent->GetDistanceAlongSplineAtSplinePoint(SectionIndex + 1);
+	const double SampleStep = FMath::Max(CachedSettings.SampleStep, 1.f);
+	const int32 SegmentsNum = FMath::Clamp(FMath::CeilToInt32((EndDistance - StartDistance) / SampleStep),
+	                                       1,
+	                                       MaxSegmentsPerSection);
+
+	Section.Samples.SetNumUninitialized(SegmentsNum + 1);
+	Section.SweepHandles.Init(0, SegmentsNum);
+	Section.BlockedSegments.Init(false, SegmentsNum);
+
+	for (int32 i = 0; i <= SegmentsNum; ++i)
+	{
+		const double Distance = FMath::Lerp(StartDistance, EndDistance, static_cast<double>(i) / SegmentsNum);
+		Section.Samples[i] = SplineComponent->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+	}
+
+	const float HalfHeight = FMath::Max(CachedSettings.HalfHeight, CachedSettings.Radius);
+	const FCollisionShape Shape = FCollisionShape::MakeCapsule(CachedSettings.Radius, HalfHeight);
+	const FVector Offset = FVector::UpVector * ((CachedSettings.bCenterOrigin ? 0.f : HalfHeight)
+		+ CachedSettings.StepHeight);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrickySplineClearance),
+	                                        false,
+	                                        SplineComponent->GetOwner());
+
+	FTraceDelegate TraceDelegate;
+	TraceDelegate.BindSP(AsShared(), &FTrickySplineClearance::HandleSweepDone);
+
+	// All sweeps are requested in the same frame, so the async trace system processes them as one batch.
+	for (int32 i = 0; i < SegmentsNum; ++i)
+	{
+		const FTraceHandle Handle = World->AsyncSweepByChannel(EAsyncTraceType::Single,
+		                                                       Section.Samples[i] + Offset,
+		                                                       Section.Samples[i + 1] + Offset,
+		                                                       FQuat::Identity,
+		                                                       CachedSettings.Channel,
+		                                                       Shape,
+		                                                       QueryParams,
+		                                                       FCollisionResponseParams::DefaultResponseParam,
+		                                                       &TraceDelegate,
+		                                                       static_cast<uint32>(SectionIndex));
+		Section.SweepHandles[i] = Handle._Handle;
+		PendingSweepsNum += Handle._Handle != 0;
+	}
+
+	bHaveResultsChanged = true;
+}
+
+void FTrickySplineClearance::HandleSweepDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const int32 SectionIndex = static_cast<int32>(TraceDatum.UserData);
+
+	if (!Sections.IsValidIndex(SectionIndex))
+	{
+		return;
+	}
+
+	FTrickyClearanceSection& Section = Sections[SectionIndex];
+	const int32 Segment = Section.SweepHandles.Find(TraceHandle._Handle);
+
+	// The section has been swept again since the request, the result is outdated.
+	if (Segment == INDEX_NONE || TraceHandle._Handle == 0)
+	{
+		return;
+	}
+
+	Section.SweepHandles[Segment] = 0;
+	--PendingSweepsNum;
+
+	const bool bIsBlocked = TraceDatum.OutHits.ContainsByPredicate([](const FHitResult& Hit)
+	{
+		return Hit.bBlockingHit;
+	});
+
+	if (Section.BlockedSegments[Segment] != bIsBlocked)
+	{
+		Section.BlockedSegments[Segment] = bIsBlocked;
+		bHaveResultsChanged = true;
+	}
+
+	if (PendingSweepsNum == 0)
+	{
+		bHaveResultsChanged = true;
+	}
+}
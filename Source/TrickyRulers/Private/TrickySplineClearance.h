@@ -0,0 +1,97 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "TrickySplineChangeTracker.h"
+
+class USplineComponent;
+
+struct FTrickyClearanceSettings
+{
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+	float StepHeight = 0.f;
+	float SampleStep = 0.f;
+	bool bCenterOrigin = false;
+	TEnumAsByte<ECollisionChannel> Channel = ECC_Pawn;
+
+	bool operator==(const FTrickyClearanceSettings& Other) const
+	{
+		return Radius == Other.Radius
+			&& HalfHeight == Other.HalfHeight
+			&& StepHeight == Other.StepHeight
+			&& SampleStep == Other.SampleStep
+			&& bCenterOrigin == Other.bCenterOrigin
+			&& Channel == Other.Channel;
+	}
+
+	bool operator!=(const FTrickyClearanceSettings& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+struct FTrickyClearanceSection
+{
+	/**
+	 * Locations on the spline in world space, each pair of neighbours is swept separately.
+	 */
+	TArray<FVector> Samples;
+
+	/**
+	 * Handles of the sweeps in flight, indexed by segment. Zero means the result has arrived.
+	 */
+	TArray<uint64> SweepHandles;
+
+	TBitArray<> BlockedSegments;
+};
+
+/**
+ * Sweeps an upright capsule along a spline with async queries.
+ * Only the sections next to changed spline points are swept again.
+ */
+class FTrickySplineClearance : public TSharedFromThis<FTrickySplineClearance>
+{
+public:
+	void Update(UWorld* World,
+	            const USplineComponent* SplineComponent,
+	            const FTrickyClearanceSettings& Settings,
+	            const bool bForceFullUpdate = false);
+
+	void Reset();
+
+	/**
+	 * Returns true once after some sweep results have changed.
+	 */
+	bool ConsumeResultsChanged();
+
+	bool IsSweeping() const { return PendingSweepsNum > 0; }
+
+	const TArray<FTrickyClearanceSection>& GetSections() const { return Sections; }
+
+	/**
+	 * Length of the blocked segments in cm.
+	 */
+	double GetBlockedLength() const;
+
+private:
+	constexpr static int32 MaxSegmentsPerSection = 64;
+
+	FTrickySplineChangeTracker ChangeTracker;
+
+	TArray<FTrickyClearanceSection> Sections;
+
+	FTrickyClearanceSettings CachedSettings;
+
+	FTransform CachedTransform = FTransform::Identity;
+
+	int32 PendingSweepsNum = 0;
+
+	bool bHaveResultsChanged = false;
+
+	void SweepSection(UWorld* World, const USplineComponent* SplineComponent, const int32 SectionIndex);
+
+	void HandleSweepDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+};
@@ -3,16 +3,29 @@
 
 #include "TrickySplineRuler.h"
 
+#include "TrickyDebugShapesComponent.h"
 #include "TrickyDebugTextComponent.h"
+#include "TrickyElevationProfile.h"
+#include "TrickyRulerActorDesc.h"
+#include "TrickyRulerSubsystem.h"
+#include "TrickyRulersGeometry.h"
+#include "TrickyRulersMemory.h"
+#include "TrickySplineClearance.h"
 #include "TrickySplineComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/Crc.h"
 
 
 ATrickySplineRuler::ATrickySplineRuler()
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	PrimaryActorTick.bCanEverTick = true;
 	bIsEditorOnlyActor = true;
 
-	SplineComponent = CreateEditorOnlyDefaultSubobject<UTrickySplineComponent>(TEXT("SplineComponent"));
+	// The spline is the data of the runtime rulers, so it's editor only depending on bShowInGame.
+	SplineComponent = CreateDefaultSubobject<UTrickySplineComponent>(TEXT("SplineComponent"));
 	SetRootComponent(SplineComponent);
 	SplineComponent->SetUnselectedSplineSegmentColor(FColor::Purple);
 	SplineComponent->SetSelectedSplineSegmentColor(FColor::Magenta);
@@ -20,6 +33,55 @@ ATrickySplineRuler::ATrickySplineRuler()
 
 	DebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugTextComponent"));
 	DebugTextComponent->SetupAttachment(GetRootComponent());
+
+	ClearanceShapesComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugShapesComponent>(
+		TEXT("ClearanceShapesComponent"));
+	ClearanceShapesComponent->SetupAttachment(GetRootComponent());
+
+	ElevationShapesComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugShapesComponent>(
+		TEXT("ElevationShapesComponent"));
+	ElevationShapesComponent->SetupAttachment(GetRootComponent());
+}
+
+void ATrickySplineRuler::GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const
+{
+	if (!SplineComponent)
+	{
+		return;
+	}
+
+	const float Length = MeasurementCache.SplineHash != 0 ? MeasurementCache.Length : SplineComponent->GetSplineLength();
+	OutMeasurements.Add({TEXT("Length"), Length / 100.0});
+	OutMeasurements.Add({TEXT("Points"), static_cast<double>(SplineComponent->GetNumberOfSplinePoints())});
+
+	if (SplineComponent->IsClosedLoop())
+	{
+		OutMeasurements.Add({TEXT("Perimeter"), Perimeter});
+		OutMeasurements.Add({TEXT("Area"), EnclosedArea});
+
+		if (LoopHeight > 0)
+		{
+			OutMeasurements.Add({TEXT("Volume"), Volume});
+		}
+	}
+
+	if (bCheckClearance)
+	{
+		OutMeasurements.Add({TEXT("Blocked"), BlockedLength});
+	}
+
+	if (Elevation.IsValid())
+	{
+		Elevation->GetMeasurements(OutMeasurements);
+	}
+}
+
+void ATrickySplineRuler::GetConstraintViolations(TArray<FString>& OutViolations) const
+{
+	FTrickyMeasurementConstraint::CheckAll(Constraints, [this](TArray<FTrickyMeasurement>& OutMeasurements)
+	{
+		GetMeasurements(OutMeasurements);
+	}, OutViolations);
 }
 
 bool ATrickySplineRuler::ShouldTickIfViewportsOnly() const
@@ -29,40 +91,222 @@ bool ATrickySplineRuler::ShouldTickIfViewportsOnly() const
 
 void ATrickySplineRuler::OnConstruction(const FTransform& Transform)
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	Super::OnConstruction(Transform);
+	SplineComponent->bIsEditorOnly = !bShowInGame;
+	UpdateGroupState();
 	SetSplineProperties();
+	UpdateMeasurementCache();
+	UpdateDisplayData();
+	UpdateLoopMeasurements();
+	UpdateClearance(false);
+	UpdateElevation(false);
 	UpdateDebugText();
 }
 
+void ATrickySplineRuler::PostLoad()
+{
+	Super::PostLoad();
+
+	// The spline could be changed without the construction, e.g. by a script, so the stale values aren't reported.
+	if (SplineComponent && !MeasurementCache.IsValidFor(CalculateSplineHash()))
+	{
+		MeasurementCache.Reset();
+	}
+
+	bIsDebugTextStale = true;
+}
+
 inline void ATrickySplineRuler::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	for (int32 i = 0; i < GetLastSplinePoint(); ++i)
+	if (Clearance.IsValid() && Clearance->ConsumeResultsChanged())
 	{
-		const float InputKey = static_cast<float>(i) + 0.5;
-		const FVector UpVector = SplineComponent->GetUpVectorAtSplineInputKey(InputKey, ESplineCoordinateSpace::World);
-		const FVector SectionDirection = SplineComponent->GetDirectionAtSplineInputKey(
-			InputKey, ESplineCoordinateSpace::World).RotateAngleAxis(180.f, UpVector);
-		const FVector SectionLocation = SplineComponent->GetLocationAtSplineInputKey(
-			InputKey, ESplineCoordinateSpace::World);
-		constexpr float Angle = FMath::DegreesToRadians(ArrowAngleDeg);
-		const FColor Color = SplineComponent->EditorUnselectedSplineSegmentColor.ToFColor(true);
-		DrawDebugCone(GetWorld(),
-		              SectionLocation - SectionDirection * (ArrowLength * 0.5f),
-		              SectionDirection,
-		              ArrowLength,
-		              Angle,
-		              Angle,
-		              32,
-		              Color,
-		              false,
-		              0.f,
-		              0,
-		              2.f);
+		UpdateClearanceShapes();
+		UpdateDebugText();
+	}
+
+	if (Elevation.IsValid() && Elevation->ConsumeResultsChanged())
+	{
+		UpdateElevationShapes();
+		UpdateDebugText();
+	}
+
+	if (GroupState.IsValid() && GroupState->IsHidden())
+	{
+		return;
+	}
+
+	const FColor Color = GetSplineColor();
+	const bool bIsLODActive = IsDisplayLODActive();
+
+	if (bIsLODActive)
+	{
+		const TArray<FVector>& Polyline = GetSimplifiedPolyline(GetViewDistance(SplineComponent->Bounds.GetBox()));
+
+		for (int32 i = 1; i < Polyline.Num(); ++i)
+		{
+			DrawDebugLine(GetWorld(), Polyline[i - 1], Polyline[i], Color, false, 0.f, 0, 2.f);
+		}
+	}
+
+	for (const FTrickySplineSectionsChunk& Chunk : SectionsChunks)
+	{
+		if (bIsLODActive && IsSmallOnScreen(Chunk.MaxSectionLength, GetViewDistance(Chunk.Bounds)))
+		{
+			continue;
+		}
+
+		for (int32 i = Chunk.FirstSection; i <= Chunk.LastSection; ++i)
+		{
+			const FTrickySplineSectionDisplayData& Section = SectionsDisplayData[i];
+
+			if (bIsLODActive && IsSmallOnScreen(Section.Length, GetViewDistance(FBox(Section.Location, Section.Location))))
+			{
+				continue;
+			}
+
+			DrawSectionArrow(Section, Color);
+		}
 	}
 }
 
+void ATrickySplineRuler::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!bShowInGame)
+	{
+		return;
+	}
+
+	bIsRuntimeRuler = true;
+	SetActorTickEnabled(false);
+	UpdateGroupState();
+	UTrickyRulerSubsystem::RegisterRuntimeRuler(this, this);
+}
+
+void ATrickySplineRuler::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bIsRuntimeRuler)
+	{
+		bIsRuntimeRuler = false;
+		UTrickyRulerSubsystem::UnregisterRuntimeRuler(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ATrickySplineRuler::IsEditorOnly() const
+{
+	return IsEditorOnlyRuler(bShowInGame);
+}
+
+void ATrickySplineRuler::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	// The construction doesn't run for the loaded actors of cooked levels, so the labels are rebuilt here.
+	if (bIsDebugTextStale && SplineComponent)
+	{
+		bIsDebugTextStale = false;
+		UpdateDisplayData();
+		UpdateDebugText();
+	}
+
+#if WITH_EDITOR
+	if (GEngine && !HasAnyFlags(RF_ClassDefaultObject) && !ActorMovedHandle.IsValid())
+	{
+		ActorMovedHandle = GEngine->OnActorMoved().AddUObject(this, &ATrickySplineRuler::HandleActorMoved);
+	}
+#endif
+}
+
+void ATrickySplineRuler::PostUnregisterAllComponents()
+{
+#if WITH_EDITOR
+	if (GEngine)
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+	}
+#endif
+
+	ActorMovedHandle.Reset();
+
+	Super::PostUnregisterAllComponents();
+}
+
+void ATrickySplineRuler::GetRuntimeLines(TArray<FBatchedLine>& OutLines) const
+{
+	TArray<FVector> Polyline;
+	BuildPolyline(Polyline);
+	const FLinearColor Color = GetSplineColor();
+
+	for (int32 i = 1; i < Polyline.Num(); ++i)
+	{
+		OutLines.Emplace(Polyline[i - 1], Polyline[i], Color, 0.f, 2.f, SDPG_World);
+	}
+}
+
+void ATrickySplineRuler::GetRuntimeLabels(TArray<FTrickyRuntimeLabel>& OutLabels) const
+{
+	for (const FTrickyDebugTextData& Label : DebugTextData)
+	{
+		OutLabels.Add({Label.bUseCustomLocation ? Label.Location : GetActorLocation(),
+		               Label.Text,
+		               Label.Color.ToFColor(true)});
+	}
+
+	for (const FTrickyNumericLabel& Label : NumericLabels)
+	{
+		OutLabels.Add({Label.Location, Label.ToString(), Label.Color});
+	}
+}
+
+FTrickyRulerGroupStatePtr ATrickySplineRuler::GetRuntimeGroupState() const
+{
+	return GroupState;
+}
+
+#if WITH_EDITOR
+EDataValidationResult ATrickySplineRuler::IsDataValid(FDataValidationContext& Context) const
+{
+	const EDataValidationResult Result = Super::IsDataValid(Context);
+	TArray<FString> Violations;
+	GetConstraintViolations(Violations);
+	return FTrickyMeasurementConstraint::Validate(Violations, GetActorNameOrLabel(), Context, Result);
+}
+
+bool ATrickySplineRuler::CanEditChange(const FProperty* InProperty) const
+{
+	return Super::CanEditChange(InProperty) && FTrickyRulerGroups::CanEdit(GroupState);
+}
+
+TUniquePtr<FWorldPartitionActorDesc> ATrickySplineRuler::CreateClassActorDesc() const
+{
+	return MakeUnique<FTrickyRulerActorDesc>();
+}
+
+void ATrickySplineRuler::GetDescriptorShape(TArray<FVector>& OutPoints) const
+{
+	constexpr int32 StepsPerSegment = 8;
+	const int32 PointsNum = SplineComponent->GetNumberOfSplinePoints();
+	const int32 SegmentsNum = SplineComponent->IsClosedLoop() ? PointsNum : PointsNum - 1;
+	TArray<FVector> Samples;
+	Samples.Reserve(SegmentsNum * StepsPerSegment + 1);
+
+	for (int32 i = 0; i <= SegmentsNum * StepsPerSegment; ++i)
+	{
+		const float InputKey = static_cast<float>(i) / StepsPerSegment;
+		Samples.Add(SplineComponent->GetLocationAtSplineInputKey(InputKey, ESplineCoordinateSpace::World));
+	}
+
+	FTrickyRulerActorDesc::SimplifyShape(Samples, OutPoints);
+}
+#endif
+
 void ATrickySplineRuler::SetTypeToLinear() const
 {
 	SetSplinePointsType(ESplinePointType::Linear);
@@ -73,6 +317,16 @@ void ATrickySplineRuler::SetTypeToCurve() const
 	SetSplinePointsType(ESplinePointType::Curve);
 }
 
+void ATrickySplineRuler::RefreshClearance()
+{
+	UpdateClearance(true);
+}
+
+void ATrickySplineRuler::RefreshElevation()
+{
+	UpdateElevation(true);
+}
+
 void ATrickySplineRuler::SetSplinePointsType(const ESplinePointType::Type NewType) const
 {
 	const int32 PointsNum = SplineComponent->GetNumberOfSplinePoints();
@@ -95,32 +349,75 @@ void ATrickySplineRuler::SetSplineProperties()
 
 void ATrickySplineRuler::UpdateDebugText()
 {
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
 	DebugTextData.Empty();
+	NumericLabels.Reset();
 	UpdatePointsDebugText();
 	UpdateSectionsDebugText();
-	DebugTextComponent->SetDebugLabels(DebugTextData);
+
+	if (DebugTextComponent)
+	{
+		DebugTextComponent->SetMinScreenSize(IsDisplayLODActive() ? MinSectionScreenSize : 0.f);
+		DebugTextComponent->SetDebugLabels(DebugTextData);
+		DebugTextComponent->SetNumericLabels(NumericLabels);
+	}
 }
 
 void ATrickySplineRuler::UpdatePointsDebugText()
 {
-	float Distance = GetDistanceAtSplinePoint(GetLastSplinePoint());
+	const float Distance = GetDistanceAtSplinePoint(GetLastSplinePoint());
 	FTrickyDebugTextData PointDebugText;
 	PointDebugText.Color = DebugTextColor;
+	FString Measurements = FString::Printf(TEXT("Length: %.2f m"), Distance / 100.f);
+
+	if (SplineComponent->IsClosedLoop())
+	{
+		Measurements = FString::Printf(TEXT("Perimeter: %.2f m\nArea: %.2f m²"), Perimeter, EnclosedArea);
+
+		if (LoopHeight > 0)
+		{
+			Measurements += FString::Printf(TEXT("\nVolume: %.2f m³"), Volume);
+		}
+	}
+
+	if (Clearance.IsValid())
+	{
+		Measurements += Clearance->IsSweeping()
+			                ? FString(TEXT("\nClearance: sweeping..."))
+			                : FString::Printf(TEXT("\nBlocked: %.2f m"), BlockedLength);
+	}
+
+	if (Elevation.IsValid())
+	{
+		Measurements += TEXT("\n") + Elevation->GetStatsText();
+	}
+
+	TArray<FString> Violations;
+	GetConstraintViolations(Violations);
+
+	for (const FString& Violation : Violations)
+	{
+		Measurements += FString::Printf(TEXT("\nViolated: %s"), *Violation);
+	}
+
 	PointDebugText.Text = FString::Printf(
-		TEXT("==========\n%s\n==========\nLength: %.2f m\n=========="), *GetActorNameOrLabel(), Distance / 100.f);
+		TEXT("==========\n%s\n==========\n%s\n=========="), *GetActorNameOrLabel(), *Measurements);
 	DebugTextData.Add(PointDebugText);
 
 	if (bShowDistancePerPoint)
 	{
-		PointDebugText.bUseCustomLocation = true;
+		FTrickyNumericLabel PointLabel;
+		PointLabel.Kind = ETrickyNumericLabelKind::SplinePoint;
+		PointLabel.Color = DebugTextColor;
 
 		for (int32 i = 1; i < SplineComponent->GetNumberOfSplinePoints(); ++i)
 		{
-			Distance = GetDistanceAtSplinePoint(i);
-			PointDebugText.Text = FString::Printf(
-				TEXT("----------\nPoint %d\n----------\nLength: %.2f m\n----------"), i, Distance / 100.f);
-			PointDebugText.Location = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World);
-			DebugTextData.Add(PointDebugText);
+			PointLabel.Index = i;
+			PointLabel.Value = GetDistanceAtSplinePoint(i) / 100.f;
+			PointLabel.Location = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World);
+			PointLabel.CullSize = SectionsDisplayData.IsValidIndex(i - 1) ? SectionsDisplayData[i - 1].Length : 0.f;
+			NumericLabels.Add(PointLabel);
 		}
 	}
 }
@@ -132,20 +429,20 @@ void ATrickySplineRuler::UpdateSectionsDebugText()
 		return;
 	}
 
-	FTrickyDebugTextData SectionDebugText;
-	SectionDebugText.Color = DebugTextColor;
-	SectionDebugText.bUseCustomLocation = true;
+	FTrickyNumericLabel SectionLabel;
+	SectionLabel.Kind = ETrickyNumericLabelKind::SplineSection;
+	SectionLabel.Color = DebugTextColor;
+	const FTransform& Transform = SplineComponent->GetComponentTransform();
 
-	for (int32 i = 0; i < GetLastSplinePoint(); ++i)
+	// The cache is empty only until the construction if the spline was changed outside of the ruler.
+	for (int32 i = 0; i < MeasurementCache.SectionLabelLocations.Num(); ++i)
 	{
 		const float Length = GetDistanceAtSplinePoint(i + 1) - GetDistanceAtSplinePoint(i);
-		const float Distance = SplineComponent->GetDistanceAlongSplineAtSplineInputKey(static_cast<float>(i) + 0.5);
-		FVector SectionLocation = SplineComponent->GetLocationAtDistanceAlongSpline(
-			Distance, ESplineCoordinateSpace::World);
-		SectionDebugText.Text = FString::Printf(
-			TEXT("----------\nSection %d\n----------\nLength: %.2f m\n----------"), i + 1, Length / 100.f);
-		SectionDebugText.Location = SectionLocation;
-		DebugTextData.Add(SectionDebugText);
+		SectionLabel.Index = i + 1;
+		SectionLabel.Value = Length / 100.f;
+		SectionLabel.Location = Transform.TransformPosition(MeasurementCache.SectionLabelLocations[i]);
+		SectionLabel.CullSize = Length;
+		NumericLabels.Add(SectionLabel);
 	}
 }
 
@@ -157,5 +454,379 @@ int32 ATrickySplineRuler::GetLastSplinePoint() const
 
 float ATrickySplineRuler::GetDistanceAtSplinePoint(const int32 PointIndex) const
 {
-	return SplineComponent->GetDistanceAlongSplineAtSplinePoint(PointIndex);
+	return MeasurementCache.PointDistances.IsValidIndex(PointIndex)
+		       ? MeasurementCache.PointDistances[PointIndex]
+		       : SplineComponent->GetDistanceAlongSplineAtSplinePoint(PointIndex);
+}
+
+uint32 ATrickySplineRuler::CalculateSplineHash() const
+{
+	const int32 PointsNum = SplineComponent->GetNumberOfSplinePoints();
+	TArray<double> Data;
+	Data.Reserve(PointsNum * 14 + 4);
+
+	auto AddVector = [&Data](const FVector& Vector)
+	{
+		Data.Append({Vector.X, Vector.Y, Vector.Z});
+	};
+
+	for (int32 i = 0; i < PointsNum; ++i)
+	{
+		const FQuat Rotation = SplineComponent->GetQuaternionAtSplinePoint(i, ESplineCoordinateSpace::Local);
+		AddVector(SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Local));
+		AddVector(SplineComponent->GetArriveTangentAtSplinePoint(i, ESplineCoordinateSpace::Local));
+		AddVector(SplineComponent->GetLeaveTangentAtSplinePoint(i, ESplineCoordinateSpace::Local));
+		Data.Append({Rotation.X, Rotation.Y, Rotation.Z, Rotation.W});
+		Data.Add(static_cast<double>(SplineComponent->GetSplinePointType(i)));
+	}
+
+	Data.Add(SplineComponent->IsClosedLoop() ? 1.0 : 0.0);
+	Data.Add(static_cast<double>(AreaPlane));
+	Data.Add(AreaSamplesPerSection);
+
+	// 0 is reserved for the empty cache.
+	return FMath::Max(FCrc::MemCrc32(Data.GetData(), Data.Num() * sizeof(double)), 1u);
+}
+
+void ATrickySplineRuler::UpdateMeasurementCache()
+{
+	LLM_SCOPE_BYTAG(TrickyRulers);
+
+	const uint32 Hash = CalculateSplineHash();
+
+	if (MeasurementCache.IsValidFor(Hash))
+	{
+		return;
+	}
+
+	MeasurementCache.Reset();
+
+	const int32 PointsNum = SplineComponent->GetNumberOfSplinePoints();
+	const int32 SectionsNum = FMath::Max(GetLastSplinePoint(), 0);
+	MeasurementCache.Length = SplineComponent->GetSplineLength();
+
+	if (PointsNum > 0)
+	{
+		MeasurementCache.PointDistances.SetNumUninitialized(SectionsNum + 1);
+
+		for (int32 i = 0; i <= SectionsNum; ++i)
+		{
+			MeasurementCache.PointDistances[i] = SplineComponent->GetDistanceAlongSplineAtSplinePoint(i);
+		}
+	}
+
+	MeasurementCache.SectionLocations.SetNumUninitialized(SectionsNum);
+	MeasurementCache.SectionDirections.SetNumUninitialized(SectionsNum);
+	MeasurementCache.SectionLabelLocations.SetNumUninitialized(SectionsNum);
+
+	for (int32 i = 0; i < SectionsNum; ++i)
+	{
+		const float InputKey = static_cast<float>(i) + 0.5;
+		const FVector UpVector = SplineComponent->GetUpVectorAtSplineInputKey(InputKey, ESplineCoordinateSpace::Local);
+		const float Distance = SplineComponent->GetDistanceAlongSplineAtSplineInputKey(InputKey);
+		MeasurementCache.SectionLocations[i] = SplineComponent->GetLocationAtSplineInputKey(
+			InputKey, ESplineCoordinateSpace::Local);
+		MeasurementCache.SectionDirections[i] = SplineComponent->GetDirectionAtSplineInputKey(
+			InputKey, ESplineCoordinateSpace::Local).RotateAngleAxis(180.f, UpVector);
+		MeasurementCache.SectionLabelLocations[i] = SplineComponent->GetLocationAtDistanceAlongSpline(
+			Distance, ESplineCoordinateSpace::Local);
+	}
+
+	if (SplineComponent->IsClosedLoop())
+	{
+		LoopAreaCache.Update(SplineComponent, AreaPlane, AreaSamplesPerSection);
+		MeasurementCache.LoopArea = LoopAreaCache.GetArea();
+	}
+	else
+	{
+		LoopAreaCache.Reset();
+	}
+
+	MeasurementCache.SplineHash = Hash;
+}
+
+void ATrickySplineRuler::UpdateLoopMeasurements()
+{
+	if (!SplineComponent->IsClosedLoop())
+	{
+		Perimeter = 0.f;
+		EnclosedArea = 0.f;
+		Volume = 0.f;
+		return;
+	}
+
+	const FVector Scale = SplineComponent->GetComponentScale();
+	double PlaneScale = 1.0;
+
+	switch (AreaPlane)
+	{
+	case ERulerPlane::XY:
+		PlaneScale = Scale.X * Scale.Y;
+		break;
+
+	case ERulerPlane::XZ:
+		PlaneScale = Scale.X * Scale.Z;
+		break;
+
+	case ERulerPlane::YZ:
+		PlaneScale = Scale.Y * Scale.Z;
+		break;
+	}
+
+	Perimeter = MeasurementCache.Length / 100.f;
+	EnclosedArea = MeasurementCache.LoopArea * FMath::Abs(PlaneScale) / 10000.0;
+	Volume = EnclosedArea * static_cast<float>(LoopHeight) / 100.f;
+}
+
+void ATrickySplineRuler::UpdateClearance(const bool bForceFullUpdate)
+{
+	if (!bCheckClearance)
+	{
+		if (Clearance.IsValid())
+		{
+			Clearance.Reset();
+			BlockedLength = 0.f;
+			UpdateClearanceShapes();
+		}
+
+		return;
+	}
+
+	if (!Clearance.IsValid())
+	{
+		Clearance = MakeShared<FTrickySplineClearance>();
+	}
+
+	FTrickyClearanceSettings Settings;
+	Settings.Radius = ClearanceCapsule.Radius;
+	Settings.HalfHeight = ClearanceCapsule.GetHalfHeight();
+	Settings.StepHeight = MaxStepHeight;
+	Settings.SampleStep = ClearanceSampleStep;
+	Settings.bCenterOrigin = ClearanceCapsule.bCenterOrigin;
+	Settings.Channel = ClearanceChannel;
+	Clearance->Update(GetWorld(), SplineComponent, Settings, bForceFullUpdate);
+}
+
+void ATrickySplineRuler::UpdateClearanceShapes()
+{
+	if (!ClearanceShapesComponent)
+	{
+		return;
+	}
+
+	if (!Clearance.IsValid())
+	{
+		ClearanceShapesComponent->ClearShapes();
+		return;
+	}
+
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+
+	for (const FTrickyClearanceSection& Section : Clearance->GetSections())
+	{
+		for (TConstSetBitIterator<> It(Section.BlockedSegments); It; ++It)
+		{
+			const int32 Segment = It.GetIndex();
+			Lines.Emplace(Section.Samples[Segment],
+			              Section.Samples[Segment + 1],
+			              ClearanceCapsule.Color,
+			              ClearanceCapsule.Thickness);
+		}
+	}
+
+	BlockedLength = Clearance->GetBlockedLength() / 100.f;
+	ClearanceShapesComponent->SetLines(MoveTemp(Lines));
+}
+
+void ATrickySplineRuler::UpdateElevation(const bool bForceFullUpdate)
+{
+	// Runtime rulers don't tick, so they can't receive the results.
+	if (!ElevationProfile.bIsEnabled || bIsRuntimeRuler)
+	{
+		if (Elevation.IsValid())
+		{
+			Elevation.Reset();
+			UpdateElevationShapes();
+		}
+
+		return;
+	}
+
+	if (!Elevation.IsValid())
+	{
+		Elevation = MakeShared<FTrickyElevationProfile>();
+	}
+
+	FTrickyElevationSettings Settings;
+	Settings.SampleStep = ElevationProfile.SampleStep;
+	Settings.TraceRange = ElevationProfile.TraceRange;
+	Settings.Channel = ElevationProfile.Channel;
+	Elevation->Update(GetWorld(), SplineComponent, Settings, bForceFullUpdate);
+}
+
+void ATrickySplineRuler::UpdateElevationShapes()
+{
+	if (!ElevationShapesComponent)
+	{
+		return;
+	}
+
+	if (!Elevation.IsValid())
+	{
+		ElevationShapesComponent->ClearShapes();
+		return;
+	}
+
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+	Elevation->BuildSlopeLines(ElevationProfile, Lines);
+	ElevationShapesComponent->SetLines(MoveTemp(Lines));
+}
+
+void ATrickySplineRuler::HandleActorMoved(AActor* Actor)
+{
+	if (Elevation.IsValid() && Actor != this)
+	{
+		Elevation->Invalidate(GetWorld(), Actor);
+	}
+}
+
+bool ATrickySplineRuler::IsDisplayLODActive() const
+{
+	return bUseDisplayLOD && SplineComponent->GetNumberOfSplinePoints() >= DisplayLODPointsThreshold;
+}
+
+void ATrickySplineRuler::UpdateDisplayData()
+{
+	const int32 SectionsNum = MeasurementCache.SectionLocations.Num();
+	SectionsDisplayData.SetNum(SectionsNum);
+	SectionsChunks.Reset();
+	DisplayPolyline.Reset();
+	SimplifiedPolylines.Reset();
+
+	// Only the cached local values are transformed, the spline isn't evaluated again.
+	const FTransform& Transform = SplineComponent->GetComponentTransform();
+
+	for (int32 i = 0; i < SectionsNum; ++i)
+	{
+		FTrickySplineSectionDisplayData& Section = SectionsDisplayData[i];
+		Section.Direction = Transform.TransformVector(MeasurementCache.SectionDirections[i]).GetSafeNormal();
+		Section.Location = Transform.TransformPosition(MeasurementCache.SectionLocations[i]);
+		Section.Length = GetDistanceAtSplinePoint(i + 1) - GetDistanceAtSplinePoint(i);
+
+		if (i % SectionsPerChunk == 0)
+		{
+			FTrickySplineSectionsChunk& Chunk = SectionsChunks.AddDefaulted_GetRef();
+			Chunk.FirstSection = i;
+		}
+
+		FTrickySplineSectionsChunk& Chunk = SectionsChunks.Last();
+		Chunk.LastSection = i;
+		Chunk.MaxSectionLength = FMath::Max(Chunk.MaxSectionLength, Section.Length);
+		Chunk.Bounds += Section.Location;
+	}
+
+	const bool bIsLODActive = IsDisplayLODActive();
+	SplineComponent->SetDrawDebug(!bIsLODActive);
+
+	if (!bIsLODActive)
+	{
+		return;
+	}
+
+	BuildPolyline(DisplayPolyline);
+}
+
+void ATrickySplineRuler::BuildPolyline(TArray<FVector>& OutPoints) const
+{
+	const int32 SectionsNum = FMath::Max(GetLastSplinePoint(), 0);
+	OutPoints.Reserve(OutPoints.Num() + SectionsNum * 2 + 1);
+
+	for (int32 i = 0; i < SectionsNum; ++i)
+	{
+		const bool bIsLinear = SplineComponent->GetSplinePointType(i) == ESplinePointType::Linear;
+		const int32 Samples = bIsLinear ? 1 : CurveSectionSamples;
+
+		for (int32 Sample = 0; Sample < Samples; ++Sample)
+		{
+			const float InputKey = static_cast<float>(i) + static_cast<float>(Sample) / Samples;
+			OutPoints.Add(SplineComponent->GetLocationAtSplineInputKey(InputKey, ESplineCoordinateSpace::World));
+		}
+	}
+
+	OutPoints.Add(SplineComponent->GetLocationAtSplineInputKey(SectionsNum, ESplineCoordinateSpace::World));
+}
+
+FColor ATrickySplineRuler::GetSplineColor() const
+{
+#if WITH_EDITORONLY_DATA
+	const FColor Color = SplineComponent->EditorUnselectedSplineSegmentColor.ToFColor(true);
+#else
+	const FColor Color = FColor::Purple;
+#endif
+
+	return GroupState.IsValid() ? GroupState->GetColor(Color) : Color;
+}
+
+void ATrickySplineRuler::UpdateGroupState()
+{
+	GroupState = FTrickyRulerGroups::BindComponents(Group,
+	                                                DebugTextComponent,
+	                                                ClearanceShapesComponent,
+	                                                ElevationShapesComponent);
+}
+
+float ATrickySplineRuler::GetViewDistance(const FBox& Box) const
+{
+	const UWorld* World = GetWorld();
+
+	if (!World || World->ViewLocationsRenderedLastFrame.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	double MinDistanceSquared = TNumericLimits<double>::Max();
+
+	for (const FVector& ViewLocation : World->ViewLocationsRenderedLastFrame)
+	{
+		MinDistanceSquared = FMath::Min(MinDistanceSquared, Box.ComputeSquaredDistanceToPoint(ViewLocation));
+	}
+
+	return FMath::Sqrt(MinDistanceSquared);
+}
+
+bool ATrickySplineRuler::IsSmallOnScreen(const float Size, const float ViewDistance) const
+{
+	return Size / TrickyRulersGeometry::GetWorldSizePerPixel(ViewDistance) < MinSectionScreenSize;
+}
+
+const TArray<FVector>& ATrickySplineRuler::GetSimplifiedPolyline(const float ViewDistance)
+{
+	const float Tolerance = SimplificationTolerance * TrickyRulersGeometry::GetWorldSizePerPixel(ViewDistance);
+	const int32 Level = FMath::Max(FMath::FloorToInt32(FMath::Log2(Tolerance)), 0);
+
+	if (const TArray<FVector>* Polyline = SimplifiedPolylines.Find(Level))
+	{
+		return *Polyline;
+	}
+
+	TArray<FVector>& Polyline = SimplifiedPolylines.Add(Level);
+	TrickyRulersGeometry::SimplifyPolyline(DisplayPolyline, FMath::Pow(2.0, Level), Polyline);
+	return Polyline;
+}
+
+void ATrickySplineRuler::DrawSectionArrow(const FTrickySplineSectionDisplayData& Section, const FColor& Color) const
+{
+	constexpr float Angle = FMath::DegreesToRadians(ArrowAngleDeg);
+	DrawDebugCone(GetWorld(),
+	              Section.Location - Section.Direction * (ArrowLength * 0.5f),
+	              Section.Direction,
+	              ArrowLength,
+	              Angle,
+	              Angle,
+	              32,
+	              Color,
+	              false,
+	              0.f,
+	              0,
+	              2.f);
 }
@@ -0,0 +1,183 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyTrackingRuler.h"
+
+#include "TrickyDebugTextComponent.h"
+#include "TrickyDistanceGraphComponent.h"
+#include "Components/BillboardComponent.h"
+#include "Engine/Texture2D.h"
+
+
+ATrickyTrackingRuler::ATrickyTrackingRuler()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+	bIsEditorOnlyActor = true;
+
+	RootComponent = CreateEditorOnlyDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	TrickyDebugTextComponent = CreateEditorOnlyDefaultSubobject<UTrickyDebugTextComponent>(TEXT("DebugText"));
+	TrickyDebugTextComponent->SetupAttachment(GetRootComponent());
+	TrickyDebugTextComponent->SetDrawInGame(true);
+
+	DistanceGraphComponent = CreateEditorOnlyDefaultSubobject<UTrickyDistanceGraphComponent>(TEXT("DistanceGraph"));
+	DistanceGraphComponent->SetupAttachment(GetRootComponent());
+
+	BillboardComponent = CreateEditorOnlyDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
+
+	if (BillboardComponent)
+	{
+		BillboardComponent->SetupAttachment(GetRootComponent());
+		UTexture2D* BillboardTexture = LoadObject<UTexture2D>(this, TEXT("/Engine/EditorResources/S_TargetPoint"));
+		BillboardComponent->SetSprite(BillboardTexture);
+		SpriteScale = 0.5;
+	}
+}
+
+void ATrickyTrackingRuler::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ResetHistories();
+}
+
+#if WITH_EDITOR
+void ATrickyTrackingRuler::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (HasActorBegunPlay())
+	{
+		ResetHistories();
+	}
+}
+#endif
+
+void ATrickyTrackingRuler::ResetHistories()
+{
+	// Everything is allocated once here, recording doesn't allocate memory.
+	const int32 PairsNum = FMath::Max(Targets.Num() - 1, 0);
+	Histories.Reset(PairsNum);
+	Stats.Init(FTrickyDistanceStats(), PairsNum);
+	DebugTextData.Init(FTrickyDebugTextData(), PairsNum);
+
+	TArray<FTrickyDistanceGraphData> Graphs;
+
+	for (int32 i = 0; i < PairsNum; ++i)
+	{
+		const FTrickyDistanceHistoryPtr& History = Histories.Add_GetRef(
+			MakeShared<FTrickyDistanceHistory, ESPMode::ThreadSafe>(HistorySize));
+		Graphs.Add({History, Color});
+	}
+
+	DistanceGraphComponent->SetGraphs(bShowGraph ? Graphs : TArray<FTrickyDistanceGraphData>());
+}
+
+int32 ATrickyTrackingRuler::GetPairsNum() const
+{
+	return FMath::Min3(Histories.Num(), Stats.Num(), Targets.Num() - 1);
+}
+
+void ATrickyTrackingRuler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RecordSamples();
+	DrawDistances();
+
+	DebugTextUpdateTime -= DeltaTime;
+
+	if (bShowDebugText && DebugTextUpdateTime <= 0.f)
+	{
+		DebugTextUpdateTime = DebugTextUpdateInterval;
+		UpdateDebugText();
+	}
+}
+
+void ATrickyTrackingRuler::RecordSamples()
+{
+	const int32 PairsNum = GetPairsNum();
+
+	if (PairsNum <= 0 || !IsValid(Targets[0]))
+	{
+		return;
+	}
+
+	const FVector Origin = Targets[0]->GetActorLocation();
+
+	for (int32 i = 0; i < PairsNum; ++i)
+	{
+		const AActor* Target = Targets[i + 1];
+
+		if (!IsValid(Target))
+		{
+			continue;
+		}
+
+		const float Distance = FVector::Dist(Origin, Target->GetActorLocation());
+		Histories[i]->Push(Distance);
+		Stats[i].Add(Distance);
+	}
+}
+
+void ATrickyTrackingRuler::UpdateDebugText()
+{
+	const int32 PairsNum = GetPairsNum();
+
+	if (PairsNum <= 0 || !IsValid(Targets[0]))
+	{
+		return;
+	}
+
+	const FVector Origin = Targets[0]->GetActorLocation();
+
+	for (int32 i = 0; i < PairsNum; ++i)
+	{
+		const AActor* Target = Targets[i + 1];
+		const FTrickyDistanceStats& PairStats = Stats[i];
+		FTrickyDebugTextData& Label = DebugTextData[i];
+		Label.Color = Color;
+		Label.TextScale = DebugTextScale;
+		Label.bUseCustomLocation = true;
+
+		if (!IsValid(Target) || PairStats.Count == 0)
+		{
+			Label.Text.Reset();
+			continue;
+		}
+
+		Label.Location = (Origin + Target->GetActorLocation()) * 0.5f;
+		Label.Text = FString::Printf(
+			TEXT("----------\n%s - %s\n----------\nLive: %.2f m\nMin: %.2f m\nMax: %.2f m\nAvg: %.2f m\n----------"),
+			*Targets[0]->GetActorNameOrLabel(),
+			*Target->GetActorNameOrLabel(),
+			PairStats.Live / 100.f,
+			PairStats.Min / 100.f,
+			PairStats.Max / 100.f,
+			PairStats.GetAverage() / 100.f);
+	}
+
+	TrickyDebugTextComponent->SetDebugLabels(DebugTextData);
+	TrickyDebugTextComponent->SetDrawDebug(bShowDebugText);
+}
+
+void ATrickyTrackingRuler::DrawDistances() const
+{
+	const int32 PairsNum = GetPairsNum();
+
+	if (PairsNum <= 0 || !IsValid(Targets[0]))
+	{
+		return;
+	}
+
+	const FVector Origin = Targets[0]->GetActorLocation();
+
+	for (int32 i = 1; i <= PairsNum; ++i)
+	{
+		if (IsValid(Targets[i]))
+		{
+			DrawDebugLine(GetWorld(), Origin, Targets[i]->GetActorLocation(), Color, false, 0.f, 0, Thickness);
+		}
+	}
+}
@@ -0,0 +1,288 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyUnitWireframeCache.h"
+
+namespace TrickyUnitWireframe
+{
+	void AddLine(FTrickyUnitWireframe& Wireframe, const FVector3f& Start, const FVector3f& End)
+	{
+		Wireframe.LinePoints.Add(Start);
+		Wireframe.LinePoints.Add(End);
+	}
+
+	void AddArc(FTrickyUnitWireframe& Wireframe,
+	            const FVector3f& Base,
+	            const FVector3f& X,
+	            const FVector3f& Y,
+	            const int32 Sides,
+	            const int32 SidesToDraw)
+	{
+		const float AngleDelta = UE_TWO_PI / Sides;
+		FVector3f LastVertex = Base + X;
+
+		for (int32 i = 0; i < SidesToDraw; ++i)
+		{
+			const float Angle = AngleDelta * (i + 1);
+			const FVector3f Vertex = Base + X * FMath::Cos(Angle) + Y * FMath::Sin(Angle);
+			AddLine(Wireframe, LastVertex, Vertex);
+			LastVertex = Vertex;
+		}
+	}
+
+	/**
+	 * Same layout as DrawDebugSphere.
+	 */
+	void BuildSphere(FTrickyUnitWireframe& Wireframe, const int32 Segments)
+	{
+		const float AngleInc = UE_TWO_PI / Segments;
+		float Latitude = AngleInc;
+		float SinY1 = 0.f;
+		float CosY1 = 1.f;
+
+		for (int32 Y = 0; Y < Segments; ++Y)
+		{
+			const float SinY2 = FMath::Sin(Latitude);
+			const float CosY2 = FMath::Cos(Latitude);
+			FVector3f Vertex1(SinY1, 0.f, CosY1);
+			FVector3f Vertex3(SinY2, 0.f, CosY2);
+			float Longitude = AngleInc;
+
+			for (int32 X = 0; X < Segments; ++X)
+			{
+				const float SinX = FMath::Sin(Longitude);
+				const float CosX = FMath::Cos(Longitude);
+				const FVector3f Vertex2(CosX * SinY1, SinX * SinY1, CosY1);
+				const FVector3f Vertex4(CosX * SinY2, SinX * SinY2, CosY2);
+				AddLine(Wireframe, Vertex1, Vertex2);
+				AddLine(Wireframe, Vertex1, Vertex3);
+				Vertex1 = Vertex2;
+				Vertex3 = Vertex4;
+				Longitude += AngleInc;
+			}
+
+			SinY1 = SinY2;
+			CosY1 = CosY2;
+			Latitude += AngleInc;
+		}
+	}
+
+	/**
+	 * Cylinder with the radius of 1 going from 0 to 1 along Z.
+	 */
+	void BuildCylinder(FTrickyUnitWireframe& Wireframe, const int32 Segments)
+	{
+		const FVector3f Top = FVector3f::UnitZ();
+		AddArc(Wireframe, FVector3f::ZeroVector, FVector3f::UnitX(), FVector3f::UnitY(), Segments, Segments);
+		AddArc(Wireframe, Top, FVector3f::UnitX(), FVector3f::UnitY(), Segments, Segments);
+
+		for (int32 i = 0; i < Segments; ++i)
+		{
+			const float Angle = UE_TWO_PI / Segments * i;
+			const FVector3f Point(FMath::Cos(Angle), FMath::Sin(Angle), 0.f);
+			AddLine(Wireframe, Point, Point + Top);
+		}
+	}
+
+	/**
+	 * Same layout as DrawDebugCapsule with the radius of 1.
+	 */
+	void BuildCapsule(FTrickyUnitWireframe& Wireframe, const float HalfAxis)
+	{
+		constexpr int32 Sides = 16;
+		const FVector3f X = FVector3f::UnitX();
+		const FVector3f Y = FVector3f::UnitY();
+		const FVector3f Z = FVector3f::UnitZ();
+		const FVector3f TopEnd = Z * HalfAxis;
+		const FVector3f BottomEnd = -TopEnd;
+
+		AddArc(Wireframe, TopEnd, X, Y, Sides, Sides);
+		AddArc(Wireframe, BottomEnd, X, Y, Sides, Sides);
+		AddArc(Wireframe, TopEnd, Y, Z, Sides, Sides / 2);
+		AddArc(Wireframe, TopEnd, X, Z, Sides, Sides / 2);
+		AddArc(Wireframe, BottomEnd, Y, -Z, Sides, Sides / 2);
+		AddArc(Wireframe, BottomEnd, X, -Z, Sides, Sides / 2);
+
+		AddLine(Wireframe, TopEnd + X, BottomEnd + X);
+		AddLine(Wireframe, TopEnd - X, BottomEnd - X);
+		AddLine(Wireframe, TopEnd + Y, BottomEnd + Y);
+		AddLine(Wireframe, TopEnd - Y, BottomEnd - Y);
+	}
+
+	/**
+	 * Box from -0.5 to 0.5 on each axis.
+	 */
+	void BuildBox(FTrickyUnitWireframe& Wireframe)
+	{
+		FVector3f Vertices[8];
+
+		for (int32 i = 0; i < 8; ++i)
+		{
+			Vertices[i] = FVector3f((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+		}
+
+		constexpr int32 Edges[12][2] = {
+			{0, 1}, {2, 3}, {4, 5}, {6, 7},
+			{0, 2}, {1, 3}, {4, 6}, {5, 7},
+			{0, 4}, {1, 5}, {2, 6}, {3, 7}
+		};
+
+		for (const auto& Edge : Edges)
+		{
+			AddLine(Wireframe, Vertices[Edge[0]], Vertices[Edge[1]]);
+		}
+	}
+
+	/**
+	 * Same layout as DrawDebugCone with the length of 1 along X.
+	 */
+	void BuildCone(FTrickyUnitWireframe& Wireframe, const int32 Segments, const float HalfAngle, const bool bIsFlat)
+	{
+		const float AngleWidth = FMath::Clamp(FMath::DegreesToRadians(HalfAngle),
+		                                      UE_KINDA_SMALL_NUMBER,
+		                                      UE_PI - UE_KINDA_SMALL_NUMBER);
+		const float AngleHeight = bIsFlat ? UE_KINDA_SMALL_NUMBER : AngleWidth;
+		const float SinX2 = FMath::Sin(0.5f * AngleWidth);
+		const float SinY2 = FMath::Sin(0.5f * AngleHeight);
+		const float SinSqX2 = SinX2 * SinX2;
+		const float SinSqY2 = SinY2 * SinY2;
+
+		TArray<FVector3f, TInlineAllocator<64>> Vertices;
+		Vertices.SetNumUninitialized(Segments);
+
+		for (int32 i = 0; i < Segments; ++i)
+		{
+			const float Theta = UE_TWO_PI * i / Segments;
+			const float Phi = FMath::Atan2(FMath::Sin(Theta) * SinY2, FMath::Cos(Theta) * SinX2);
+			const float SinPhi = FMath::Sin(Phi);
+			const float CosPhi = FMath::Cos(Phi);
+			const float RSq = SinSqX2 * SinSqY2 / (SinSqX2 * SinPhi * SinPhi + SinSqY2 * CosPhi * CosPhi);
+			const float R = FMath::Sqrt(RSq);
+			const float Sqr = FMath::Sqrt(1.f - RSq);
+			Vertices[i] = FVector3f(1.f - 2.f * RSq, 2.f * Sqr * R * CosPhi, 2.f * Sqr * R * SinPhi);
+		}
+
+		for (int32 i = 0; i < Segments; ++i)
+		{
+			AddLine(Wireframe, FVector3f::ZeroVector, Vertices[i]);
+			AddLine(Wireframe, Vertices[i], Vertices[(i + 1) % Segments]);
+		}
+	}
+}
+
+FTrickyUnitWireframeCache& FTrickyUnitWireframeCache::Get()
+{
+	static FTrickyUnitWireframeCache Cache;
+	return Cache;
+}
+
+FTrickyUnitWireframePtr FTrickyUnitWireframeCache::FindOrCreate(const FTrickyWireframeKey& Key)
+{
+	check(IsInGameThread());
+
+	if (const TWeakPtr<const FTrickyUnitWireframe, ESPMode::ThreadSafe>* Found = Wireframes.Find(Key))
+	{
+		if (FTrickyUnitWireframePtr Wireframe = Found->Pin())
+		{
+			return Wireframe;
+		}
+	}
+
+	const TSharedRef<FTrickyUnitWireframe, ESPMode::ThreadSafe> Wireframe = MakeShared<
+		FTrickyUnitWireframe, ESPMode::ThreadSafe>();
+	BuildWireframe(Key, *Wireframe);
+	Wireframes.Add(Key, Wireframe);
+
+	if (Wireframes.Num() >= PurgeThreshold)
+	{
+		RemoveExpired();
+	}
+
+	return Wireframe;
+}
+
+int32 FTrickyUnitWireframeCache::GetWireframesNum() const
+{
+	int32 Num = 0;
+
+	for (const auto& Wireframe : Wireframes)
+	{
+		Num += Wireframe.Value.IsValid();
+	}
+
+	return Num;
+}
+
+SIZE_T FTrickyUnitWireframeCache::GetAllocatedSize() const
+{
+	SIZE_T Size = Wireframes.GetAllocatedSize();
+
+	for (const auto& Wireframe : Wireframes)
+	{
+		if (const FTrickyUnitWireframePtr Pinned = Wireframe.Value.Pin())
+		{
+			Size += sizeof(FTrickyUnitWireframe) + Pinned->LinePoints.GetAllocatedSize();
+		}
+	}
+
+	return Size;
+}
+
+void FTrickyUnitWireframeCache::RemoveExpired()
+{
+	for (auto It = Wireframes.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	PurgeThreshold = FMath::Max(MinPurgeThreshold, Wireframes.Num() * 2);
+}
+
+void FTrickyUnitWireframeCache::BuildWireframe(const FTrickyWireframeKey& Key, FTrickyUnitWireframe& OutWireframe)
+{
+	using namespace TrickyUnitWireframe;
+
+	const int32 Segments = FMath::Max(Key.Segments, 4);
+
+	switch (Key.Shape)
+	{
+	case ETrickyWireframeShape::Circle:
+		AddArc(OutWireframe, FVector3f::ZeroVector, FVector3f::UnitX(), FVector3f::UnitY(), Segments, Segments);
+		break;
+
+	case ETrickyWireframeShape::Sphere:
+		BuildSphere(OutWireframe, Segments);
+		break;
+
+	case ETrickyWireframeShape::Cylinder:
+		BuildCylinder(OutWireframe, Segments);
+		break;
+
+	case ETrickyWireframeShape::Capsule:
+		BuildCapsule(OutWireframe, Key.Param);
+		break;
+
+	case ETrickyWireframeShape::Box:
+		BuildBox(OutWireframe);
+		break;
+
+	case ETrickyWireframeShape::Cone:
+		BuildCone(OutWireframe, Segments, Key.Param, Key.bIsFlat);
+		break;
+
+	case ETrickyWireframeShape::Cross:
+		AddLine(OutWireframe, -FVector3f::UnitX(), FVector3f::UnitX());
+		AddLine(OutWireframe, -FVector3f::UnitY(), FVector3f::UnitY());
+		break;
+	}
+
+	OutWireframe.LinePoints.Shrink();
+
+	for (const FVector3f& Point : OutWireframe.LinePoints)
+	{
+		OutWireframe.Bounds += Point;
+	}
+}
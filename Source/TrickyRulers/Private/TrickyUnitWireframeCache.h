@@ -0,0 +1,92 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ETrickyWireframeShape : uint8
+{
+	Circle,
+	Sphere,
+	Cylinder,
+	Capsule,
+	Box,
+	Cone,
+	Cross,
+};
+
+struct FTrickyWireframeKey
+{
+	ETrickyWireframeShape Shape = ETrickyWireframeShape::Circle;
+
+	int32 Segments = 0;
+
+	/**
+	 * Shape specific parameter which can't be applied with scale: half axis per radius for capsules
+	 * and half angle in degrees for cones.
+	 */
+	float Param = 0.f;
+
+	/**
+	 * Flat cones are drawn as a fan.
+	 */
+	bool bIsFlat = false;
+
+	bool operator==(const FTrickyWireframeKey& Other) const
+	{
+		return Shape == Other.Shape
+			&& Segments == Other.Segments
+			&& Param == Other.Param
+			&& bIsFlat == Other.bIsFlat;
+	}
+
+	friend uint32 GetTypeHash(const FTrickyWireframeKey& Key)
+	{
+		uint32 Hash = HashCombine(::GetTypeHash(static_cast<uint8>(Key.Shape)), ::GetTypeHash(Key.Segments));
+		Hash = HashCombine(Hash, ::GetTypeHash(Key.Param));
+		return HashCombine(Hash, ::GetTypeHash(Key.bIsFlat));
+	}
+};
+
+/**
+ * Wireframe of a shape with unit dimensions, shared by all rulers with the same configuration.
+ */
+struct FTrickyUnitWireframe
+{
+	/**
+	 * Pairs of line ends.
+	 */
+	TArray<FVector3f> LinePoints;
+
+	FBox3f Bounds{ForceInit};
+};
+
+using FTrickyUnitWireframePtr = TSharedPtr<const FTrickyUnitWireframe, ESPMode::ThreadSafe>;
+
+/**
+ * Flyweight storage of unit wireframes. It keeps only weak references, so a wireframe lives while
+ * at least one ruler uses it, and memory depends on the amount of distinct configurations.
+ * Must be used on the game thread only, while the render thread only holds the shared pointers.
+ */
+class FTrickyUnitWireframeCache
+{
+public:
+	static FTrickyUnitWireframeCache& Get();
+
+	FTrickyUnitWireframePtr FindOrCreate(const FTrickyWireframeKey& Key);
+
+	int32 GetWireframesNum() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	constexpr static int32 MinPurgeThreshold = 64;
+
+	TMap<FTrickyWireframeKey, TWeakPtr<const FTrickyUnitWireframe, ESPMode::ThreadSafe>> Wireframes;
+
+	int32 PurgeThreshold = MinPurgeThreshold;
+
+	void RemoveExpired();
+
+	static void BuildWireframe(const FTrickyWireframeKey& Key, FTrickyUnitWireframe& OutWireframe);
+};
@@ -0,0 +1,145 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "TrickyDebugTextComponent.h"
+#include "TrickyRulerProperties.h"
+#include "TrickyBoundsRuler.generated.h"
+
+class UBillboardComponent;
+class UTrickyDebugShapesComponent;
+
+struct FTrickyCachedBounds
+{
+	FBox Box{ForceInit};
+	FTransform Transform = FTransform::Identity;
+	bool bIsDirty = true;
+};
+
+/**
+ * Shows bounds dimensions of the tracked actors.
+ * Bounds are recalculated only when the actors are moved or their components change, nothing is done per frame otherwise.
+ *
+ * @warning this is Editor Only actor
+ */
+UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
+	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyBoundsRuler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATrickyBoundsRuler();
+
+protected:
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	/**
+	 * Actors which bounds are measured.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler", meta=(EditCondition="!bTrackSelection"))
+	TArray<TObjectPtr<AActor>> TrackedActors;
+
+	/**
+	 * Determines if the actors selected in the editor should be measured instead of the tracked actors.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bTrackSelection = false;
+
+	/**
+	 * Determines if world axis aligned or actor oriented bounds are measured.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	EBoundsType BoundsType = EBoundsType::Oriented;
+
+	/**
+	 * Determines if components without collision are included in the bounds.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bIncludeNonColliding = true;
+
+	/**
+	 * Determines whether the debug text with dimensions should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bShowDebugText = true;
+
+	UPROPERTY(EditAnywhere, Category="Ruler", meta=(HideAlphaChannel))
+	FColor Color = FColor::Emerald;
+
+	UPROPERTY(EditAnywhere,
+		Category="Ruler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 2.0f;
+
+	/**
+	 * Scale of the debug text.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		AdvancedDisplay,
+		meta=(EditCondition="bShowDebugText", ClampMin=1, UIMin=1, ClampMax=2, UIMax=2, Delta=0.1))
+	float DebugTextScale = 1.f;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugShapesComponent> DebugShapesComponent = nullptr;
+
+	TMap<TWeakObjectPtr<AActor>, FTrickyCachedBounds> CachedBounds;
+
+	TMap<TWeakObjectPtr<USceneComponent>, FDelegateHandle> TransformHandles;
+
+	FDelegateHandle RenderStateDirtyHandle;
+
+	FDelegateHandle PhysicsStateCreatedHandle;
+
+	FDelegateHandle ActorDeletedHandle;
+
+	FDelegateHandle SelectionChangedHandle;
+
+	TArray<FTrickyDebugTextData> DebugTextData;
+
+	void BindDelegates();
+
+	void UnbindDelegates();
+
+	void BindActorComponents(AActor* Actor);
+
+	void UpdateTrackedActors();
+
+	void MarkActorDirty(const AActor* Actor);
+
+	void RebuildShapes();
+
+	void HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+
+	void HandleComponentChanged(UActorComponent& Component);
+
+	void HandlePhysicsStateCreated(UActorComponent* Component);
+
+	void HandleActorDeleted(AActor* Actor);
+
+	void HandleSelectionChanged(UObject* Object);
+};
@@ -0,0 +1,49 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DebugRenderSceneProxy.h"
+#include "TrickyRulerGroups.h"
+#include "Debug/DebugDrawComponent.h"
+#include "TrickyDebugShapesComponent.generated.h"
+
+/**
+ * Draws world space debug lines through a cached scene proxy.
+ * Unlike DrawDebugLine calls the lines cost nothing on the game thread until they're changed.
+ */
+UCLASS(ClassGroup=(TrickyProptotyping), meta=(BlueprintSpawnableComponent))
+class TRICKYRULERS_API UTrickyDebugShapesComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyDebugShapesComponent();
+
+	void SetLines(TArray<FDebugRenderSceneProxy::FDebugLine>&& InLines);
+
+	void ClearShapes();
+
+	/**
+	 * Hidden groups skip the lines in the proxy without rebuilding the render state.
+	 */
+	void SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState);
+
+	static void AddBoxLines(TArray<FDebugRenderSceneProxy::FDebugLine>& OutLines,
+	                        const FBox& Box,
+	                        const FTransform& Transform,
+	                        const FColor& Color,
+	                        const float Thickness);
+
+protected:
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+
+	FBox LinesBounds{ForceInit};
+
+	FTrickyRulerGroupStatePtr GroupState;
+};
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Debug/DebugDrawComponent.h"
+#include "TrickyRulerGroups.h"
+#include "TrickyRulersMemory.h"
 #include "TrickyDebugTextComponent.generated.h"
 
 USTRUCT(BlueprintType)
@@ -28,6 +30,53 @@ struct FTrickyDebugTextData
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="DebugText")
 	float TextScale = 1.f;
+
+	/**
+	 * World size in cm which is checked against the minimal label screen size of the component.
+	 * 0 means the label is never culled by screen size.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="DebugText", meta=(Units="cm", ClampMin=0, UIMin=0))
+	float CullSize = 0.f;
+};
+
+UENUM()
+enum class ETrickyNumericLabelKind : uint8
+{
+	SplinePoint,
+	SplineSection,
+	GridLine
+};
+
+/**
+ * Label stored as numbers. It's formatted into text only when it passes culling.
+ */
+USTRUCT()
+struct FTrickyNumericLabel
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	/**
+	 * Measured value in meters.
+	 */
+	UPROPERTY()
+	float Value = 0.f;
+
+	UPROPERTY()
+	float CullSize = 0.f;
+
+	UPROPERTY()
+	int32 Index = 0;
+
+	UPROPERTY()
+	FColor Color = FColor::Magenta;
+
+	UPROPERTY()
+	ETrickyNumericLabelKind Kind = ETrickyNumericLabelKind::SplinePoint;
+
+	FString ToString() const;
 };
 
 struct FDebugSceneProxyData
@@ -38,19 +87,25 @@ struct FDebugSceneProxyData
 		FVector Location;
 		FColor Color;
 		float Scale;
+		float CullSize;
 
-		FDebugText(): Location(FVector::ZeroVector), Color(FColor::Magenta), Scale(1)
+		FDebugText(): Location(FVector::ZeroVector), Color(FColor::Magenta), Scale(1), CullSize(0)
 		{
 		}
 
 		FDebugText(const FTrickyDebugTextData& Label, const FVector& InLocation)
-			: Text(Label.Text), Location(InLocation), Color(Label.Color.ToFColor(false)), Scale(Label.TextScale)
+			: Text(Label.Text),
+			  Location(InLocation),
+			  Color(Label.Color.ToFColor(false)),
+			  Scale(Label.TextScale),
+			  CullSize(Label.CullSize)
 		{
 		}
 	};
 
 	bool bDrawInGame = false;
 	TArray<FDebugText> DebugLabels;
+	TArray<FTrickyNumericLabel> NumericLabels;
 };
 
 class FDebugSceneProxy : public FDebugRenderSceneProxy
@@ -59,8 +114,14 @@ public:
 	FDebugSceneProxy(const UPrimitiveComponent* InComponent, FDebugSceneProxyData* ProxyData);
 
 	FDebugSceneProxyData ProxyData;
+
+	FTrickyProxyCounter Counter{ETrickyProxyKind::DebugText};
 };
 
+/**
+ * Draws the labels sorted by color and scale, so the canvas state changes once per group.
+ * Texts and their sizes are cached per unique string when the proxy is created.
+ */
 class FDebugTextDelegateHelper : public FDebugDrawDelegateHelper
 {
 public:
@@ -70,7 +131,43 @@ public:
 
 	bool bDrawDebug = true;
 
+	float MinScreenSize = 0.f;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
 	TArray<FDebugSceneProxyData::FDebugText> DebugLabels;
+
+	TArray<FTrickyNumericLabel> NumericLabels;
+
+private:
+	struct FLabelText
+	{
+		FText Text;
+
+		/**
+		 * Size of the text in pixels with the scale 1.
+		 */
+		FVector2D Size = FVector2D::ZeroVector;
+	};
+
+	TArray<FLabelText> LabelTexts;
+
+	/**
+	 * Index of the cached text for each label.
+	 */
+	TArray<int32> LabelTextIndices;
+
+	/**
+	 * Numeric labels formatted in the current and the previous frame by their index.
+	 * Labels visible in consecutive frames are formatted once, the rest are dropped after a frame.
+	 */
+	TMap<int32, FText> FormattedLabels;
+
+	TMap<int32, FText> PreviousFormattedLabels;
+
+	uint64 FormattedFrame = 0;
+
+	const FText& FormatNumericLabel(const int32 Index);
 };
 
 
@@ -98,12 +195,20 @@ protected:
 		meta=(EditCondition = "!bDrawOneLabel && bDrawDebug", EditConditionHides))
 	TArray<FTrickyDebugTextData> DebugLabels;
 
+	TArray<FTrickyNumericLabel> NumericLabels;
+
 	/**
 	 * Determines if the debug text should be shown in game.
 	 */
 	UPROPERTY(EditAnywhere, Category="DebugText", meta=(EditCondition="bDrawDebug"))
 	bool bDrawInGame = false;
 
+	/**
+	 * Labels with CullSize taking less pixels on screen than this value aren't drawn.
+	 */
+	UPROPERTY(EditAnywhere, Category="DebugText", meta=(EditCondition="bDrawDebug", ClampMin=0, UIMin=0))
+	float MinScreenSize = 0.f;
+
 	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
 
 	virtual FDebugDrawDelegateHelper& GetDebugDrawDelegateHelper() override { return DebugDrawDelegateManager; }
@@ -117,9 +222,26 @@ public:
 	UFUNCTION(BlueprintCallable, Category="DebugText")
 	void SetDebugLabels(const TArray<FTrickyDebugTextData>& LabelsData);
 
+	void SetNumericLabels(const TArray<FTrickyNumericLabel>& Labels);
+
 	UFUNCTION(BlueprintCallable, Category="DebugText")
 	void SetDrawDebug(const bool Value);
 
 	UFUNCTION(BlueprintCallable, Category="DebugText")
 	void SetDrawInGame(const bool Value);
+
+	UFUNCTION(BlueprintCallable, Category="DebugText")
+	void SetMinScreenSize(const float Value);
+
+	/**
+	 * Labels are hidden and recolored by the group without rebuilding the render state.
+	 */
+	void SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState);
+
+	int32 GetLabelsNum() const { return DebugLabels.Num() + NumericLabels.Num(); }
+
+	/**
+	 * Bytes of the label arrays and their strings owned by the component.
+	 */
+	SIZE_T GetLabelsAllocatedSize() const;
 };
@@ -0,0 +1,48 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/DebugDrawComponent.h"
+#include "TrickyDistanceHistory.h"
+#include "TrickyDistanceGraphComponent.generated.h"
+
+struct FTrickyDistanceGraphData
+{
+	FTrickyDistanceHistoryPtr History = nullptr;
+	FColor Color = FColor::Magenta;
+};
+
+/**
+ * Draws camera facing graphs of the distance histories.
+ * The proxy reads the histories directly, so recording new samples doesn't recreate the render state.
+ */
+UCLASS(ClassGroup=(TrickyProptotyping), meta=(BlueprintSpawnableComponent))
+class TRICKYRULERS_API UTrickyDistanceGraphComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyDistanceGraphComponent();
+
+	void SetGraphs(const TArray<FTrickyDistanceGraphData>& InGraphs);
+
+protected:
+	/**
+	 * Size of a single graph in cm.
+	 */
+	UPROPERTY(EditAnywhere, Category="Graph")
+	FVector2D GraphSize{200.f, 100.f};
+
+	UPROPERTY(EditAnywhere,
+		Category="Graph",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 2.0f;
+
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	TArray<FTrickyDistanceGraphData> Graphs;
+};
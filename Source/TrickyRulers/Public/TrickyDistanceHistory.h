@@ -0,0 +1,85 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Fixed size ring buffer of distance samples with a single writer on the game thread and a single reader
+ * on the render thread. Memory is allocated once, pushing and copying samples neither locks nor allocates.
+ */
+class FTrickyDistanceHistory
+{
+public:
+	explicit FTrickyDistanceHistory(const int32 InCapacity)
+		: Capacity(FMath::Max(InCapacity, 2)),
+		  Samples(MakeUnique<std::atomic<float>[]>(Capacity))
+	{
+	}
+
+	/**
+	 * Game thread only.
+	 */
+	void Push(const float Sample)
+	{
+		const uint32 Count = WriteCount.load(std::memory_order_relaxed);
+		Samples[Count % Capacity].store(Sample, std::memory_order_relaxed);
+		WriteCount.store(Count + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Copies the latest samples in chronological order.
+	 * A sample can be overwritten by the writer while it's being copied, which is fine for drawing.
+	 * @return amount of copied samples.
+	 */
+	int32 CopyLatest(TArrayView<float> OutSamples) const
+	{
+		const uint32 Count = WriteCount.load(std::memory_order_acquire);
+		const int32 SamplesNum = FMath::Min3<int32>(static_cast<int32>(FMath::Min<uint32>(Count, Capacity)),
+		                                            Capacity,
+		                                            OutSamples.Num());
+
+		for (int32 i = 0; i < SamplesNum; ++i)
+		{
+			const uint32 Index = (Count - SamplesNum + i) % Capacity;
+			OutSamples[i] = Samples[Index].load(std::memory_order_relaxed);
+		}
+
+		return SamplesNum;
+	}
+
+	int32 GetCapacity() const { return Capacity; }
+
+private:
+	const int32 Capacity;
+
+	TUniquePtr<std::atomic<float>[]> Samples;
+
+	std::atomic<uint32> WriteCount{0};
+};
+
+using FTrickyDistanceHistoryPtr = TSharedPtr<FTrickyDistanceHistory, ESPMode::ThreadSafe>;
+
+struct FTrickyDistanceStats
+{
+	float Live = 0.f;
+	float Min = TNumericLimits<float>::Max();
+	float Max = 0.f;
+	double Sum = 0.0;
+	uint32 Count = 0;
+
+	void Add(const float Sample)
+	{
+		Live = Sample;
+		Min = FMath::Min(Min, Sample);
+		Max = FMath::Max(Max, Sample);
+		Sum += Sample;
+		++Count;
+	}
+
+	float GetAverage() const
+	{
+		return Count > 0 ? static_cast<float>(Sum / Count) : 0.f;
+	}
+};
@@ -0,0 +1,127 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/DebugDrawComponent.h"
+#include "TrickyRulerGroups.h"
+#include "TrickyGridComponent.generated.h"
+
+struct FTrickyGridSettings
+{
+	/**
+	 * Index of the first cell on each axis. Lines are placed at the cell index multiplied by the cell size.
+	 */
+	FIntVector FirstCell = FIntVector::ZeroValue;
+
+	/**
+	 * Amount of cells on each axis. The grid is flat if there are no cells on Z.
+	 */
+	FIntVector CellsNum = FIntVector::ZeroValue;
+
+	float CellSize = 100.f;
+
+	/**
+	 * Every line with the index divisible by the interval is a major one.
+	 */
+	int32 MajorLineInterval = 10;
+
+	FColor Color = FColor::Red;
+
+	float Thickness = 1.f;
+
+	float MajorThickness = 2.f;
+
+	/**
+	 * Min distance in pixels between two drawn lines. Denser levels of the grid are skipped.
+	 */
+	float MinLineSpacing = 8.f;
+
+	bool HasSameLines(const FTrickyGridSettings& Other) const
+	{
+		return FirstCell == Other.FirstCell
+			&& CellsNum == Other.CellsNum
+			&& CellSize == Other.CellSize
+			&& MajorLineInterval == Other.MajorLineInterval;
+	}
+};
+
+/**
+ * Lines of the grid relative to the component.
+ * Lines are sorted from the coarsest level to the finest one, so any level is drawn as a prefix of the array.
+ */
+struct FTrickyGridGeometry
+{
+	/**
+	 * Level 1 is every major line, level 2 is every major line of the lines of level 1 and so on.
+	 */
+	constexpr static int32 MaxLevel = 3;
+
+	/**
+	 * Pairs of line ends.
+	 */
+	TArray<FVector3f> LinePoints;
+
+	/**
+	 * Amount of lines with the level equal or greater than the index.
+	 */
+	int32 LevelLinesNum[MaxLevel + 1] = {};
+
+	FBox3f Bounds{ForceInit};
+
+	static TSharedRef<const FTrickyGridGeometry, ESPMode::ThreadSafe> Build(const FTrickyGridSettings& Settings);
+
+	/**
+	 * Returns the level of the line at the index, major lines have level 1 or greater.
+	 */
+	static int32 GetLineLevel(const int32 Index, const int32 MajorLineInterval);
+};
+
+using FTrickyGridGeometryPtr = TSharedPtr<const FTrickyGridGeometry, ESPMode::ThreadSafe>;
+
+/**
+ * Draws a measurement grid. The lines are built once when the cells change, and the proxy picks
+ * the finest level of the grid which isn't denser than the min line spacing on screen.
+ */
+UCLASS(ClassGroup=(TrickyProptotyping), meta=(BlueprintSpawnableComponent))
+class TRICKYRULERS_API UTrickyGridComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyGridComponent();
+
+	/**
+	 * Rebuilds the lines only if the cells changed, the color and the thickness only recreate the proxy.
+	 */
+	void SetGrid(const FTrickyGridSettings& InSettings);
+
+	/**
+	 * Uses the lines built in advance, e.g. on a worker thread. Null geometry keeps the current lines.
+	 */
+	void SetGrid(const FTrickyGridSettings& InSettings, const FTrickyGridGeometryPtr& InGeometry);
+
+	/**
+	 * Determines if the current lines can't be reused for the settings.
+	 */
+	bool NeedsGeometry(const FTrickyGridSettings& InSettings) const;
+
+	void ClearGrid();
+
+	/**
+	 * The proxy reads visibility and color override of the group every frame.
+	 */
+	void SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState);
+
+protected:
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	FTrickyGridSettings Settings;
+
+	FTrickyGridGeometryPtr Geometry;
+
+	FTrickyRulerGroupStatePtr GroupState;
+};
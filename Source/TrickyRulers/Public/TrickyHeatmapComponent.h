@@ -0,0 +1,65 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/DebugDrawComponent.h"
+#include "TrickyHeatmapComponent.generated.h"
+
+/**
+ * Flat grid of quads relative to the component. It's built once for the size of the heatmap.
+ */
+struct FTrickyHeatmapGeometry
+{
+	FIntPoint NodesNum = FIntPoint::ZeroValue;
+
+	TArray<FVector3f> Positions;
+
+	TArray<uint32> Indices;
+
+	FBox3f Bounds{ForceInit};
+
+	static TSharedRef<const FTrickyHeatmapGeometry, ESPMode::ThreadSafe> Build(const FIntPoint& InNodesNum,
+	                                                                          const float CellSize);
+};
+
+using FTrickyHeatmapGeometryPtr = TSharedPtr<const FTrickyHeatmapGeometry, ESPMode::ThreadSafe>;
+
+using FTrickyHeatmapColorsPtr = TSharedPtr<const TArray<FColor>, ESPMode::ThreadSafe>;
+
+/**
+ * Draws a plane shaded by the colors of its nodes.
+ * The proxy keeps the grid in static buffers, changing the colors only uploads them to the existing proxy.
+ */
+UCLASS(ClassGroup=(TrickyProptotyping), meta=(BlueprintSpawnableComponent))
+class TRICKYRULERS_API UTrickyHeatmapComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyHeatmapComponent();
+
+	/**
+	 * Rebuilds the geometry only if the nodes changed.
+	 */
+	void SetGrid(const FIntPoint& InNodesNum, const float InCellSize);
+
+	/**
+	 * Colors of the nodes, row by row along X.
+	 */
+	void SetColors(TArray<FColor>&& InColors);
+
+	void ClearHeatmap();
+
+protected:
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	float CellSize = 0.f;
+
+	FTrickyHeatmapGeometryPtr Geometry;
+
+	FTrickyHeatmapColorsPtr Colors;
+};
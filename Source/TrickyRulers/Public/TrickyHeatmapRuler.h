@@ -0,0 +1,163 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "TrickyHeatmapRuler.generated.h"
+
+class FTrickyDistanceField;
+class UBillboardComponent;
+class UTrickyDebugTextComponent;
+class UTrickyHeatmapComponent;
+
+/**
+ * Shades a plane by the distance to the nearest target actor, e.g. to find spots too far from cover or spawn points.
+ * Distances are computed on the worker threads, moving a target recomputes only the tiles of the plane it affects.
+ *
+ * @warning this is Editor Only actor
+ */
+UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
+	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyHeatmapRuler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATrickyHeatmapRuler();
+
+	virtual ~ATrickyHeatmapRuler() override;
+
+protected:
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	virtual void PostEditMove(bool bFinished) override;
+#endif
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Collects all actors of the target class in the level.
+	 */
+	UFUNCTION(CallInEditor, Category="Heatmap")
+	void RefreshTargets();
+
+protected:
+	/**
+	 * Actors which distance is measured.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Heatmap")
+	TArray<TObjectPtr<AActor>> Targets;
+
+	/**
+	 * If set, actors of this class are added to the targets on refresh.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Heatmap")
+	TSubclassOf<AActor> TargetClass = nullptr;
+
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Heatmap",
+		meta=(Units="cm", ClampMin=100, UIMin=100))
+	float LengthX = 5000.f;
+
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Heatmap",
+		meta=(Units="cm", ClampMin=100, UIMin=100))
+	float LengthY = 5000.f;
+
+	/**
+	 * Distance between the sampled points. It's increased if the plane has too many of them.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Heatmap",
+		meta=(Units="cm", ClampMin=10, UIMin=10))
+	float CellSize = 100.f;
+
+	/**
+	 * Points further than this distance from every target are drawn with the far color and aren't covered.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Heatmap",
+		meta=(Units="cm", ClampMin=1, UIMin=1))
+	float MaxDistance = 2000.f;
+
+	UPROPERTY(EditAnywhere, Category="Heatmap", meta=(HideAlphaChannel))
+	FLinearColor NearColor = FLinearColor::Green;
+
+	UPROPERTY(EditAnywhere, Category="Heatmap", meta=(HideAlphaChannel))
+	FLinearColor FarColor = FLinearColor::Red;
+
+	/**
+	 * Determines whether the debug text with the coverage should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Heatmap")
+	bool bShowDebugText = true;
+
+	/**
+	 * Scale of the debug text.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Heatmap",
+		AdvancedDisplay,
+		meta=(EditCondition="bShowDebugText", ClampMin=1, UIMin=1, ClampMax=2, UIMax=2, Delta=0.1))
+	float DebugTextScale = 1.f;
+
+	/**
+	 * Percent of the points within the max distance from a target.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Heatmap", meta=(Units="Percent"))
+	float Coverage = 0.f;
+
+	/**
+	 * The largest distance from a point of the plane to its nearest target in meters.
+	 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Heatmap")
+	float MaxGap = 0.f;
+
+private:
+	constexpr static int32 MaxNodesPerAxis = 512;
+
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyHeatmapComponent> HeatmapComponent = nullptr;
+
+	TUniquePtr<FTrickyDistanceField> DistanceField;
+
+	TMap<TWeakObjectPtr<USceneComponent>, FDelegateHandle> TransformHandles;
+
+	bool bIsFieldDirty = true;
+
+	void BindTargets();
+
+	void UnbindTargets();
+
+	/**
+	 * Places the points of the plane again, all distances are recomputed on the next tick.
+	 */
+	void ResetField();
+
+	void UpdateField();
+
+	void HandleTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+};
@@ -0,0 +1,46 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrickyRulerProperties.h"
+#include "TrickySplineChangeTracker.h"
+
+class USplineComponent;
+
+/**
+ * Keeps shoelace sums of every section of a closed spline, so moving a single point
+ * resamples only the sections next to it.
+ */
+class FTrickyLoopAreaCache
+{
+public:
+	void Update(const USplineComponent* SplineComponent, const ERulerPlane Plane, const int32 SamplesPerSection);
+
+	void Reset();
+
+	/**
+	 * Enclosed area in cm^2 in the local space of the spline.
+	 */
+	double GetArea() const { return FMath::Abs(TotalSum) * 0.5; }
+
+private:
+	FTrickySplineChangeTracker ChangeTracker;
+
+	TArray<double> SectionSums;
+
+	double TotalSum = 0.0;
+
+	ERulerPlane CachedPlane = ERulerPlane::XY;
+
+	int32 CachedSamplesPerSection = 0;
+
+	TArray<double> SamplesX;
+
+	TArray<double> SamplesY;
+
+	double CalculateSectionSum(const USplineComponent* SplineComponent,
+	                           const int32 SectionIndex,
+	                           const ERulerPlane Plane,
+	                           const int32 SamplesPerSection);
+};
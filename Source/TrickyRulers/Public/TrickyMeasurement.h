@@ -0,0 +1,16 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Single named value measured by a ruler.
+ * Lengths are in meters, areas in square meters, volumes in cubic meters and angles in degrees.
+ */
+struct FTrickyMeasurement
+{
+	FName Name = NAME_None;
+
+	double Value = 0.0;
+};
@@ -0,0 +1,77 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrickyMeasurement.h"
+#include "TrickyMeasurementConstraint.generated.h"
+
+class FDataValidationContext;
+enum class EDataValidationResult : uint8;
+
+/**
+ * Allowed range of a single ruler measurement, e.g. a jump gap no longer than 4 m.
+ */
+USTRUCT(BlueprintType)
+struct TRICKYRULERS_API FTrickyMeasurementConstraint
+{
+	GENERATED_BODY()
+
+	/**
+	 * Name of the measurement, e.g. Length, Radius, Height, X, Angle, Perimeter or Area.
+	 */
+	UPROPERTY(EditAnywhere, Category="Constraint")
+	FName Measurement = TEXT("Length");
+
+	UPROPERTY(EditAnywhere, Category="Constraint", meta=(InlineEditConditionToggle))
+	bool bUseMin = false;
+
+	/**
+	 * Min allowed value. Lengths are in meters, areas in square meters and angles in degrees.
+	 */
+	UPROPERTY(EditAnywhere, Category="Constraint", meta=(EditCondition="bUseMin"))
+	float Min = 0.f;
+
+	UPROPERTY(EditAnywhere, Category="Constraint", meta=(InlineEditConditionToggle))
+	bool bUseMax = false;
+
+	/**
+	 * Max allowed value. Lengths are in meters, areas in square meters and angles in degrees.
+	 */
+	UPROPERTY(EditAnywhere, Category="Constraint", meta=(EditCondition="bUseMax"))
+	float Max = 0.f;
+
+	/**
+	 * Name of the rule shown in the reports, e.g. "Jump gap".
+	 */
+	UPROPERTY(EditAnywhere, Category="Constraint")
+	FString Description;
+
+	/**
+	 * Checks the measurement with the constraint name.
+	 * @return false and the description of the violation if the value is out of range or isn't measured.
+	 */
+	bool Check(TConstArrayView<FTrickyMeasurement> Measurements, FString& OutViolation) const;
+
+	static void CheckAll(TConstArrayView<FTrickyMeasurementConstraint> Constraints,
+	                     TConstArrayView<FTrickyMeasurement> Measurements,
+	                     TArray<FString>& OutViolations);
+
+	/**
+	 * Collects the measurements only if there are constraints to check.
+	 */
+	static void CheckAll(TConstArrayView<FTrickyMeasurementConstraint> Constraints,
+	                     TFunctionRef<void(TArray<FTrickyMeasurement>&)> GetMeasurements,
+	                     TArray<FString>& OutViolations);
+
+#if WITH_EDITOR
+	/**
+	 * Reports the violations as the data validation errors of the actor.
+	 * @return Invalid if there are violations, otherwise the given result of the parent class.
+	 */
+	static EDataValidationResult Validate(TConstArrayView<FString> Violations,
+	                                      const FString& ActorName,
+	                                      FDataValidationContext& Context,
+	                                      const EDataValidationResult Result);
+#endif
+};
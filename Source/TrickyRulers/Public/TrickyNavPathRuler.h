@@ -0,0 +1,158 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "TrickyNavPathRuler.generated.h"
+
+class UBillboardComponent;
+class UNavigationQueryFilter;
+class UTrickyDebugTextComponent;
+class ANavigationData;
+
+/**
+ * Measures the length of the navigation path between the ruler and the end point or the target actor.
+ * Paths are requested asynchronously and only when one of the end points or the navmesh changes.
+ *
+ * @warning this is Editor Only actor
+ */
+UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
+	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyNavPathRuler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATrickyNavPathRuler();
+
+protected:
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void Destroyed() override;
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	/**
+	 * Determines whether the debug text with the path length should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bShowDebugText = true;
+
+	/**
+	 * The path is measured to this actor if it's set.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	TObjectPtr<AActor> TargetActor = nullptr;
+
+	/**
+	 * End point of the path relative to the ruler. Used if the target actor isn't set.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(MakeEditWidget, EditCondition="TargetActor == nullptr"))
+	FVector EndPoint = FVector(500.f, 0.f, 0.f);
+
+	/**
+	 * Navigation filter used for the path queries. The default filter of the navigation data is used if not set.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	TSubclassOf<UNavigationQueryFilter> FilterClass = nullptr;
+
+	/**
+	 * Determines if partial paths should be measured when the end point isn't reachable.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bAllowPartialPath = false;
+
+	UPROPERTY(EditAnywhere, Category="Ruler", meta=(HideAlphaChannel))
+	FColor Color = FColor::Cyan;
+
+	UPROPERTY(EditAnywhere,
+		Category="Ruler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 4.0f;
+
+	/**
+	 * Scale of the debug text.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		AdvancedDisplay,
+		meta=(EditCondition="bShowDebugText", ClampMin=1, UIMin=1, ClampMax=2, UIMax=2, Delta=0.1))
+	float DebugTextScale = 1.f;
+
+	/**
+	 * Length of the navigation path in meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Ruler")
+	FString Dimensions = TEXT("TO BE CALCULATED");
+
+private:
+	constexpr static float EndPointTolerance = 1.f;
+
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
+
+	FNavPathSharedPtr Path = nullptr;
+
+	FDelegateHandle PathObserverHandle;
+
+	TArray<FVector> PathPoints;
+
+	float PathLength = 0.f;
+
+	uint32 QueryId = INVALID_NAVQUERYID;
+
+	FVector QueriedStart = FVector::ZeroVector;
+
+	FVector QueriedEnd = FVector::ZeroVector;
+
+	bool bIsPathRequired = true;
+
+	FVector GetEndLocation() const;
+
+	bool HasEndPointsChanged() const;
+
+	void RequestPath();
+
+	void AbortPathRequest();
+
+	void SetPath(FNavPathSharedPtr NewPath);
+
+	void ClearPath();
+
+	/**
+	 * The navigation system outlives the rulers, so the binding is removed when the ruler is unregistered.
+	 */
+	void BindToNavigation();
+
+	void UnbindFromNavigation();
+
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(ANavigationData* NavData);
+
+	UFUNCTION()
+	void UpdateDimensions();
+
+	UFUNCTION()
+	void DrawPath() const;
+};
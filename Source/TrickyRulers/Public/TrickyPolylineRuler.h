@@ -0,0 +1,155 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TrickyMeasurement.h"
+#include "TrickyMeasurementConstraint.h"
+#include "TrickyRulerGroups.h"
+#include "TrickyPolylineRuler.generated.h"
+
+class UBillboardComponent;
+class UTrickyDebugTextComponent;
+class UTrickyRulerShapeComponent;
+struct FTrickyUnitWireframe;
+
+/**
+ * Measures a path made of straight segments. Unlike the spline ruler it doesn't evaluate curves,
+ * the points are kept in a flat array and the lengths in prefix sums, so paths with a lot of points stay interactive.
+ *
+ * @warning this is Editor Only actor
+ */
+UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
+	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyPolylineRuler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATrickyPolylineRuler();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	virtual void PostEditUndo() override;
+
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+
+	virtual bool CanEditChange(const FProperty* InProperty) const override;
+#endif
+
+	/**
+	 * Replaces the points of the polyline. The points are relative to the ruler.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Ruler")
+	void SetPoints(const TArray<FVector>& NewPoints);
+
+	/**
+	 * Returns the length of the polyline in cm from the first point to the given one.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Ruler")
+	double GetDistanceAtPoint(const int32 PointIndex) const;
+
+	/**
+	 * Returns the world location at the distance in cm along the polyline.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Ruler")
+	FVector GetLocationAtDistance(const double Distance) const;
+
+	void GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const;
+
+	void GetConstraintViolations(TArray<FString>& OutViolations) const;
+
+	FName GetGroup() const { return Group; }
+
+protected:
+	/**
+	 * Points of the polyline relative to the ruler.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler", meta=(MakeEditWidget))
+	TArray<FVector> Points{FVector::ZeroVector, FVector(500.f, 0.f, 0.f)};
+
+	/**
+	 * Determines if the last point is connected to the first one.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bIsClosedLoop = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	FName Group = NAME_None;
+
+	UPROPERTY(EditAnywhere, Category="Ruler", meta=(HideAlphaChannel))
+	FColor Color = FColor::Orange;
+
+	UPROPERTY(EditAnywhere,
+		Category="Ruler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 2.0f;
+
+	/**
+	 * Determines whether the debug text with the length should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bShowDebugText = true;
+
+	/**
+	 * Scale of the debug text.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		AdvancedDisplay,
+		meta=(EditCondition="bShowDebugText", ClampMin=1, UIMin=1, ClampMax=2, UIMax=2, Delta=0.1))
+	float DebugTextScale = 1.f;
+
+	/**
+	 * Length of the polyline in meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Ruler")
+	float Length = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Constraints")
+	TArray<FTrickyMeasurementConstraint> Constraints;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyRulerShapeComponent> ShapeComponent = nullptr;
+
+	/**
+	 * Length in cm from the first point to each point. The closing segment of the loop isn't included.
+	 */
+	TArray<double> PrefixLengths;
+
+	/**
+	 * Segments of the polyline relative to the ruler, drawn by the shape component as a single line list.
+	 */
+	TSharedPtr<const FTrickyUnitWireframe, ESPMode::ThreadSafe> Wireframe;
+
+	/**
+	 * The lengths and the lines are relative to the ruler, so they're only rebuilt when the points change.
+	 */
+	bool bArePointsDirty = true;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
+	double GetTotalLength() const;
+
+	void UpdateLengths();
+
+	void UpdateShape();
+
+	void UpdateDebugText();
+
+	void UpdateGroupState();
+};
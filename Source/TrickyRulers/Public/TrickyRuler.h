@@ -5,18 +5,31 @@
 #include "CoreMinimal.h"
 #include "TrickyDebugTextComponent.h"
 #include "GameFramework/Actor.h"
+#include "TrickyMeasurement.h"
+#include "TrickyMeasurementConstraint.h"
+#include "TrickyRulerGroups.h"
 #include "TrickyRulerProperties.h"
+#include "TrickyRuntimeRuler.h"
+#include "WorldCollision.h"
 #include "TrickyRuler.generated.h"
 
+class FTrickyElevationProfile;
+class UTrickyDebugShapesComponent;
+class UTrickyGridComponent;
+class UTrickyRulerShapeComponent;
+struct FTrickyGridSettings;
+struct FTrickyRulerRebuild;
+struct FTrickyWireframeInstance;
+
 /**
  * Represents a ruler actor that can calculate and visualize different measurement shapes,
- * such as line, circle, sphere, cylinder, capsule, box, and cone.
+ * such as line, circle, sphere, cylinder, capsule, box, cone, and grid.
  *
- * @warning this is Editor Only actor
+ * @warning this is Editor Only actor unless bShowInGame is enabled
  */
 UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
-	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
-class TRICKYRULERS_API ATrickyRuler : public AActor
+	Networking, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyRuler : public AActor, public ITrickyRuntimeRuler
 {
 	GENERATED_BODY()
 
@@ -26,17 +39,89 @@ public:
 protected:
 	virtual bool ShouldTickIfViewportsOnly() const override;
 
+#if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 
-	virtual void PostInitProperties() override;
-
 	virtual void PostEditMove(bool bFinished) override;
+#endif
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual bool IsEditorOnly() const override;
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+
+	virtual bool CanEditChange(const FProperty* InProperty) const override;
 
-	virtual void PostLoad() override;
+	virtual TUniquePtr<class FWorldPartitionActorDesc> CreateClassActorDesc() const override;
+#endif
 
 public:
 	virtual void Tick(float DeltaTime) override;
 
+	/**
+	 * Turns the ruler into the line ruler going from the start to the end point.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Ruler")
+	void SetupLineRuler(const FVector& Start, const FVector& End);
+
+	UFUNCTION(BlueprintCallable, Category="Ruler")
+	void SetLineRulerColor(const FColor& Color);
+
+	ERulerType GetRulerType() const { return RulerType; }
+
+	FName GetGroup() const { return Group; }
+
+	/**
+	 * Collects the dimensions of the current ruler type.
+	 * Only the properties are read, so it works for rulers without registered components, e.g. in commandlets.
+	 */
+	void GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const;
+
+	void GetConstraintViolations(TArray<FString>& OutViolations) const;
+
+	/**
+	 * Updates the dimensions and the debug text if it was postponed after loading or spawning.
+	 */
+	void FinishDeferredUpdate();
+
+	/**
+	 * Updates the group state and the traces, and gathers everything the rebuild reads from other objects.
+	 * Must be called on the game thread.
+	 */
+	void PrepareRebuild(FTrickyRulerRebuild& Rebuild);
+
+	/**
+	 * Formats the dimensions and builds the grid. Reads only the ruler properties and the prepared inputs,
+	 * so rebuilds of different rulers can run in parallel while the game thread waits.
+	 */
+	void BuildRebuild(FTrickyRulerRebuild& Rebuild) const;
+
+	/**
+	 * Passes the built shapes, grid and text to the components. Must be called on the game thread.
+	 */
+	void ApplyRebuild(FTrickyRulerRebuild& Rebuild);
+
+	virtual void GetRuntimeLines(TArray<FBatchedLine>& OutLines) const override;
+
+	virtual void GetRuntimeLabels(TArray<FTrickyRuntimeLabel>& OutLabels) const override;
+
+	virtual FTrickyRulerGroupStatePtr GetRuntimeGroupState() const override;
+
+#if WITH_EDITOR
+	/**
+	 * World space points of the line ruler stored in its World Partition descriptor.
+	 */
+	void GetDescriptorShape(TArray<FVector>& OutPoints) const;
+#endif
+
 protected:
 	/**
 	 * Determines whether the editing of the ruler properties is locked.
@@ -44,6 +129,20 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Ruler")
 	bool bLockEditing = false;
 
+	/**
+	 * Name of the group the ruler belongs to. Groups are hidden, recolored and locked
+	 * with the TrickyRulers.Group console commands. Rulers of a locked group can't leave it until it's unlocked.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	FName Group = NAME_None;
+
+	/**
+	 * Keeps the ruler in development game builds. In game the ruler doesn't tick,
+	 * its lines and debug text are drawn by UTrickyRulerSubsystem together with the other runtime rulers.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Runtime", meta=(EditCondition="!bLockEditing"))
+	bool bShowInGame = false;
+
 	/**
 	 * Determines whether the debug text with dimensions should be shown in viewport.
 	 */
@@ -84,6 +183,15 @@ protected:
 		meta=(EditCondition="RulerType==ERulerType::Line && !bLockEditing", EditConditionHides))
 	FLineRulerProperties LineRuler;
 
+	/**
+	 * Samples the surface height along the line ruler to show the climb and the slopes.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(EditCondition="RulerType==ERulerType::Line && !bLockEditing", EditConditionHides))
+	FElevationProfileProperties ElevationProfile;
+
 	/**
 	 * Defines the properties specific to the circle ruler type.
 	 */
@@ -138,6 +246,51 @@ protected:
 		meta=(EditCondition="RulerType==ERulerType::Cone && !bLockEditing", EditConditionHides))
 	FConeRulerProperties ConeRuler;
 
+	/**
+	 * Defines the properties specific to the grid ruler type.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(EditCondition="RulerType==ERulerType::Grid && !bLockEditing", EditConditionHides))
+	FGridRulerProperties GridRuler;
+
+	/**
+	 * Determines if the actors inside the sphere or the cone should be found and highlighted.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(EditCondition="(RulerType==ERulerType::Sphere || RulerType==ERulerType::Cone) && !bLockEditing",
+			EditConditionHides))
+	bool bReportContainedActors = false;
+
+	/**
+	 * Defines how the contained actors are found.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(EditCondition="(RulerType==ERulerType::Sphere || RulerType==ERulerType::Cone) && bReportContainedActors && !bLockEditing",
+			EditConditionHides))
+	FContainedActorsProperties ContainedActorsSettings;
+
+	/**
+	 * Actors found inside the sphere or the cone by the last query.
+	 */
+	UPROPERTY(VisibleAnywhere,
+		Transient,
+		Category="Ruler",
+		meta=(EditCondition="(RulerType==ERulerType::Sphere || RulerType==ERulerType::Cone) && bReportContainedActors",
+			EditConditionHides))
+	TArray<TWeakObjectPtr<AActor>> ContainedActors;
+
+	/**
+	 * Allowed ranges of the measurements. Violations are shown in the debug text and reported by data validation.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Constraints")
+	TArray<FTrickyMeasurementConstraint> Constraints;
+
 private:
 	UPROPERTY()
 	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
@@ -145,41 +298,133 @@ private:
 	UPROPERTY()
 	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
 
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugShapesComponent> DebugShapesComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyRulerShapeComponent> ShapeComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyGridComponent> GridComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugShapesComponent> ElevationShapesComponent = nullptr;
+
+	constexpr static int32 MaxListedContainedActors = 10;
+
+	/**
+	 * Labels of the major grid lines taking less pixels between them are hidden.
+	 */
+	constexpr static float MinGridLabelScreenSize = 64.f;
+
+	FTraceHandle ContainedActorsQueryHandle;
+
+	FDelegateHandle ActorMovedHandle;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
+	TSharedPtr<FTrickyElevationProfile> Elevation;
+
+	/**
+	 * World space bounds the contained actors were drawn with, so the actors moving inside are redrawn too.
+	 */
+	TArray<FBox> ContainedActorsBounds;
+
+	float TimeSinceContainedActorsQuery = 0.f;
+
+	bool bAreContainedActorsDirty = true;
+
+	/**
+	 * The contained actors are only known after the first query, e.g. commandlets never run it.
+	 */
+	bool bHasContainedActorsQueryFinished = false;
+
+	/**
+	 * Loaded rulers don't format the debug text until UTrickyRulerSubsystem gets to them.
+	 * Set again when the components are unregistered, so the update runs on the next registration.
+	 */
+	bool bIsUpdateDeferred = true;
+
+	bool bIsRuntimeRuler = false;
+
 	UFUNCTION()
 	void UpdateDimensions();
 
+	/**
+	 * Traces the whole elevation profile again, e.g. after the landscape was sculpted.
+	 */
+	UFUNCTION(CallInEditor, Category="Ruler")
+	void RefreshElevation();
+
+	void UpdateElevation(const bool bForceFullUpdate);
+
+	void UpdateElevationShapes();
+
+	/**
+	 * Resolves the state of the current group and passes it to the components.
+	 */
+	void UpdateGroupState();
+
+	/**
+	 * Returns the color overridden by the group keeping the alpha of the original one.
+	 */
+	FColor GetGroupColor(const FColor& Color) const;
+
 	UFUNCTION()
 	void DrawLineRuler() const;
 
+	/**
+	 * Calls the function for the line and each marker of the line ruler in world space.
+	 */
+	void ForEachLineRulerSegment(TFunctionRef<void(const FVector&, const FVector&)> Function) const;
+
 	void CalculateMarkerPositions(const FVector& Origin,
 	                              const FVector& Direction,
 	                              FVector& StartPos,
 	                              FVector& EndPos) const;
 
-	void DrawMarker(const FVector& Origin) const;
+	void ForEachMarkerSegment(const FVector& Origin, TFunctionRef<void(const FVector&, const FVector&)> Function) const;
 
+	/**
+	 * Draws the fill of the box, the wireframe is drawn by the shape component.
+	 */
 	UFUNCTION()
-	void DrawCircleRuler() const;
+	void DrawBoxRuler() const;
 
-	UFUNCTION()
-	void DrawSphereRuler() const;
+	/**
+	 * Picks shared unit wireframes for the current ruler type and passes them to the shape component.
+	 */
+	void UpdateShape();
 
-	UFUNCTION()
-	void DrawCylinderRuler() const;
+	/**
+	 * Collects the unit wireframes of the current ruler type placed relative to the ruler.
+	 */
+	void BuildShapes(TArray<FTrickyWireframeInstance>& OutShapes, FColor& OutColor, float& OutThickness) const;
 
-	UFUNCTION()
-	void DrawRadiusLines(const FVector& Origin,
-	                     const FVector& Direction,
-	                     const float Radius,
-	                     const FColor& Color,
-	                     const float Thickness) const;
+	FTrickyGridSettings MakeGridSettings() const;
 
-	UFUNCTION()
-	void DrawCapsuleRuler() const;
+	/**
+	 * Collects the labels of the major lines along the X and Y edges of the grid in world space.
+	 */
+	void BuildGridLabels(TArray<FTrickyNumericLabel>& OutLabels) const;
 
-	UFUNCTION()
-	void DrawBoxRuler() const;
+	void HandleRuntimeRulerMoved(USceneComponent* Component,
+	                             EUpdateTransformFlags UpdateTransformFlags,
+	                             ETeleportType Teleport);
 
-	UFUNCTION()
-	void DrawConeRuler() const;
+	bool CanContainActors() const;
+
+	void MarkContainedActorsDirty();
+
+	void UpdateContainedActors(const float DeltaTime);
+
+	void StartContainedActorsQuery();
+
+	void HandleContainedActorsQueryDone(const FTraceHandle& TraceHandle, FOverlapDatum& OverlapDatum);
+
+	bool IsInsideRuler(const FVector& Location) const;
+
+	void UpdateContainedActorsShapes();
+
+	void HandleActorMoved(AActor* Actor);
 };
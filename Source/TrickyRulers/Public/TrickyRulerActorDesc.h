@@ -0,0 +1,51 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+#include "TrickyMeasurement.h"
+#include "WorldPartition/WorldPartitionActorDesc.h"
+
+/**
+ * World Partition descriptor of a ruler. It's saved with the actor and loaded with the world,
+ * so the rulers of the unloaded cells can be listed and drawn without loading their packages.
+ * Splines are stored simplified, so the size of a descriptor doesn't grow with the amount of spline points.
+ */
+class TRICKYRULERS_API FTrickyRulerActorDesc : public FWorldPartitionActorDesc
+{
+public:
+	constexpr static int32 MaxShapePoints = 64;
+
+	/**
+	 * Type of the ruler, e.g. Line, Box or Spline.
+	 */
+	FName Kind = NAME_None;
+
+	FName Group = NAME_None;
+
+	FTransform RulerTransform = FTransform::Identity;
+
+	TArray<FTrickyMeasurement> Measurements;
+
+	/**
+	 * World space polyline of the line and spline rulers. Other rulers are described by the transform and the bounds.
+	 */
+	TArray<FVector> ShapePoints;
+
+	/**
+	 * Keeps the first and the last points and as many points in between as fit into the max amount.
+	 */
+	static void SimplifyShape(TConstArrayView<FVector> Points, TArray<FVector>& OutPoints);
+
+protected:
+	virtual void Init(const AActor* InActor) override;
+
+	virtual void Serialize(FArchive& Ar) override;
+
+	virtual bool Equals(const FWorldPartitionActorDesc* Other) const override;
+
+	virtual uint32 GetSizeOf() const override { return sizeof(FTrickyRulerActorDesc); }
+};
+#endif
@@ -0,0 +1,119 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Display state shared by all rulers of a group.
+ * The flags are read by the renderers every frame, so changing them doesn't touch the rulers themselves.
+ */
+struct FTrickyRulerGroupState
+{
+	std::atomic<bool> bIsHidden{false};
+
+	std::atomic<bool> bIsLocked{false};
+
+	/**
+	 * Packed FColor. Zero alpha means the rulers keep their own colors.
+	 */
+	std::atomic<uint32> ColorOverride{0};
+
+	bool IsHidden() const
+	{
+		return bIsHidden.load(std::memory_order_relaxed);
+	}
+
+	bool IsLocked() const
+	{
+		return bIsLocked.load(std::memory_order_relaxed);
+	}
+
+	FColor GetColor(const FColor& DefaultColor) const
+	{
+		const FColor Color(ColorOverride.load(std::memory_order_relaxed));
+		return Color.A > 0 ? Color : DefaultColor;
+	}
+};
+
+using FTrickyRulerGroupStatePtr = TSharedPtr<FTrickyRulerGroupState, ESPMode::ThreadSafe>;
+
+/**
+ * Central storage of the ruler groups. Groups are never removed, so the rulers and the proxies can keep
+ * the pointers to their states. Must be used on the game thread.
+ * In the editor the changed states are saved to the per-project user settings and restored when the group
+ * is created again, game builds keep them in memory.
+ */
+class TRICKYRULERS_API FTrickyRulerGroups
+{
+public:
+	static FTrickyRulerGroups& Get();
+
+	/**
+	 * Returns the state of the group creating it if needed, or null for NAME_None.
+	 */
+	FTrickyRulerGroupStatePtr FindOrAdd(const FName Group);
+
+	/**
+	 * Returns the state of the group if any ruler created it, or null.
+	 */
+	FTrickyRulerGroupStatePtr Find(const FName Group) const;
+
+	/**
+	 * The setters don't create groups, so the state of an unknown group isn't changed.
+	 */
+	void SetHidden(const FName Group, const bool bIsHidden);
+
+	void SetLocked(const FName Group, const bool bIsLocked);
+
+	void SetColor(const FName Group, const FColor& Color);
+
+	void ResetColor(const FName Group);
+
+	void GetGroupNames(TArray<FName>& OutGroups) const;
+
+	/**
+	 * Resolves the state of the group and passes it to the given components of a ruler.
+	 * Components must have SetGroupState, null ones are skipped.
+	 */
+	template <typename... TComponents>
+	static FTrickyRulerGroupStatePtr BindComponents(const FName Group, const TComponents&... Components)
+	{
+		FTrickyRulerGroupStatePtr State = Get().FindOrAdd(Group);
+
+		auto Bind = [&State](const auto& Component)
+		{
+			if (Component)
+			{
+				Component->SetGroupState(State);
+			}
+		};
+
+		(Bind(Components), ...);
+		return State;
+	}
+
+	/**
+	 * Locked groups forbid editing all properties of their rulers, including the group itself.
+	 */
+	static bool CanEdit(const FTrickyRulerGroupStatePtr& State)
+	{
+		return !State.IsValid() || !State->IsLocked();
+	}
+
+	/**
+	 * Incremented when the visibility or the color of any group is changed,
+	 * so the cached drawings can be refreshed without polling every group.
+	 */
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	TMap<FName, FTrickyRulerGroupStatePtr> Groups;
+
+	static void LoadState(const FName Group, FTrickyRulerGroupState& State);
+
+	static void SaveState(const FName Group, const FTrickyRulerGroupState& State);
+
+	uint32 Revision = 0;
+};
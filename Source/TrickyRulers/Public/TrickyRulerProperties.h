@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
 #include "TrickyRulerProperties.generated.h"
 
 UENUM()
@@ -15,6 +16,22 @@ enum class ERulerType : uint8
 	Capsule,
 	Box,
 	Cone,
+	Grid,
+};
+
+UENUM()
+enum class EBoundsType : uint8
+{
+	AxisAligned,
+	Oriented,
+};
+
+UENUM()
+enum class ERulerPlane : uint8
+{
+	XY,
+	XZ,
+	YZ,
 };
 
 USTRUCT(BlueprintType)
@@ -265,3 +282,213 @@ struct FConeRulerProperties
 		return static_cast<float>(Angle) * 0.5f;
 	}
 };
+
+USTRUCT(BlueprintType)
+struct FGridRulerProperties
+{
+	GENERATED_BODY()
+
+	constexpr static int32 MaxCellsPerAxis = 1000;
+
+	/**
+	 * Max amount of the lines of a 3D grid. Each axis has up to (N + 1)² lines along it,
+	 * so 3D grids get a lower limit of the cells per axis.
+	 */
+	constexpr static int32 MaxLines3D = 200000;
+
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(HideAlphaChannel))
+	FColor Color = FColor::Red;
+
+	/**
+	 * Size of the grid. It's rounded down to the whole cells.
+	 */
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(Units="cm", ClampMin=1, UIMin=1))
+	int32 LengthX = 10000;
+
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(Units="cm", ClampMin=1, UIMin=1))
+	int32 LengthY = 10000;
+
+	/**
+	 * Determines if the grid has cells along Z too.
+	 */
+	UPROPERTY(EditAnywhere, Category="GridRuler")
+	bool bIs3D = false;
+
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(Units="cm", ClampMin=1, UIMin=1, EditCondition="bIs3D"))
+	int32 LengthZ = 1000;
+
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(Units="cm", ClampMin=1, UIMin=1))
+	int32 CellSize = 100;
+
+	/**
+	 * Every N-th line is a major one. Major lines are thicker and labelled.
+	 */
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(ClampMin=2, UIMin=2, ClampMax=100, UIMax=100))
+	int32 MajorLineInterval = 10;
+
+	/**
+	 * Centers the grid on X and Y around the ruler.
+	 */
+	UPROPERTY(EditAnywhere, Category="GridRuler")
+	bool bCenterOrigin = true;
+
+	UPROPERTY(EditAnywhere, Category="GridRuler")
+	bool bShowMajorLabels = true;
+
+	UPROPERTY(EditAnywhere,
+		Category="GridRuler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 1.0f;
+
+	UPROPERTY(EditAnywhere,
+		Category="GridRuler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float MajorThickness = 3.0f;
+
+	/**
+	 * Min distance in pixels between the drawn lines. Minor lines and then major ones are skipped
+	 * when the grid is far from the camera.
+	 */
+	UPROPERTY(EditAnywhere, Category="GridRuler", meta=(ClampMin=2, UIMin=2, ClampMax=64, UIMax=64))
+	float MinLineSpacing = 8.f;
+
+	/**
+	 * Amount of the cells on each axis, clamped by GetMaxCellsPerAxis.
+	 */
+	FIntVector GetCellsNum() const
+	{
+		const int32 MaxCells = GetMaxCellsPerAxis();
+
+		auto GetAxisCells = [this, MaxCells](const int32 Length)
+		{
+			return FMath::Clamp(Length / CellSize, 1, MaxCells);
+		};
+
+		return FIntVector(GetAxisCells(LengthX), GetAxisCells(LengthY), bIs3D ? GetAxisCells(LengthZ) : 0);
+	}
+
+	int32 GetMaxCellsPerAxis() const
+	{
+		return bIs3D
+			       ? FMath::Min(MaxCellsPerAxis, FMath::FloorToInt32(FMath::Sqrt(MaxLines3D / 3.0)) - 1)
+			       : MaxCellsPerAxis;
+	}
+
+	FIntVector GetFirstCell() const
+	{
+		const FIntVector CellsNum = GetCellsNum();
+		return bCenterOrigin ? FIntVector(-CellsNum.X / 2, -CellsNum.Y / 2, 0) : FIntVector::ZeroValue;
+	}
+
+	FVector GetLengthInMeters() const
+	{
+		return FVector(GetCellsNum()) * static_cast<float>(CellSize) / 100.f;
+	}
+
+	float GetCellSizeInMeters() const
+	{
+		return static_cast<float>(CellSize) / 100.f;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FContainedActorsProperties
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category="ContainedActors", meta=(HideAlphaChannel))
+	FColor Color = FColor::Yellow;
+
+	/**
+	 * Object types of the actors to look for. All object types are used if empty.
+	 */
+	UPROPERTY(EditAnywhere, Category="ContainedActors")
+	TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
+
+	/**
+	 * Only actors of this class are reported. All actors are reported if not set.
+	 */
+	UPROPERTY(EditAnywhere, Category="ContainedActors")
+	TSubclassOf<AActor> ActorClass = nullptr;
+
+	/**
+	 * Min time between two overlap queries.
+	 */
+	UPROPERTY(EditAnywhere, Category="ContainedActors", meta=(Units="s", ClampMin=0.05, UIMin=0.05, ClampMax=5, UIMax=5))
+	float RefreshInterval = 0.25f;
+
+	/**
+	 * Determines if the names of the found actors should be listed in the debug text.
+	 */
+	UPROPERTY(EditAnywhere, Category="ContainedActors")
+	bool bListInDebugText = true;
+
+	UPROPERTY(EditAnywhere,
+		Category="ContainedActors",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 2.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FElevationProfileProperties
+{
+	GENERATED_BODY()
+
+	/**
+	 * Determines if the surface height should be sampled along the ruler.
+	 */
+	UPROPERTY(EditAnywhere, Category="ElevationProfile")
+	bool bIsEnabled = false;
+
+	/**
+	 * Distance between the samples along the ruler.
+	 */
+	UPROPERTY(EditAnywhere,
+		Category="ElevationProfile",
+		meta=(EditCondition="bIsEnabled", Units="cm", ClampMin=10, UIMin=10))
+	int32 SampleStep = 100;
+
+	/**
+	 * Distance above and below the ruler the surface is searched in.
+	 */
+	UPROPERTY(EditAnywhere,
+		Category="ElevationProfile",
+		meta=(EditCondition="bIsEnabled", Units="cm", ClampMin=1, UIMin=1))
+	float TraceRange = 10000.f;
+
+	UPROPERTY(EditAnywhere, Category="ElevationProfile", meta=(EditCondition="bIsEnabled"))
+	TEnumAsByte<ECollisionChannel> Channel = ECC_Visibility;
+
+	/**
+	 * Slope drawn with the steep color, flat parts of the surface are drawn with the flat color.
+	 */
+	UPROPERTY(EditAnywhere,
+		Category="ElevationProfile",
+		meta=(EditCondition="bIsEnabled", Units="deg", ClampMin=1, UIMin=1, ClampMax=90, UIMax=90))
+	float SteepSlope = 45.f;
+
+	UPROPERTY(EditAnywhere, Category="ElevationProfile", meta=(EditCondition="bIsEnabled", HideAlphaChannel))
+	FColor FlatColor = FColor::Green;
+
+	UPROPERTY(EditAnywhere, Category="ElevationProfile", meta=(EditCondition="bIsEnabled", HideAlphaChannel))
+	FColor SteepColor = FColor::Red;
+
+	/**
+	 * Height of the overlay above the surface, so it isn't hidden by it.
+	 */
+	UPROPERTY(EditAnywhere,
+		Category="ElevationProfile",
+		meta=(EditCondition="bIsEnabled", Units="cm", ClampMin=0, UIMin=0, ClampMax=100, UIMax=100))
+	float SurfaceOffset = 5.f;
+
+	UPROPERTY(EditAnywhere,
+		Category="ElevationProfile",
+		meta=(EditCondition="bIsEnabled", ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 3.0f;
+
+	FColor GetSlopeColor(const double Slope) const
+	{
+		const float Alpha = FMath::Clamp(static_cast<float>(Slope) / SteepSlope, 0.f, 1.f);
+		return FLinearColor::LerpUsingHSV(FlatColor, SteepColor, Alpha).ToFColor(true);
+	}
+};
@@ -0,0 +1,56 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/DebugDrawComponent.h"
+#include "TrickyRulerGroups.h"
+#include "TrickyRulerShapeComponent.generated.h"
+
+struct FTrickyUnitWireframe;
+
+struct FTrickyWireframeInstance
+{
+	TSharedPtr<const FTrickyUnitWireframe, ESPMode::ThreadSafe> Wireframe;
+
+	/**
+	 * Transform from the unit space of the wireframe to the component space.
+	 */
+	FTransform Transform = FTransform::Identity;
+};
+
+/**
+ * Draws shared unit wireframes placed with a transform and a color.
+ * The geometry is built once per configuration and the component only keeps references to it.
+ */
+UCLASS(ClassGroup=(TrickyProptotyping), meta=(BlueprintSpawnableComponent))
+class TRICKYRULERS_API UTrickyRulerShapeComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyRulerShapeComponent();
+
+	void SetShapes(TArray<FTrickyWireframeInstance>&& InShapes, const FColor& InColor, const float InThickness);
+
+	void ClearShapes();
+
+	/**
+	 * The proxy reads visibility and color override of the group every frame.
+	 */
+	void SetGroupState(const FTrickyRulerGroupStatePtr& InGroupState);
+
+protected:
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	TArray<FTrickyWireframeInstance> Shapes;
+
+	FColor Color = FColor::Red;
+
+	float Thickness = 1.f;
+
+	FTrickyRulerGroupStatePtr GroupState;
+};
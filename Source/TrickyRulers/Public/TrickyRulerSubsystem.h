@@ -0,0 +1,133 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TrickyRuntimeRuler.h"
+#include "TrickyRulerSubsystem.generated.h"
+
+class APlayerController;
+class ATrickyRuler;
+class UCanvas;
+
+/**
+ * Finishes initialization of the loaded rulers in batches limited by a time budget,
+ * starting from the ones closest to the viewports, so opening a map with thousands of rulers doesn't stall.
+ *
+ * In game worlds it also draws the runtime rulers: the lines of each ruler are put into its own batch
+ * of the persistent line batcher and only rebuilt after the ruler or its group is changed,
+ * and the labels of all rulers are drawn by one canvas delegate.
+ */
+UCLASS()
+class TRICKYRULERS_API UTrickyRulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Queues the ruler update. The ruler is updated immediately if its world has no subsystem or isn't ticked.
+	 */
+	static void RequestUpdate(ATrickyRuler* Ruler);
+
+	/**
+	 * Queues the ruler to be rebuilt together with the other changed rulers on the next tick.
+	 * The ruler is rebuilt immediately if its world has no subsystem or isn't ticked, e.g. in commandlets.
+	 */
+	static void RequestRebuild(ATrickyRuler* Ruler);
+
+	static void RegisterRuntimeRuler(AActor* Actor, ITrickyRuntimeRuler* Ruler);
+
+	static void UnregisterRuntimeRuler(AActor* Actor);
+
+	/**
+	 * Rebuilds the lines and the labels of the runtime ruler on the next tick.
+	 */
+	static void MarkRuntimeRulerDirty(AActor* Actor);
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual bool IsTickable() const override;
+
+	virtual bool IsTickableInEditor() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FRuntimeRulerEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		ITrickyRuntimeRuler* Ruler = nullptr;
+		uint32 BatchId = 0;
+		TArray<FTrickyRuntimeLabel> Labels;
+
+		/**
+		 * The group state the lines were built with, so a change of another group doesn't rebuild them.
+		 */
+		bool bWasGroupHidden = false;
+		uint32 GroupColorOverride = 0;
+
+		bool bIsDirty = true;
+	};
+
+	constexpr static double UpdateBudgetSeconds = 0.002;
+
+	/**
+	 * The first batch ID of the runtime rulers, each ruler gets the next one.
+	 */
+	constexpr static uint32 RuntimeLinesBatchIdBase = 0x54524c52;
+
+	/**
+	 * Limits the memory of the gathered rebuilds, the rest of the rulers are rebuilt on the next tick.
+	 */
+	constexpr static int32 MaxRebuildsPerTick = 4096;
+
+	TArray<TWeakObjectPtr<ATrickyRuler>> PendingRulers;
+
+	int32 NextRulerIndex = 0;
+
+	bool bArePendingRulersSorted = true;
+
+	TSet<TWeakObjectPtr<ATrickyRuler>> DirtyRulers;
+
+	TArray<FRuntimeRulerEntry> RuntimeRulers;
+
+	uint32 NextRuntimeBatchId = RuntimeLinesBatchIdBase;
+
+	uint32 RuntimeGroupsRevision = 0;
+
+	FDelegateHandle DrawRuntimeLabelsHandle;
+
+	bool bAreRuntimeRulersDirty = false;
+
+	/**
+	 * Returns the subsystem only if its world is ticked, otherwise the queued rulers would never be processed.
+	 */
+	static UTrickyRulerSubsystem* GetTickedSubsystem(const UWorld* World);
+
+	void SortPendingRulers();
+
+	/**
+	 * Gathers the inputs of the dirty rulers on the game thread, builds their text and grids in parallel,
+	 * and passes the results to the components in one pass.
+	 */
+	void RebuildDirtyRulers();
+
+	bool HaveRuntimeGroupsChanged() const;
+
+	/**
+	 * Marks the runtime rulers whose group was hidden, shown or recolored since their lines were built.
+	 */
+	void MarkChangedRuntimeGroupsDirty();
+
+	void RebuildRuntimeRulers();
+
+	void RebuildRuntimeRuler(FRuntimeRulerEntry& Entry, ULineBatchComponent* LineBatcher) const;
+
+	void DrawRuntimeLabels(UCanvas* Canvas, APlayerController* PlayerController) const;
+};
@@ -4,6 +4,8 @@
 
 #include "Modules/ModuleManager.h"
 
+class IConsoleObject;
+
 class FTrickyRulersModule : public IModuleInterface
 {
 public:
@@ -11,4 +13,12 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	/**
+	 * Commands which work in the editor and in development game builds.
+	 */
+	TArray<IConsoleObject*> ConsoleCommands;
+
+	void RegisterGroupCommands();
 };
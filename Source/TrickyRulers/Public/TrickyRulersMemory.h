@@ -0,0 +1,53 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+class UWorld;
+
+/**
+ * Allocations of the rulers, their components and proxies are tracked under this tag when LLM is enabled.
+ */
+LLM_DECLARE_TAG_API(TrickyRulers, TRICKYRULERS_API);
+
+enum class ETrickyProxyKind : uint8
+{
+	DebugText,
+	DebugShapes,
+	RulerShape,
+	Grid,
+	Heatmap,
+	DistanceGraph,
+	Num
+};
+
+/**
+ * Counts the live scene proxies of one kind while it's a member of the proxy.
+ * Proxies are created on the game thread and destroyed on the render thread, so the counters are atomic.
+ */
+class TRICKYRULERS_API FTrickyProxyCounter
+{
+public:
+	explicit FTrickyProxyCounter(const ETrickyProxyKind InKind);
+
+	FTrickyProxyCounter(const FTrickyProxyCounter&) = delete;
+
+	FTrickyProxyCounter& operator=(const FTrickyProxyCounter&) = delete;
+
+	~FTrickyProxyCounter();
+
+	static int32 GetLiveNum(const ETrickyProxyKind Kind);
+
+private:
+	ETrickyProxyKind Kind;
+};
+
+namespace TrickyRulersMemory
+{
+	/**
+	 * Writes the amount of rulers per class, their labels, proxies and bytes in the world to the output.
+	 */
+	TRICKYRULERS_API void Report(const UWorld* World, FOutputDevice& Output);
+}
@@ -0,0 +1,43 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrickyRulerGroups.h"
+#include "Components/LineBatchComponent.h"
+
+struct FTrickyRuntimeLabel
+{
+	FVector Location = FVector::ZeroVector;
+	FString Text;
+	FColor Color = FColor::Magenta;
+};
+
+/**
+ * Ruler which can be shown in development game builds.
+ * Runtime rulers don't tick, UTrickyRulerSubsystem collects their lines and labels once they're changed
+ * and draws them for all rulers of the world at once.
+ */
+class TRICKYRULERS_API ITrickyRuntimeRuler
+{
+public:
+	virtual ~ITrickyRuntimeRuler() = default;
+
+	/**
+	 * Collects the world space lines of the ruler. The lines are persistent until the ruler is changed.
+	 */
+	virtual void GetRuntimeLines(TArray<FBatchedLine>& OutLines) const = 0;
+
+	virtual void GetRuntimeLabels(TArray<FTrickyRuntimeLabel>& OutLabels) const = 0;
+
+	/**
+	 * The subsystem skips the rulers of hidden groups and applies the group color to the lines and the labels.
+	 */
+	virtual FTrickyRulerGroupStatePtr GetRuntimeGroupState() const = 0;
+
+	/**
+	 * Rulers which aren't shown in game are editor only. Runtime rulers are stripped from cooks too,
+	 * unless the cooker is launched with -TrickyRulersRuntime, so shipping cooks never contain them.
+	 */
+	static bool IsEditorOnlyRuler(const bool bShowInGame);
+};
@@ -0,0 +1,211 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid over a set of points for nearest neighbour and radius queries.
+ * It's immutable after construction, so it can be queried from many threads at once.
+ * The points aren't copied and must outlive the hash.
+ */
+class FTrickySpatialHash
+{
+public:
+	FTrickySpatialHash(const TConstArrayView<FVector> InPoints, const double InCellSize)
+		: Points(InPoints)
+		  , CellSize(FMath::Max(InCellSize, UE_KINDA_SMALL_NUMBER))
+	{
+		for (int32 i = 0; i < Points.Num(); ++i)
+		{
+			const FIntVector Cell = GetCell(Points[i]);
+			Cells.FindOrAdd(Cell).Add(i);
+
+			MinCell = i == 0 ? Cell : FIntVector(FMath::Min(MinCell.X, Cell.X),
+			                                     FMath::Min(MinCell.Y, Cell.Y),
+			                                     FMath::Min(MinCell.Z, Cell.Z));
+			MaxCell = i == 0 ? Cell : FIntVector(FMath::Max(MaxCell.X, Cell.X),
+			                                     FMath::Max(MaxCell.Y, Cell.Y),
+			                                     FMath::Max(MaxCell.Z, Cell.Z));
+		}
+	}
+
+	int32 Num() const { return Points.Num(); }
+
+	/**
+	 * Finds the closest other point by searching the cells in growing rings around the point.
+	 * @return INDEX_NONE if there are no other points.
+	 */
+	int32 FindNearest(const int32 PointIndex, double& OutDistance) const
+	{
+		return FindNearest(Points[PointIndex], PointIndex, OutDistance);
+	}
+
+	/**
+	 * Finds the closest point to the location, which doesn't have to be inside the hash.
+	 * @return INDEX_NONE if there are no points.
+	 */
+	int32 FindNearestTo(const FVector& Location, double& OutDistance) const
+	{
+		return FindNearest(Location, INDEX_NONE, OutDistance);
+	}
+
+	/**
+	 * Calls the functor with the index and the distance of every point within the radius.
+	 */
+	template <typename FunctorType>
+	void ForEachInRadius(const FVector& Location, const double Radius, FunctorType&& Functor) const
+	{
+		const FIntVector Lo = MaxCells(GetCell(Location - FVector(Radius)), MinCell);
+		const FIntVector Hi = MinCells(GetCell(Location + FVector(Radius)), MaxCell);
+		const double RadiusSquared = FMath::Square(Radius);
+
+		for (int32 X = Lo.X; X <= Hi.X; ++X)
+		{
+			for (int32 Y = Lo.Y; Y <= Hi.Y; ++Y)
+			{
+				for (int32 Z = Lo.Z; Z <= Hi.Z; ++Z)
+				{
+					const TArray<int32>* Indices = Cells.Find(FIntVector(X, Y, Z));
+
+					if (!Indices)
+					{
+						continue;
+					}
+
+					for (const int32 Index : *Indices)
+					{
+						const double DistanceSquared = FVector::DistSquared(Location, Points[Index]);
+
+						if (DistanceSquared <= RadiusSquared)
+						{
+							Functor(Index, FMath::Sqrt(DistanceSquared));
+						}
+					}
+				}
+			}
+		}
+	}
+
+private:
+	TConstArrayView<FVector> Points;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	FIntVector MinCell = FIntVector::ZeroValue;
+
+	FIntVector MaxCell = FIntVector::ZeroValue;
+
+	double CellSize = 1.0;
+
+	int32 FindNearest(const FVector& Location, const int32 IgnoredIndex, double& OutDistance) const
+	{
+		if (Points.Num() == 0)
+		{
+			OutDistance = 0.0;
+			return INDEX_NONE;
+		}
+
+		const FIntVector Cell = GetCell(Location);
+		const int32 MaxRing = FMath::Max3(FMath::Max(Cell.X - MinCell.X, MaxCell.X - Cell.X),
+		                                  FMath::Max(Cell.Y - MinCell.Y, MaxCell.Y - Cell.Y),
+		                                  FMath::Max(Cell.Z - MinCell.Z, MaxCell.Z - Cell.Z));
+
+		// The location can be outside of the hash, the rings closer than its bounds are empty.
+		const int32 MinRing = FMath::Max3(FMath::Max3(MinCell.X - Cell.X, Cell.X - MaxCell.X, 0),
+		                                  FMath::Max(MinCell.Y - Cell.Y, Cell.Y - MaxCell.Y),
+		                                  FMath::Max(MinCell.Z - Cell.Z, Cell.Z - MaxCell.Z));
+		int32 NearestIndex = INDEX_NONE;
+		double NearestDistanceSquared = TNumericLimits<double>::Max();
+
+		for (int32 Ring = MinRing; Ring <= MaxRing; ++Ring)
+		{
+			// Points in this ring are at least (Ring - 1) cells away.
+			if (NearestIndex != INDEX_NONE && FMath::Square((Ring - 1) * CellSize) > NearestDistanceSquared)
+			{
+				break;
+			}
+
+			ForEachCellInRing(Cell, Ring, [&](const TArray<int32>& Indices)
+			{
+				for (const int32 Index : Indices)
+				{
+					const double DistanceSquared = FVector::DistSquared(Location, Points[Index]);
+
+					if (Index != IgnoredIndex && DistanceSquared < NearestDistanceSquared)
+					{
+						NearestIndex = Index;
+						NearestDistanceSquared = DistanceSquared;
+					}
+				}
+			});
+		}
+
+		OutDistance = NearestIndex != INDEX_NONE ? FMath::Sqrt(NearestDistanceSquared) : 0.0;
+		return NearestIndex;
+	}
+
+	FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(FMath::FloorToInt32(Location.X / CellSize),
+		                  FMath::FloorToInt32(Location.Y / CellSize),
+		                  FMath::FloorToInt32(Location.Z / CellSize));
+	}
+
+	static FIntVector MinCells(const FIntVector& A, const FIntVector& B)
+	{
+		return FIntVector(FMath::Min(A.X, B.X), FMath::Min(A.Y, B.Y), FMath::Min(A.Z, B.Z));
+	}
+
+	static FIntVector MaxCells(const FIntVector& A, const FIntVector& B)
+	{
+		return FIntVector(FMath::Max(A.X, B.X), FMath::Max(A.Y, B.Y), FMath::Max(A.Z, B.Z));
+	}
+
+	/**
+	 * Visits only the shell of the cube, the inner cells were visited by the previous rings.
+	 * The shell is cut by the bounds of the hash, so it's empty if the bounds are outside of it.
+	 */
+	template <typename FunctorType>
+	void ForEachCellInRing(const FIntVector& Center, const int32 Ring, FunctorType&& Functor) const
+	{
+		const FIntVector Lo = MaxCells(Center - FIntVector(Ring), MinCell);
+		const FIntVector Hi = MinCells(Center + FIntVector(Ring), MaxCell);
+
+		for (int32 X = Lo.X; X <= Hi.X; ++X)
+		{
+			for (int32 Y = Lo.Y; Y <= Hi.Y; ++Y)
+			{
+				// Columns on the side of the shell are visited whole, the inner ones only at the top and the bottom.
+				if (FMath::Max(FMath::Abs(X - Center.X), FMath::Abs(Y - Center.Y)) == Ring)
+				{
+					for (int32 Z = Lo.Z; Z <= Hi.Z; ++Z)
+					{
+						VisitCell(FIntVector(X, Y, Z), Functor);
+					}
+
+					continue;
+				}
+
+				if (Center.Z - Ring >= Lo.Z)
+				{
+					VisitCell(FIntVector(X, Y, Center.Z - Ring), Functor);
+				}
+
+				if (Center.Z + Ring <= Hi.Z)
+				{
+					VisitCell(FIntVector(X, Y, Center.Z + Ring), Functor);
+				}
+			}
+		}
+	}
+
+	template <typename FunctorType>
+	void VisitCell(const FIntVector& Cell, FunctorType& Functor) const
+	{
+		if (const TArray<int32>* Indices = Cells.Find(Cell))
+		{
+			Functor(*Indices);
+		}
+	}
+};
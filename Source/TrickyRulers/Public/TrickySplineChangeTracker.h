@@ -0,0 +1,50 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USplineComponent;
+
+struct FTrickySplinePointState
+{
+	FVector Location = FVector::ZeroVector;
+	FVector ArriveTangent = FVector::ZeroVector;
+	FVector LeaveTangent = FVector::ZeroVector;
+	uint8 Type = 0;
+
+	bool operator==(const FTrickySplinePointState& Other) const
+	{
+		return Location == Other.Location
+			&& ArriveTangent == Other.ArriveTangent
+			&& LeaveTangent == Other.LeaveTangent
+			&& Type == Other.Type;
+	}
+
+	bool operator!=(const FTrickySplinePointState& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+/**
+ * Remembers spline points in local space between updates to find the sections which have to be recalculated.
+ */
+class FTrickySplineChangeTracker
+{
+public:
+	/**
+	 * Compares the spline with the cached state and marks the changed sections.
+	 * @return true if amount of sections changed and all of them have to be recalculated.
+	 */
+	bool Update(const USplineComponent* SplineComponent, TBitArray<>& OutDirtySections);
+
+	void Reset();
+
+	int32 GetSectionsNum() const;
+
+private:
+	TArray<FTrickySplinePointState> PointStates;
+
+	bool bIsClosedLoop = false;
+};
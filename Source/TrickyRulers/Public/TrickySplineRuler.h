@@ -4,10 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TrickyLoopAreaCache.h"
+#include "TrickyMeasurement.h"
+#include "TrickyMeasurementConstraint.h"
+#include "TrickyRulerGroups.h"
+#include "TrickyRulerProperties.h"
+#include "TrickyRuntimeRuler.h"
 #include "TrickySplineRuler.generated.h"
 
+class FTrickyElevationProfile;
+class FTrickySplineClearance;
+class UTrickyDebugShapesComponent;
 class UTrickySplineComponent;
 struct FTrickyDebugTextData;
+struct FTrickyNumericLabel;
 class UTrickyDebugTextComponent;
 
 namespace ESplinePointType
@@ -15,21 +25,128 @@ namespace ESplinePointType
 	enum Type : int;
 }
 
+struct FTrickySplineSectionDisplayData
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	float Length = 0.f;
+};
+
+struct FTrickySplineSectionsChunk
+{
+	FBox Bounds{ForceInit};
+	float MaxSectionLength = 0.f;
+	int32 FirstSection = 0;
+	int32 LastSection = 0;
+};
+
+/**
+ * Measurements of the spline saved with the ruler, so loading, validation and export don't evaluate the spline again.
+ * Locations and directions are relative to the spline, so moving the ruler doesn't invalidate the cache.
+ */
+USTRUCT()
+struct FTrickySplineMeasurementCache
+{
+	GENERATED_BODY()
+
+	/**
+	 * Hash of the spline points and the area settings the values were calculated for. 0 means the cache is empty.
+	 */
+	UPROPERTY()
+	uint32 SplineHash = 0;
+
+	/**
+	 * Length of the spline in cm.
+	 */
+	UPROPERTY()
+	float Length = 0.f;
+
+	/**
+	 * Distance along the spline at each point in cm, including the end of the loop.
+	 */
+	UPROPERTY()
+	TArray<float> PointDistances;
+
+	UPROPERTY()
+	TArray<FVector> SectionLocations;
+
+	UPROPERTY()
+	TArray<FVector> SectionDirections;
+
+	/**
+	 * Middle of each section by distance, used by the section length labels.
+	 */
+	UPROPERTY()
+	TArray<FVector> SectionLabelLocations;
+
+	/**
+	 * Enclosed area of the loop in cm^2 without the scale of the ruler.
+	 */
+	UPROPERTY()
+	double LoopArea = 0.0;
+
+	bool IsValidFor(const uint32 Hash) const { return SplineHash != 0 && SplineHash == Hash; }
+
+	void Reset() { *this = FTrickySplineMeasurementCache(); }
+};
+
 UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
-	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
-class TRICKYRULERS_API ATrickySplineRuler : public AActor
+	Networking, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickySplineRuler : public AActor, public ITrickyRuntimeRuler
 {
 	GENERATED_BODY()
 
 public:
 	ATrickySplineRuler();
 
+	/**
+	 * Collects the length of the spline and the loop measurements if it's closed.
+	 */
+	void GetMeasurements(TArray<FTrickyMeasurement>& OutMeasurements) const;
+
+	void GetConstraintViolations(TArray<FString>& OutViolations) const;
+
+	FName GetGroup() const { return Group; }
+
+	virtual void GetRuntimeLines(TArray<FBatchedLine>& OutLines) const override;
+
+	virtual void GetRuntimeLabels(TArray<FTrickyRuntimeLabel>& OutLabels) const override;
+
+	virtual FTrickyRulerGroupStatePtr GetRuntimeGroupState() const override;
+
+#if WITH_EDITOR
+	/**
+	 * Simplified world space polyline of the spline stored in its World Partition descriptor.
+	 */
+	void GetDescriptorShape(TArray<FVector>& OutPoints) const;
+#endif
+
 protected:
 	virtual bool ShouldTickIfViewportsOnly() const override;
 	
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	virtual void PostLoad() override;
+
 	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual bool IsEditorOnly() const override;
+
+	virtual void PostRegisterAllComponents() override;
+
+	virtual void PostUnregisterAllComponents() override;
+
+#if WITH_EDITOR
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+
+	virtual bool CanEditChange(const FProperty* InProperty) const override;
+
+	virtual TUniquePtr<class FWorldPartitionActorDesc> CreateClassActorDesc() const override;
+#endif
 	
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -38,6 +155,15 @@ protected:
 	UPROPERTY()
 	TObjectPtr<UTrickyDebugTextComponent> DebugTextComponent = nullptr;
 
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugShapesComponent> ClearanceShapesComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugShapesComponent> ElevationShapesComponent = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ruler")
+	FName Group = NAME_None;
+
 	/**
 	 * Determines if length per point should be shown.
 	 */
@@ -56,13 +182,183 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DebugText")
 	FColor DebugTextColor = FColor::Magenta;
 
+	/**
+	 * Keeps the ruler in development game builds. In game the ruler doesn't tick,
+	 * the spline and the debug text are drawn by UTrickyRulerSubsystem together with the other runtime rulers.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime")
+	bool bShowInGame = false;
+
+	/**
+	 * Determines if a simplified polyline should be drawn instead of the spline when it has a lot of points.
+	 * Measurements always use the full resolution spline.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DisplayLOD")
+	bool bUseDisplayLOD = true;
+
+	/**
+	 * Minimal amount of spline points to enable the display LOD.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category = "DisplayLOD",
+		meta=(EditCondition="bUseDisplayLOD", ClampMin=2, UIMin=2))
+	int32 DisplayLODPointsThreshold = 500;
+
+	/**
+	 * Max deviation of the simplified polyline from the spline in pixels.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category = "DisplayLOD",
+		meta=(EditCondition="bUseDisplayLOD", ClampMin=0.5, UIMin=0.5, ClampMax=16, UIMax=16))
+	float SimplificationTolerance = 2.f;
+
+	/**
+	 * Sections taking less pixels on screen than this value don't draw arrows and labels.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category = "DisplayLOD",
+		meta=(EditCondition="bUseDisplayLOD", ClampMin=0, UIMin=0, ClampMax=256, UIMax=256))
+	float MinSectionScreenSize = 24.f;
+
+	/**
+	 * Plane relative to the ruler which the closed loop is projected onto to calculate its area.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Area")
+	ERulerPlane AreaPlane = ERulerPlane::XY;
+
+	/**
+	 * Amount of samples per curved section used for area calculation.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Area", meta=(ClampMin=1, UIMin=1, ClampMax=64, UIMax=64))
+	int32 AreaSamplesPerSection = 16;
+
+	/**
+	 * Height of the closed loop used to calculate its volume. The volume isn't calculated if it equals 0.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Area", meta=(Units="cm", ClampMin=0, UIMin=0))
+	int32 LoopHeight = 0;
+
+	/**
+	 * Length of the closed loop in meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Area")
+	float Perimeter = 0.f;
+
+	/**
+	 * Area enclosed by the loop in square meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Area")
+	float EnclosedArea = 0.f;
+
+	/**
+	 * Volume of the loop extruded by LoopHeight in cubic meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Area")
+	float Volume = 0.f;
+
+	/**
+	 * Determines if a capsule should be swept along the spline to find the sections it can't pass.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clearance")
+	bool bCheckClearance = false;
+
+	/**
+	 * Capsule swept along the spline. Blocked parts of the spline are drawn with its color.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clearance", meta=(EditCondition="bCheckClearance"))
+	FCapsuleRulerProperties ClearanceCapsule;
+
+	/**
+	 * Collision channel used for the sweeps.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clearance", meta=(EditCondition="bCheckClearance"))
+	TEnumAsByte<ECollisionChannel> ClearanceChannel = ECC_Pawn;
+
+	/**
+	 * Height the capsule is lifted above the spline, so it doesn't hit the floor and small steps.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category = "Clearance",
+		meta=(EditCondition="bCheckClearance", Units="cm", ClampMin=0, UIMin=0))
+	float MaxStepHeight = 45.f;
+
+	/**
+	 * Distance between the sweeps along the spline.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category = "Clearance",
+		meta=(EditCondition="bCheckClearance", Units="cm", ClampMin=10, UIMin=10))
+	int32 ClearanceSampleStep = 50;
+
+	/**
+	 * Length of the blocked parts of the spline in meters.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Clearance")
+	float BlockedLength = 0.f;
+
+	/**
+	 * Samples the surface height along the spline to show the climb and the slopes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElevationProfile")
+	FElevationProfileProperties ElevationProfile;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Constraints")
+	TArray<FTrickyMeasurementConstraint> Constraints;
+
 private:
 	constexpr static float ArrowLength = 50.f;
 	constexpr static float ArrowAngleDeg = 12.f;
+	constexpr static int32 CurveSectionSamples = 8;
+	constexpr static int32 SectionsPerChunk = 64;
 	
 	UPROPERTY()
 	TArray<FTrickyDebugTextData> DebugTextData;
 
+	/**
+	 * Per point and per section labels, they're formatted only when drawn.
+	 * Not saved, they're rebuilt from the measurement cache once the components are registered.
+	 */
+	TArray<FTrickyNumericLabel> NumericLabels;
+
+	UPROPERTY()
+	FTrickySplineMeasurementCache MeasurementCache;
+
+	TArray<FTrickySplineSectionDisplayData> SectionsDisplayData;
+
+	TArray<FTrickySplineSectionsChunk> SectionsChunks;
+
+	/**
+	 * Full resolution polyline used as a source for simplified ones.
+	 */
+	TArray<FVector> DisplayPolyline;
+
+	/**
+	 * Simplified polylines cached per tolerance level.
+	 */
+	TMap<int32, TArray<FVector>> SimplifiedPolylines;
+
+	FTrickyLoopAreaCache LoopAreaCache;
+
+	TSharedPtr<FTrickySplineClearance> Clearance;
+
+	TSharedPtr<FTrickyElevationProfile> Elevation;
+
+	FDelegateHandle ActorMovedHandle;
+
+	FTrickyRulerGroupStatePtr GroupState;
+
+	bool bIsRuntimeRuler = false;
+
+	/**
+	 * Set on load, the world space labels need the registered components.
+	 */
+	bool bIsDebugTextStale = false;
+
 	/**
 	 * Sets all points type to linear.
 	 */
@@ -75,6 +371,18 @@ private:
 	UFUNCTION(CallInEditor, Category = "Spline", meta = (DisplayAfter="Transform"))
 	void SetTypeToCurve() const;
 
+	/**
+	 * Sweeps the whole spline again, e.g. after the level geometry was changed.
+	 */
+	UFUNCTION(CallInEditor, Category = "Clearance")
+	void RefreshClearance();
+
+	/**
+	 * Traces the whole elevation profile again, e.g. after the landscape was sculpted.
+	 */
+	UFUNCTION(CallInEditor, Category = "ElevationProfile")
+	void RefreshElevation();
+
 	UFUNCTION()
 	void SetSplinePointsType(ESplinePointType::Type NewType) const;
 
@@ -96,5 +404,54 @@ private:
 	UFUNCTION()
 	float GetDistanceAtSplinePoint(const int32 PointIndex) const;
 
+	/**
+	 * Hashes the local spline points and the settings which affect the cached measurements.
+	 */
+	uint32 CalculateSplineHash() const;
+
+	/**
+	 * Evaluates the spline again only if its hash differs from the cached one.
+	 */
+	void UpdateMeasurementCache();
+
+	void UpdateLoopMeasurements();
+
+	void UpdateClearance(const bool bForceFullUpdate);
+
+	void UpdateClearanceShapes();
+
+	void UpdateElevation(const bool bForceFullUpdate);
+
+	void UpdateElevationShapes();
+
+	void UpdateGroupState();
+
+	/**
+	 * Traces again the parts of the elevation profile affected by the moved actor.
+	 */
+	void HandleActorMoved(AActor* Actor);
+
+	bool IsDisplayLODActive() const;
+
+	void UpdateDisplayData();
+
+	/**
+	 * Samples the spline into a world space polyline, curved sections get CurveSectionSamples points.
+	 */
+	void BuildPolyline(TArray<FVector>& OutPoints) const;
+
+	/**
+	 * Color of the spline lines and arrows with the group color applied.
+	 */
+	FColor GetSplineColor() const;
+
+	float GetViewDistance(const FBox& Box) const;
+
+	bool IsSmallOnScreen(const float Size, const float ViewDistance) const;
+
+	const TArray<FVector>& GetSimplifiedPolyline(const float ViewDistance);
+
+	void DrawSectionArrow(const FTrickySplineSectionDisplayData& Section, const FColor& Color) const;
+
 };
 
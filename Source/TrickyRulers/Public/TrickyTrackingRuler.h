@@ -0,0 +1,124 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TrickyDebugTextComponent.h"
+#include "TrickyDistanceHistory.h"
+#include "TrickyTrackingRuler.generated.h"
+
+class UBillboardComponent;
+class UTrickyDistanceGraphComponent;
+
+/**
+ * Records distances from the first target actor to each of the others every frame during PIE and simulate.
+ * Shows live, min, max and average distances and a graph of the latest samples.
+ *
+ * @warning this is Editor Only actor
+ */
+UCLASS(HideCategories=(Collision, Actor, Input, Rendering, Replication, Cooking, HLOD, LevelInstance,
+	DataLayers, Networking, WorldPartition, Physics, Events, "Actor Tick"))
+class TRICKYRULERS_API ATrickyTrackingRuler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATrickyTrackingRuler();
+
+protected:
+	virtual void BeginPlay() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	/**
+	 * Tracked actors. Distances are measured from the first actor to each of the others.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	TArray<TObjectPtr<AActor>> Targets;
+
+	/**
+	 * Amount of the latest samples kept for each pair of actors.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler", meta=(ClampMin=16, UIMin=16, ClampMax=4096, UIMax=4096))
+	int32 HistorySize = 256;
+
+	/**
+	 * Determines whether the debug text with distances should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bShowDebugText = true;
+
+	/**
+	 * How often the debug text is updated in seconds.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		meta=(EditCondition="bShowDebugText", Units="s", ClampMin=0.05, UIMin=0.05, ClampMax=1, UIMax=1))
+	float DebugTextUpdateInterval = 0.2f;
+
+	/**
+	 * Determines whether the graph of the latest samples should be shown in viewport.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ruler")
+	bool bShowGraph = true;
+
+	UPROPERTY(EditAnywhere, Category="Ruler", meta=(HideAlphaChannel))
+	FColor Color = FColor::Orange;
+
+	UPROPERTY(EditAnywhere,
+		Category="Ruler",
+		meta=(ClampMin=1.0f, ClampMax=10.0f, UIMin=1.0f, UIMax=10.0f, Delta=1.0f))
+	float Thickness = 2.0f;
+
+	/**
+	 * Scale of the debug text.
+	 */
+	UPROPERTY(EditAnywhere,
+		BlueprintReadOnly,
+		Category="Ruler",
+		AdvancedDisplay,
+		meta=(EditCondition="bShowDebugText", ClampMin=1, UIMin=1, ClampMax=2, UIMax=2, Delta=0.1))
+	float DebugTextScale = 1.f;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UBillboardComponent> BillboardComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDebugTextComponent> TrickyDebugTextComponent = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UTrickyDistanceGraphComponent> DistanceGraphComponent = nullptr;
+
+	TArray<FTrickyDistanceHistoryPtr> Histories;
+
+	TArray<FTrickyDistanceStats> Stats;
+
+	TArray<FTrickyDebugTextData> DebugTextData;
+
+	float DebugTextUpdateTime = 0.f;
+
+	/**
+	 * Allocates the histories for the current targets, the recorded samples are dropped.
+	 */
+	void ResetHistories();
+
+	/**
+	 * Targets can be edited during play, so only the pairs which have both a history and a target are measured.
+	 */
+	int32 GetPairsNum() const;
+
+	void RecordSamples();
+
+	void UpdateDebugText();
+
+	void DrawDistances() const;
+};
@@ -36,6 +36,9 @@ public class TrickyRulers : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"NavigationSystem",
+				"RenderCore",
+				"RHI",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -43,6 +46,12 @@ public class TrickyRulers : ModuleRules
 			);
 		
 		
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+		
+		
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
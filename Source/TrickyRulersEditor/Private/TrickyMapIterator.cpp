@@ -0,0 +1,199 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyMapIterator.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectGlobals.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionActorDescInstance.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+
+void TrickyMapIterator::GatherMapPackages(const FString& Params, TArray<FString>& OutPackageNames)
+{
+	FString Maps;
+
+	if (FParse::Value(*Params, TEXT("Maps="), Maps, false))
+	{
+		Maps.ParseIntoArray(OutPackageNames, TEXT("+"));
+	}
+
+	FString MapPath;
+
+	if (FParse::Value(*Params, TEXT("MapPath="), MapPath))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(
+			TEXT("AssetRegistry")).Get();
+		AssetRegistry.SearchAllAssets(true);
+
+		FARFilter Filter;
+		Filter.ClassPaths.Add(UWorld::StaticClass()->GetClassPathName());
+		Filter.PackagePaths.Add(*MapPath);
+		Filter.bRecursivePaths = true;
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssets(Filter, Assets);
+
+		for (const FAssetData& Asset : Assets)
+		{
+			OutPackageNames.AddUnique(Asset.PackageName.ToString());
+		}
+	}
+
+	OutPackageNames.Sort();
+}
+
+void TrickyMapIterator::ForEachMap(const TArray<FString>& PackageNames,
+                                   TFunctionRef<void(UWorld& World, const FString& PackageName)> Functor)
+{
+	int32 RequestId = PackageNames.Num() > 0 ? LoadPackageAsync(PackageNames[0]) : INDEX_NONE;
+
+	for (int32 i = 0; i < PackageNames.Num(); ++i)
+	{
+		const FString& PackageName = PackageNames[i];
+		FlushAsyncLoading(RequestId);
+
+		UPackage* Package = FindPackage(nullptr, *PackageName);
+
+		if (!Package)
+		{
+			Package = LoadPackage(nullptr, *PackageName, LOAD_None);
+		}
+
+		// The previous map is collected while no load is in flight, the loaded world is kept referenced until then.
+		const TStrongObjectPtr<UWorld> LoadedWorld(Package ? UWorld::FindWorldInPackage(Package) : nullptr);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		// Loading can't run in parallel with the game thread work, but it can overlap with it.
+		RequestId = PackageNames.IsValidIndex(i + 1) ? LoadPackageAsync(PackageNames[i + 1]) : INDEX_NONE;
+
+		if (UWorld* World = LoadedWorld.Get())
+		{
+			// Actors of partitioned worlds are in external packages and are loaded by the initialized world partition.
+			const bool bInitWorld = World->IsPartitionedWorld() && !World->bIsWorldInitialized;
+
+			if (bInitWorld)
+			{
+				World->InitWorld(UWorld::InitializationValues()
+				                 .InitializeScenes(false)
+				                 .AllowAudioPlayback(false)
+				                 .RequiresHitProxies(false)
+				                 .CreatePhysicsScene(false)
+				                 .CreateNavigation(false)
+				                 .CreateAISystem(false)
+				                 .ShouldSimulatePhysics(false)
+				                 .EnableTraceCollision(false)
+				                 .SetTransactional(false)
+				                 .CreateFXSystem(false));
+			}
+
+			Functor(*World, PackageName);
+
+			if (bInitWorld)
+			{
+				World->DestroyWorld(false);
+			}
+		}
+	}
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void TrickyMapIterator::ForEachActor(UWorld& World,
+                                     const TArray<TSubclassOf<AActor>>& ActorClasses,
+                                     TFunctionRef<void(const AActor& Actor)> Functor)
+{
+	auto IsOfClass = [&ActorClasses](const AActor* Actor)
+	{
+		return ActorClasses.ContainsByPredicate([Actor](const TSubclassOf<AActor>& Class)
+		{
+			return Actor->IsA(Class);
+		});
+	};
+
+	if (UWorldPartition* WorldPartition = World.GetWorldPartition())
+	{
+		auto HandleActorDesc = [&](const FWorldPartitionActorDescInstance* Instance)
+		{
+			const AActor* Actor = Instance->GetActor();
+
+			if (Actor && IsOfClass(Actor))
+			{
+				Functor(*Actor);
+			}
+
+			return true;
+		};
+
+		FWorldPartitionHelpers::FForEachActorWithLoadingParams Params;
+		Params.ActorClasses = ActorClasses;
+		FWorldPartitionHelpers::ForEachActorWithLoading(WorldPartition, HandleActorDesc, Params);
+		return;
+	}
+
+	// The world isn't initialized, so the levels are read directly to not skip the hidden streaming levels.
+	for (const ULevel* Level : World.GetLevels())
+	{
+		if (!Level)
+		{
+			continue;
+		}
+
+		for (const AActor* Actor : Level->Actors)
+		{
+			if (Actor && IsOfClass(Actor))
+			{
+				Functor(*Actor);
+			}
+		}
+	}
+}
+
+void TrickyMapIterator::GatherMapFiles(const FString& PackageName, TArray<FString>& OutFilePaths)
+{
+	FString FilePath;
+
+	if (!FPackageName::DoesPackageExist(PackageName, &FilePath))
+	{
+		return;
+	}
+
+	OutFilePaths.Add(FilePath);
+
+	FString ExternalActorsPath;
+
+	if (FPackageName::TryConvertLongPackageNameToFilename(ULevel::GetExternalActorsPath(PackageName),
+	                                                      ExternalActorsPath))
+	{
+		TArray<FString> ExternalActorFiles;
+		IFileManager::Get().FindFilesRecursive(ExternalActorFiles,
+		                                       *ExternalActorsPath,
+		                                       *(TEXT("*") + FPackageName::GetAssetPackageExtension()),
+		                                       true,
+		                                       false);
+		ExternalActorFiles.Sort();
+		OutFilePaths.Append(MoveTemp(ExternalActorFiles));
+	}
+}
+
+FTransform TrickyMapIterator::GetActorTransform(const AActor* Actor)
+{
+	const USceneComponent* Component = Actor ? Actor->GetRootComponent() : nullptr;
+	FTransform Transform = FTransform::Identity;
+
+	while (Component)
+	{
+		Transform *= Component->GetRelativeTransform();
+		Component = Component->GetAttachParent();
+	}
+
+	return Transform;
+}
@@ -0,0 +1,46 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * Loads maps one by one for commandlets, requesting the next map asynchronously while the current one is processed.
+ */
+namespace TrickyMapIterator
+{
+	/**
+	 * Collects map package names from "-Maps=/Game/A+/Game/B" and "-MapPath=/Game/Maps" parameters.
+	 */
+	void GatherMapPackages(const FString& Params, TArray<FString>& OutPackageNames);
+
+	/**
+	 * Calls the functor for every map which could be loaded. Garbage of the previous map is collected
+	 * before the next one is requested.
+	 * World Partition worlds are initialized, so their actors can be loaded with ForEachActor.
+	 */
+	void ForEachMap(const TArray<FString>& PackageNames,
+	                TFunctionRef<void(UWorld& World, const FString& PackageName)> Functor);
+
+	/**
+	 * Calls the functor for every actor of the given classes in all levels of the world.
+	 * Actors of World Partition worlds are loaded in batches, including the ones in unloaded cells.
+	 */
+	void ForEachActor(UWorld& World,
+	                  const TArray<TSubclassOf<AActor>>& ActorClasses,
+	                  TFunctionRef<void(const AActor& Actor)> Functor);
+
+	/**
+	 * Paths of the map file and the files of its external actors, sorted, so they can be hashed.
+	 * Empty if the map doesn't exist.
+	 */
+	void GatherMapFiles(const FString& PackageName, TArray<FString>& OutFilePaths);
+
+	/**
+	 * World transform of the actor calculated from the relative transforms, as components of the loaded maps
+	 * aren't registered.
+	 */
+	FTransform GetActorTransform(const AActor* Actor);
+}
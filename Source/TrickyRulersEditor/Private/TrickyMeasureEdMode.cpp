@@ -0,0 +1,421 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyMeasureEdMode.h"
+
+#include "CanvasTypes.h"
+#include "EditorModeManager.h"
+#include "EditorViewportClient.h"
+#include "Editor.h"
+#include "Components/ActorComponent.h"
+#include "SceneView.h"
+#include "ScopedTransaction.h"
+#include "TrickyRuler.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#define LOCTEXT_NAMESPACE "TrickyMeasureEdMode"
+
+const FEditorModeID FTrickyMeasureEdMode::EM_TrickyMeasure = TEXT("EM_TrickyMeasure");
+
+const FHitResult* FTrickyTraceCache::RequestTrace(UWorld* World,
+                                                  const FIntPoint& Pixel,
+                                                  const FVector& Start,
+                                                  const FVector& End,
+                                                  bool& bOutIsPending)
+{
+	if (Entries.Num() >= MaxEntries && !Entries.Contains(Pixel))
+	{
+		Entries.Reset();
+	}
+
+	FEntry& Entry = Entries.FindOrAdd(Pixel);
+
+	const bool bIsSameRay = Entry.Start.Equals(Start) && Entry.End.Equals(End);
+
+	if (!bIsSameRay || (!Entry.bIsPending && !Entry.bHasResult))
+	{
+		Entry.RequestId = ++LastRequestId;
+
+		FTraceDelegate TraceDelegate;
+		TraceDelegate.BindSP(AsShared(), &FTrickyTraceCache::HandleTraceDone, Pixel, Entry.RequestId);
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrickyMeasureTrace), true);
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+		                               Start,
+		                               End,
+		                               ECC_Visibility,
+		                               QueryParams,
+		                               FCollisionResponseParams::DefaultResponseParam,
+		                               &TraceDelegate);
+
+		Entry.Start = Start;
+		Entry.End = End;
+		Entry.bIsPending = true;
+	}
+
+	bOutIsPending = !Entry.bHasResult;
+	return Entry.bHasResult && Entry.bHasHit ? &Entry.Hit : nullptr;
+}
+
+void FTrickyTraceCache::Invalidate()
+{
+	Entries.Reset();
+}
+
+void FTrickyTraceCache::HandleTraceDone(const FTraceHandle& TraceHandle,
+                                         FTraceDatum& TraceDatum,
+                                         const FIntPoint Pixel,
+                                         const uint32 RequestId)
+{
+	FEntry* Entry = Entries.Find(Pixel);
+
+	// The cache was invalidated or the ray was traced again while the trace was in flight.
+	if (!Entry || Entry->RequestId != RequestId)
+	{
+		return;
+	}
+
+	Entry->bIsPending = false;
+	Entry->bHasResult = true;
+	Entry->bHasHit = TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit;
+
+	if (Entry->bHasHit)
+	{
+		Entry->Hit = TraceDatum.OutHits[0];
+	}
+}
+
+FTrickyMeasureEdMode::FTrickyMeasureEdMode()
+	: TraceCache(MakeShared<FTrickyTraceCache>())
+{
+}
+
+void FTrickyMeasureEdMode::Enter()
+{
+	FEdMode::Enter();
+
+	// Cached hits are only valid while nothing under the cursor changes.
+	GEngine->OnActorMoved().AddRaw(this, &FTrickyMeasureEdMode::HandleActorChanged);
+	GEngine->OnLevelActorAdded().AddRaw(this, &FTrickyMeasureEdMode::HandleActorChanged);
+	GEngine->OnLevelActorDeleted().AddRaw(this, &FTrickyMeasureEdMode::HandleActorChanged);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FTrickyMeasureEdMode::HandleObjectPropertyChanged);
+	FEditorDelegates::MapChange.AddRaw(this, &FTrickyMeasureEdMode::HandleMapChange);
+}
+
+void FTrickyMeasureEdMode::Exit()
+{
+	GEngine->OnActorMoved().RemoveAll(this);
+	GEngine->OnLevelActorAdded().RemoveAll(this);
+	GEngine->OnLevelActorDeleted().RemoveAll(this);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.RemoveAll(this);
+	FEditorDelegates::MapChange.RemoveAll(this);
+
+	TraceCache->Invalidate();
+	SnapRays.Reset();
+	CachedMousePosition = FIntPoint::NoneValue;
+	StartLocation.Reset();
+	CurrentSnap = FTrickySnapResult();
+
+	FEdMode::Exit();
+}
+
+void FTrickyMeasureEdMode::Tick(FEditorViewportClient* ViewportClient, float DeltaTime)
+{
+	FEdMode::Tick(ViewportClient, DeltaTime);
+
+	if (ViewportClient && ViewportClient->Viewport == GEditor->GetActiveViewport())
+	{
+		UpdateSnap(ViewportClient);
+	}
+}
+
+void FTrickyMeasureEdMode::Render(const FSceneView* View, FViewport* Viewport, FPrimitiveDrawInterface* PDI)
+{
+	FEdMode::Render(View, Viewport, PDI);
+
+	if (CurrentSnap.Type == ETrickySnapType::None)
+	{
+		return;
+	}
+
+	PDI->DrawPoint(CurrentSnap.Location, GetSnapColor(CurrentSnap.Type), 12.f, SDPG_Foreground);
+
+	if (StartLocation.IsSet())
+	{
+		PDI->DrawPoint(StartLocation.GetValue(), FColor::Red, 12.f, SDPG_Foreground);
+		PDI->DrawLine(StartLocation.GetValue(), CurrentSnap.Location, FColor::Red, SDPG_Foreground, 2.f);
+	}
+}
+
+void FTrickyMeasureEdMode::DrawHUD(FEditorViewportClient* ViewportClient,
+                                   FViewport* Viewport,
+                                   const FSceneView* View,
+                                   FCanvas* Canvas)
+{
+	FEdMode::DrawHUD(ViewportClient, Viewport, View, Canvas);
+
+	if (!StartLocation.IsSet() || CurrentSnap.Type == ETrickySnapType::None)
+	{
+		return;
+	}
+
+	const FVector MidPoint = (StartLocation.GetValue() + CurrentSnap.Location) * 0.5f;
+	FVector2D ScreenLocation;
+
+	if (!View->WorldToPixel(MidPoint, ScreenLocation))
+	{
+		return;
+	}
+
+	const float DPIScale = Canvas->GetDPIScale();
+	const float Length = FVector::Dist(StartLocation.GetValue(), CurrentSnap.Location) / 100.f;
+	Canvas->DrawShadowedString(ScreenLocation.X / DPIScale,
+	                           ScreenLocation.Y / DPIScale,
+	                           *FString::Printf(TEXT("Length: %.2f m"), Length),
+	                           GEngine->GetSmallFont(),
+	                           FLinearColor::Red);
+}
+
+bool FTrickyMeasureEdMode::HandleClick(FEditorViewportClient* InViewportClient,
+                                       HHitProxy* HitProxy,
+                                       const FViewportClick& Click)
+{
+	if (Click.GetKey() == EKeys::RightMouseButton)
+	{
+		StartLocation.Reset();
+		return true;
+	}
+
+	if (Click.GetKey() != EKeys::LeftMouseButton || CurrentSnap.Type == ETrickySnapType::None)
+	{
+		return true;
+	}
+
+	if (!StartLocation.IsSet())
+	{
+		StartLocation = CurrentSnap.Location;
+		return true;
+	}
+
+	CreateRuler(StartLocation.GetValue(), CurrentSnap.Location);
+	StartLocation.Reset();
+	return true;
+}
+
+bool FTrickyMeasureEdMode::InputKey(FEditorViewportClient* ViewportClient,
+                                    FViewport* Viewport,
+                                    FKey Key,
+                                    EInputEvent Event)
+{
+	if (Key != EKeys::Escape || Event != IE_Pressed)
+	{
+		return FEdMode::InputKey(ViewportClient, Viewport, Key, Event);
+	}
+
+	if (StartLocation.IsSet())
+	{
+		StartLocation.Reset();
+	}
+	else
+	{
+		Owner->DeactivateMode(EM_TrickyMeasure);
+	}
+
+	return true;
+}
+
+void FTrickyMeasureEdMode::UpdateSnap(FEditorViewportClient* ViewportClient)
+{
+	FViewport* Viewport = ViewportClient->Viewport;
+	UWorld* World = ViewportClient->GetWorld();
+
+	if (!Viewport || !World)
+	{
+		return;
+	}
+
+	const FIntPoint MousePosition(Viewport->GetMouseX(), Viewport->GetMouseY());
+	const FIntPoint ViewportSize = Viewport->GetSizeXY();
+
+	if (MousePosition.X < 0 || MousePosition.Y < 0 || MousePosition.X >= ViewportSize.X || MousePosition.Y >= ViewportSize.Y)
+	{
+		CurrentSnap = FTrickySnapResult();
+		return;
+	}
+
+	const bool bHasViewChanged = !CachedViewLocation.Equals(ViewportClient->GetViewLocation())
+		|| !CachedViewRotation.Equals(ViewportClient->GetViewRotation())
+		|| CachedViewportSize != ViewportSize
+		|| CachedViewFOV != ViewportClient->ViewFOV;
+
+	if (bHasViewChanged)
+	{
+		CachedViewLocation = ViewportClient->GetViewLocation();
+		CachedViewRotation = ViewportClient->GetViewRotation();
+		CachedViewportSize = ViewportSize;
+		CachedViewFOV = ViewportClient->ViewFOV;
+		TraceCache->Invalidate();
+	}
+
+	if (bHasViewChanged || CachedMousePosition != MousePosition || SnapRays.Num() == 0)
+	{
+		UpdateSnapRays(ViewportClient, MousePosition);
+	}
+
+	TArray<FHitResult, TInlineAllocator<RaysNum>> Hits;
+
+	for (const FSnapRay& Ray : SnapRays)
+	{
+		bool bIsPending = false;
+
+		if (const FHitResult* Hit = TraceCache->RequestTrace(World, Ray.Pixel, Ray.Start, Ray.End, bIsPending))
+		{
+			Hits.Add(*Hit);
+		}
+		else if (Hits.Num() == 0)
+		{
+			// Keep the previous snap while the ray under the cursor is being traced.
+			if (!bIsPending)
+			{
+				CurrentSnap = FTrickySnapResult();
+			}
+
+			return;
+		}
+	}
+
+	const FHitResult& CenterHit = Hits[0];
+	TArray<FPlane, TInlineAllocator<RaysNum>> Planes;
+	double SnapDistance = 0.0;
+
+	for (const FHitResult& Hit : Hits)
+	{
+		SnapDistance = FMath::Max(SnapDistance, FVector::Dist(Hit.ImpactPoint, CenterHit.ImpactPoint));
+
+		const bool bIsNewPlane = !Planes.ContainsByPredicate([&Hit](const FPlane& Plane)
+		{
+			return (Plane.GetNormal() | Hit.ImpactNormal) > SameNormalThreshold;
+		});
+
+		if (bIsNewPlane)
+		{
+			Planes.Emplace(Hit.ImpactPoint, Hit.ImpactNormal);
+		}
+	}
+
+	CurrentSnap.Location = CenterHit.ImpactPoint;
+	CurrentSnap.Type = ETrickySnapType::Surface;
+
+	FVector Point = FVector::ZeroVector;
+	FVector Direction = FVector::ZeroVector;
+
+	if (Planes.Num() >= 3 && FMath::IntersectPlanes3(Point, Planes[0], Planes[1], Planes[2])
+		&& FVector::Dist(Point, CenterHit.ImpactPoint) <= SnapDistance)
+	{
+		CurrentSnap.Location = Point;
+		CurrentSnap.Type = ETrickySnapType::Vertex;
+	}
+	else if (Planes.Num() >= 2 && FMath::IntersectPlanes2(Point, Direction, Planes[0], Planes[1]))
+	{
+		const FVector EdgePoint = FMath::ClosestPointOnInfiniteLine(Point, Point + Direction, CenterHit.ImpactPoint);
+
+		if (FVector::Dist(EdgePoint, CenterHit.ImpactPoint) <= SnapDistance)
+		{
+			CurrentSnap.Location = EdgePoint;
+			CurrentSnap.Type = ETrickySnapType::Edge;
+		}
+	}
+}
+
+void FTrickyMeasureEdMode::UpdateSnapRays(FEditorViewportClient* ViewportClient, const FIntPoint& MousePosition)
+{
+	CachedMousePosition = MousePosition;
+	SnapRays.Reset();
+
+	FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(ViewportClient->Viewport,
+		                                   ViewportClient->GetScene(),
+		                                   ViewportClient->EngineShowFlags)
+	                                   .SetRealtimeUpdate(ViewportClient->IsRealtime()));
+	FSceneView* View = ViewportClient->CalcSceneView(&ViewFamily);
+
+	// The first ray is under the cursor, the others are used to find edges and vertices around it.
+	const FIntPoint PixelOffsets[RaysNum] = {
+		{0, 0},
+		{SnapPixelRadius, 0},
+		{-SnapPixelRadius, 0},
+		{0, SnapPixelRadius},
+		{0, -SnapPixelRadius}
+	};
+
+	for (const FIntPoint& PixelOffset : PixelOffsets)
+	{
+		FSnapRay& Ray = SnapRays.AddDefaulted_GetRef();
+		Ray.Pixel = MousePosition + PixelOffset;
+		const FViewportCursorLocation Cursor(View, ViewportClient, Ray.Pixel.X, Ray.Pixel.Y);
+		Ray.Start = Cursor.GetOrigin();
+		Ray.End = Ray.Start + Cursor.GetDirection() * TraceLength;
+	}
+}
+
+void FTrickyMeasureEdMode::HandleActorChanged(AActor* Actor)
+{
+	TraceCache->Invalidate();
+}
+
+void FTrickyMeasureEdMode::HandleObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (Object && (Object->IsA<AActor>() || Object->IsA<UActorComponent>()))
+	{
+		TraceCache->Invalidate();
+	}
+}
+
+void FTrickyMeasureEdMode::HandleMapChange(uint32 MapChangeFlags)
+{
+	TraceCache->Invalidate();
+	SnapRays.Reset();
+}
+
+void FTrickyMeasureEdMode::CreateRuler(const FVector& Start, const FVector& End) const
+{
+	UWorld* World = GetWorld();
+
+	if (!World || Start.Equals(End))
+	{
+		return;
+	}
+
+	const FScopedTransaction Transaction(LOCTEXT("CreateMeasureRuler", "Create Measure Ruler"));
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transactional;
+	ATrickyRuler* Ruler = World->SpawnActor<ATrickyRuler>(Start, FRotator::ZeroRotator, SpawnParameters);
+
+	if (!Ruler)
+	{
+		return;
+	}
+
+	Ruler->SetupLineRuler(Start, End);
+
+	GEditor->SelectNone(false, true);
+	GEditor->SelectActor(Ruler, true, true);
+}
+
+FColor FTrickyMeasureEdMode::GetSnapColor(const ETrickySnapType SnapType)
+{
+	switch (SnapType)
+	{
+	case ETrickySnapType::Vertex:
+		return FColor::Red;
+
+	case ETrickySnapType::Edge:
+		return FColor::Yellow;
+
+	default:
+		return FColor::Green;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,155 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EdMode.h"
+#include "WorldCollision.h"
+
+enum class ETrickySnapType : uint8
+{
+	None,
+	Surface,
+	Edge,
+	Vertex
+};
+
+struct FTrickySnapResult
+{
+	FVector Location = FVector::ZeroVector;
+	ETrickySnapType Type = ETrickySnapType::None;
+};
+
+/**
+ * Caches asynchronous line traces by the cursor pixel.
+ * A ray is traced once until it changes or the cache is invalidated by a change of the level,
+ * and the last result is used while the next one is pending.
+ */
+class FTrickyTraceCache : public TSharedFromThis<FTrickyTraceCache>
+{
+public:
+	/**
+	 * Starts the trace if the ray wasn't traced or requested yet.
+	 * @return last hit of the ray, nullptr if the ray didn't hit anything or is still being traced.
+	 */
+	const FHitResult* RequestTrace(UWorld* World,
+	                               const FIntPoint& Pixel,
+	                               const FVector& Start,
+	                               const FVector& End,
+	                               bool& bOutIsPending);
+
+	void Invalidate();
+
+private:
+	constexpr static int32 MaxEntries = 256;
+
+	struct FEntry
+	{
+		FHitResult Hit;
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+
+		/**
+		 * Id of the latest trace of the entry. Results of the older traces are ignored.
+		 */
+		uint32 RequestId = 0;
+		bool bIsPending = false;
+		bool bHasResult = false;
+		bool bHasHit = false;
+	};
+
+	TMap<FIntPoint, FEntry> Entries;
+
+	uint32 LastRequestId = 0;
+
+	void HandleTraceDone(const FTraceHandle& TraceHandle,
+	                     FTraceDatum& TraceDatum,
+	                     const FIntPoint Pixel,
+	                     const uint32 RequestId);
+};
+
+/**
+ * Interactive measure mode. The first click sets the start point, the second one creates a line ruler.
+ * The cursor snaps to surfaces, edges and vertices found by asynchronous traces around it.
+ */
+class FTrickyMeasureEdMode : public FEdMode
+{
+public:
+	const static FEditorModeID EM_TrickyMeasure;
+
+	FTrickyMeasureEdMode();
+
+	virtual void Enter() override;
+
+	virtual void Exit() override;
+
+	virtual void Tick(FEditorViewportClient* ViewportClient, float DeltaTime) override;
+
+	virtual void Render(const FSceneView* View, FViewport* Viewport, FPrimitiveDrawInterface* PDI) override;
+
+	virtual void DrawHUD(FEditorViewportClient* ViewportClient,
+	                     FViewport* Viewport,
+	                     const FSceneView* View,
+	                     FCanvas* Canvas) override;
+
+	virtual bool HandleClick(FEditorViewportClient* InViewportClient,
+	                         HHitProxy* HitProxy,
+	                         const FViewportClick& Click) override;
+
+	virtual bool InputKey(FEditorViewportClient* ViewportClient,
+	                      FViewport* Viewport,
+	                      FKey Key,
+	                      EInputEvent Event) override;
+
+	virtual bool UsesToolkits() const override { return false; }
+
+	virtual bool IsSelectionAllowed(AActor* InActor, bool bInSelection) const override { return false; }
+
+private:
+	constexpr static int32 SnapPixelRadius = 8;
+	constexpr static float SameNormalThreshold = 0.99f;
+	constexpr static float TraceLength = 1000000.f;
+	constexpr static int32 RaysNum = 5;
+
+	struct FSnapRay
+	{
+		FIntPoint Pixel = FIntPoint::ZeroValue;
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+	};
+
+	TSharedRef<FTrickyTraceCache> TraceCache;
+
+	/**
+	 * Rays are only deprojected again when the cursor or the view changes, building the view each tick is costly.
+	 */
+	TArray<FSnapRay, TInlineAllocator<RaysNum>> SnapRays;
+
+	FIntPoint CachedMousePosition = FIntPoint::NoneValue;
+
+	FIntPoint CachedViewportSize = FIntPoint::ZeroValue;
+
+	float CachedViewFOV = 0.f;
+
+	FTrickySnapResult CurrentSnap;
+
+	TOptional<FVector> StartLocation;
+
+	FVector CachedViewLocation = FVector::ZeroVector;
+
+	FRotator CachedViewRotation = FRotator::ZeroRotator;
+
+	void UpdateSnap(FEditorViewportClient* ViewportClient);
+
+	void UpdateSnapRays(FEditorViewportClient* ViewportClient, const FIntPoint& MousePosition);
+
+	void HandleActorChanged(AActor* Actor);
+
+	void HandleObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+
+	void HandleMapChange(uint32 MapChangeFlags);
+
+	void CreateRuler(const FVector& Start, const FVector& End) const;
+
+	static FColor GetSnapColor(const ETrickySnapType SnapType);
+};
@@ -0,0 +1,155 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyMeasurementWriter.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+namespace TrickyMeasurementWriter
+{
+	FString EscapeCsv(const FString& Value)
+	{
+		if (!Value.Contains(TEXT(",")) && !Value.Contains(TEXT("\"")) && !Value.Contains(TEXT("\n")))
+		{
+			return Value;
+		}
+
+		return FString::Printf(TEXT("\"%s\""), *Value.Replace(TEXT("\""), TEXT("\"\"")));
+	}
+}
+
+class FTrickyCsvMeasurementWriter final : public FTrickyMeasurementWriter
+{
+public:
+	explicit FTrickyCsvMeasurementWriter(TUniquePtr<FArchive>&& InArchive)
+		: Archive(MoveTemp(InArchive))
+	{
+		WriteLine(TEXT("Map,Actor,Type,LocationX,LocationY,LocationZ,Pitch,Yaw,Roll,ScaleX,ScaleY,ScaleZ,Measurements"));
+	}
+
+	virtual void WriteRecord(const FTrickyMeasurementRecord& Record) override
+	{
+		using namespace TrickyMeasurementWriter;
+
+		const FVector Location = Record.Transform.GetLocation();
+		const FRotator Rotation = Record.Transform.Rotator();
+		const FVector Scale = Record.Transform.GetScale3D();
+
+		// Rulers have different sets of measurements, so they're packed into a single column.
+		FString Measurements;
+
+		for (const FTrickyMeasurement& Measurement : Record.Measurements)
+		{
+			Measurements += FString::Printf(TEXT("%s%s=%.4f"),
+			                                Measurements.IsEmpty() ? TEXT("") : TEXT(";"),
+			                                *Measurement.Name.ToString(),
+			                                Measurement.Value);
+		}
+
+		WriteLine(FString::Printf(TEXT("%s,%s,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%s"),
+		                          *EscapeCsv(Record.Map),
+		                          *EscapeCsv(Record.Actor),
+		                          *EscapeCsv(Record.Type),
+		                          Location.X,
+		                          Location.Y,
+		                          Location.Z,
+		                          Rotation.Pitch,
+		                          Rotation.Yaw,
+		                          Rotation.Roll,
+		                          Scale.X,
+		                          Scale.Y,
+		                          Scale.Z,
+		                          *EscapeCsv(Measurements)));
+	}
+
+	virtual void Close() override
+	{
+		Archive->Close();
+	}
+
+private:
+	TUniquePtr<FArchive> Archive;
+
+	void WriteLine(const FString& Line) const
+	{
+		const FTCHARToUTF8 Converted(*(Line + TEXT("\n")));
+		Archive->Serialize(const_cast<ANSICHAR*>(Converted.Get()), Converted.Length());
+	}
+};
+
+class FTrickyJsonMeasurementWriter final : public FTrickyMeasurementWriter
+{
+public:
+	explicit FTrickyJsonMeasurementWriter(TUniquePtr<FArchive>&& InArchive)
+		: Archive(MoveTemp(InArchive))
+		  , JsonWriter(TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>::Create(Archive.Get()))
+	{
+		JsonWriter->WriteArrayStart();
+	}
+
+	virtual void WriteRecord(const FTrickyMeasurementRecord& Record) override
+	{
+		auto WriteVector = [this](const TCHAR* Name, const FVector& Vector)
+		{
+			JsonWriter->WriteArrayStart(Name);
+			JsonWriter->WriteValue(Vector.X);
+			JsonWriter->WriteValue(Vector.Y);
+			JsonWriter->WriteValue(Vector.Z);
+			JsonWriter->WriteArrayEnd();
+		};
+
+		const FRotator Rotation = Record.Transform.Rotator();
+
+		JsonWriter->WriteObjectStart();
+		JsonWriter->WriteValue(TEXT("map"), Record.Map);
+		JsonWriter->WriteValue(TEXT("actor"), Record.Actor);
+		JsonWriter->WriteValue(TEXT("type"), Record.Type);
+		WriteVector(TEXT("location"), Record.Transform.GetLocation());
+		WriteVector(TEXT("rotation"), FVector(Rotation.Pitch, Rotation.Yaw, Rotation.Roll));
+		WriteVector(TEXT("scale"), Record.Transform.GetScale3D());
+		JsonWriter->WriteObjectStart(TEXT("measurements"));
+
+		for (const FTrickyMeasurement& Measurement : Record.Measurements)
+		{
+			JsonWriter->WriteValue(Measurement.Name.ToString(), Measurement.Value);
+		}
+
+		JsonWriter->WriteObjectEnd();
+		JsonWriter->WriteObjectEnd();
+	}
+
+	virtual void Close() override
+	{
+		JsonWriter->WriteArrayEnd();
+		JsonWriter->Close();
+		Archive->Close();
+	}
+
+private:
+	TUniquePtr<FArchive> Archive;
+
+	TSharedRef<TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>> JsonWriter;
+};
+
+TUniquePtr<FTrickyMeasurementWriter> FTrickyMeasurementWriter::Create(const FString& FilePath,
+                                                                      const FString& Format)
+{
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*FilePath));
+
+	if (!Archive)
+	{
+		return nullptr;
+	}
+
+	const FString FileFormat = Format.IsEmpty() ? FPaths::GetExtension(FilePath) : Format;
+
+	if (FileFormat.Equals(TEXT("json"), ESearchCase::IgnoreCase))
+	{
+		return MakeUnique<FTrickyJsonMeasurementWriter>(MoveTemp(Archive));
+	}
+
+	return MakeUnique<FTrickyCsvMeasurementWriter>(MoveTemp(Archive));
+}
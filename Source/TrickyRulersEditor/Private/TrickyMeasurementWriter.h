@@ -0,0 +1,37 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrickyMeasurement.h"
+
+struct FTrickyMeasurementRecord
+{
+	FString Map;
+
+	FString Actor;
+
+	FString Type;
+
+	FTransform Transform = FTransform::Identity;
+
+	TArray<FTrickyMeasurement> Measurements;
+};
+
+/**
+ * Streams measurement records into a file, so only the current record is kept in memory.
+ */
+class FTrickyMeasurementWriter
+{
+public:
+	/**
+	 * Creates a CSV or a JSON writer. If the format is empty, it's taken from the file extension.
+	 */
+	static TUniquePtr<FTrickyMeasurementWriter> Create(const FString& FilePath, const FString& Format);
+
+	virtual ~FTrickyMeasurementWriter() = default;
+
+	virtual void WriteRecord(const FTrickyMeasurementRecord& Record) = 0;
+
+	virtual void Close() = 0;
+};
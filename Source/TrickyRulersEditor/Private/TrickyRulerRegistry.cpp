@@ -0,0 +1,130 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulerRegistry.h"
+
+#include "DrawDebugHelpers.h"
+#include "TrickyRuler.h"
+#include "TrickyRulerActorDesc.h"
+#include "TrickySplineRuler.h"
+#include "Engine/World.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionActorDescInstance.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+
+namespace TrickyRulerRegistry
+{
+	const FColor UnloadedColor = FColor(255, 160, 0);
+
+	/**
+	 * Descriptors are created by the native class of the actor. Blueprints share the native class of their parent,
+	 * while native subclasses may override CreateClassActorDesc, so only the ruler classes themselves are matched.
+	 */
+	bool HasRulerDesc(const FWorldPartitionActorDescInstance* Instance)
+	{
+		const UClass* Class = Instance->GetActorNativeClass();
+		return Class == ATrickyRuler::StaticClass() || Class == ATrickySplineRuler::StaticClass();
+	}
+}
+
+
+void TrickyRulerRegistry::ForEachRulerDesc(UWorld* World,
+                                           TFunctionRef<bool(const FTrickyRulerActorDesc&, const bool)> Function)
+{
+	UWorldPartition* WorldPartition = World ? World->GetWorldPartition() : nullptr;
+
+	if (!WorldPartition)
+	{
+		return;
+	}
+
+	FWorldPartitionHelpers::ForEachActorDescInstance(WorldPartition,
+	                                                 AActor::StaticClass(),
+	                                                 [&Function](const FWorldPartitionActorDescInstance* Instance)
+	                                                 {
+		                                                 if (!HasRulerDesc(Instance))
+		                                                 {
+			                                                 return true;
+		                                                 }
+
+		                                                 const FTrickyRulerActorDesc* Desc =
+			                                                 static_cast<const FTrickyRulerActorDesc*>(
+				                                                 Instance->GetActorDesc());
+
+		                                                 // Descriptors saved before the ruler version have no data.
+		                                                 if (Desc->Kind.IsNone())
+		                                                 {
+			                                                 return true;
+		                                                 }
+
+		                                                 return Function(*Desc, Instance->IsLoaded());
+	                                                 });
+}
+
+void TrickyRulerRegistry::ListRulers(UWorld* World, const TArray<FString>& Args)
+{
+	FString GroupName;
+	bool bOnlyUnloaded = false;
+
+	for (const FString& Arg : Args)
+	{
+		FParse::Value(*Arg, TEXT("Group="), GroupName);
+		bOnlyUnloaded |= Arg.Equals(TEXT("Unloaded"), ESearchCase::IgnoreCase);
+	}
+
+	const FName Group = GroupName.IsEmpty() ? NAME_None : FName(*GroupName);
+	int32 RulersNum = 0;
+
+	ForEachRulerDesc(World, [&](const FTrickyRulerActorDesc& Desc, const bool bIsLoaded)
+	{
+		if ((Group != NAME_None && Desc.Group != Group) || (bOnlyUnloaded && bIsLoaded))
+		{
+			return true;
+		}
+
+		TArray<FString> Values;
+
+		for (const FTrickyMeasurement& Measurement : Desc.Measurements)
+		{
+			Values.Add(FString::Printf(TEXT("%s=%.2f"), *Measurement.Name.ToString(), Measurement.Value));
+		}
+
+		UE_LOG(LogConsoleResponse,
+		       Display,
+		       TEXT("%s [%s]%s %s %s"),
+		       *Desc.GetActorLabel().ToString(),
+		       *Desc.Kind.ToString(),
+		       bIsLoaded ? TEXT("") : TEXT(" (unloaded)"),
+		       *Desc.RulerTransform.GetLocation().ToCompactString(),
+		       *FString::Join(Values, TEXT(" ")));
+		++RulersNum;
+		return true;
+	});
+
+	UE_LOG(LogConsoleResponse, Display, TEXT("%d rulers found."), RulersNum);
+}
+
+void TrickyRulerRegistry::DrawUnloadedRulers(UWorld* World, const float Duration)
+{
+	ForEachRulerDesc(World, [World, Duration](const FTrickyRulerActorDesc& Desc, const bool bIsLoaded)
+	{
+		// Loaded rulers draw themselves.
+		if (bIsLoaded)
+		{
+			return true;
+		}
+
+		for (int32 i = 1; i < Desc.ShapePoints.Num(); ++i)
+		{
+			DrawDebugLine(World, Desc.ShapePoints[i - 1], Desc.ShapePoints[i], UnloadedColor, false, Duration, 0, 2.f);
+		}
+
+		if (Desc.ShapePoints.Num() == 0)
+		{
+			const FBox Bounds = Desc.GetEditorBounds();
+			DrawDebugBox(World, Bounds.GetCenter(), Bounds.GetExtent(), UnloadedColor, false, Duration, 0, 2.f);
+		}
+
+		return true;
+	});
+}
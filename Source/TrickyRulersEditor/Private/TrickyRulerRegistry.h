@@ -0,0 +1,30 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FTrickyRulerActorDesc;
+class UWorld;
+
+/**
+ * Queries the rulers of a World Partition world through their descriptors, including the ones in unloaded cells.
+ */
+namespace TrickyRulerRegistry
+{
+	/**
+	 * Calls the function for every ruler descriptor of the world, stops if it returns false.
+	 * Does nothing for worlds without World Partition.
+	 */
+	void ForEachRulerDesc(UWorld* World, TFunctionRef<bool(const FTrickyRulerActorDesc&, const bool)> Function);
+
+	/**
+	 * Logs the rulers of the world with their measurements. Arguments: Group=<Name> Unloaded.
+	 */
+	void ListRulers(UWorld* World, const TArray<FString>& Args);
+
+	/**
+	 * Draws the shapes and the bounds of the rulers from the unloaded cells for the given time.
+	 */
+	void DrawUnloadedRulers(UWorld* World, const float Duration);
+}
@@ -0,0 +1,94 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#include "TrickyRulersEditor.h"
+
+#include "Editor.h"
+#include "EditorModeManager.h"
+#include "EditorModeRegistry.h"
+#include "TrickyMeasureEdMode.h"
+#include "TrickyRulerRegistry.h"
+#include "TrickySpacingAnalysis.h"
+
+#define LOCTEXT_NAMESPACE "FTrickyRulersEditorModule"
+
+void FTrickyRulersEditorModule::StartupModule()
+{
+	FEditorModeRegistry::Get().RegisterMode<FTrickyMeasureEdMode>(FTrickyMeasureEdMode::EM_TrickyMeasure,
+	                                                             LOCTEXT("TrickyMeasureModeName", "Tricky Measure"),
+	                                                             FSlateIcon(),
+	                                                             true);
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.Measure"),
+		TEXT("Toggles the interactive measure mode. Click the start and the end points to create a line ruler."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FEditorModeTools& ModeTools = GLevelEditorModeTools();
+
+			if (ModeTools.IsModeActive(FTrickyMeasureEdMode::EM_TrickyMeasure))
+			{
+				ModeTools.DeactivateMode(FTrickyMeasureEdMode::EM_TrickyMeasure);
+			}
+			else
+			{
+				ModeTools.ActivateMode(FTrickyMeasureEdMode::EM_TrickyMeasure);
+			}
+		}),
+		ECVF_Default));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.AnalyzeSpacing"),
+		TEXT("Finds nearest neighbours of the selected actors and shows the closest pairs as line rulers. "
+			"Arguments: Min=<cm> Max=<cm> Class=<ActorClass> Rulers=<Num>."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			TrickySpacingAnalysis::Run(GEditor ? GEditor->GetEditorWorldContext().World() : nullptr,
+			                           TrickySpacingAnalysis::ParseSettings(Args));
+		}),
+		ECVF_Default));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.ClearSpacing"),
+		TEXT("Removes the line rulers created by TrickyRulers.AnalyzeSpacing."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			TrickySpacingAnalysis::ClearRulers(GEditor ? GEditor->GetEditorWorldContext().World() : nullptr);
+		}),
+		ECVF_Default));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.List"),
+		TEXT("Logs all rulers of the World Partition world including the unloaded ones. "
+			"Arguments: Group=<Name> Unloaded."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			TrickyRulerRegistry::ListRulers(GEditor ? GEditor->GetEditorWorldContext().World() : nullptr, Args);
+		}),
+		ECVF_Default));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("TrickyRulers.DrawUnloaded"),
+		TEXT("Draws the rulers of the unloaded World Partition cells. Arguments: <Seconds>, 10 by default."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const float Duration = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.f;
+			TrickyRulerRegistry::DrawUnloadedRulers(GEditor ? GEditor->GetEditorWorldContext().World() : nullptr,
+			                                        Duration);
+		}),
+		ECVF_Default));
+}
+
+void FTrickyRulersEditorModule::ShutdownModule()
+{
+	for (IConsoleObject* ConsoleCommand : ConsoleCommands)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(ConsoleCommand);
+	}
+
+	ConsoleCommands.Empty();
+	FEditorModeRegistry::Get().UnregisterMode(FTrickyMeasureEdMode::EM_TrickyMeasure);
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FTrickyRulersEditorModule, TrickyRulersEditor)
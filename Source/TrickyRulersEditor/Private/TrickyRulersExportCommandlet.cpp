@@ -0,0 +1,114 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulersExportCommandlet.h"
+
+#include "TrickyMapIterator.h"
+#include "TrickyMeasurementWriter.h"
+#include "TrickyPolylineRuler.h"
+#include "TrickyRuler.h"
+#include "TrickySplineRuler.h"
+#include "Engine/World.h"
+#include "Misc/Paths.h"
+#include "Tasks/Pipe.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTrickyRulersExport, Log, All);
+
+UTrickyRulersExportCommandlet::UTrickyRulersExportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UTrickyRulersExportCommandlet::Main(const FString& Params)
+{
+	TArray<FString> PackageNames;
+	TrickyMapIterator::GatherMapPackages(Params, PackageNames);
+
+	if (PackageNames.Num() == 0)
+	{
+		UE_LOG(LogTrickyRulersExport, Error, TEXT("No maps to export, pass -Maps= or -MapPath="));
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("TrickyRulers/Measurements.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	FString Format;
+	FParse::Value(*Params, TEXT("Format="), Format);
+
+	const TUniquePtr<FTrickyMeasurementWriter> Writer = FTrickyMeasurementWriter::Create(OutputPath, Format);
+
+	if (!Writer)
+	{
+		UE_LOG(LogTrickyRulersExport, Error, TEXT("Can't create %s"), *OutputPath);
+		return 1;
+	}
+
+	// Formatting and writing of a map runs in the background while the next one is loaded.
+	// The pipe keeps the records in order and the writer is never used from two threads at once.
+	UE::Tasks::FPipe WritePipe(UE_SOURCE_LOCATION);
+	int32 RecordsNum = 0;
+
+	const TArray<TSubclassOf<AActor>> RulerClasses = {
+		ATrickyRuler::StaticClass(),
+		ATrickySplineRuler::StaticClass(),
+		ATrickyPolylineRuler::StaticClass()
+	};
+
+	TrickyMapIterator::ForEachMap(PackageNames, [&](UWorld& World, const FString& PackageName)
+	{
+		TArray<FTrickyMeasurementRecord> Records;
+
+		TrickyMapIterator::ForEachActor(World, RulerClasses, [&](const AActor& Actor)
+		{
+			FTrickyMeasurementRecord Record;
+
+			if (const ATrickyRuler* Ruler = Cast<ATrickyRuler>(&Actor))
+			{
+				Record.Type = StaticEnum<ERulerType>()->GetNameStringByValue(
+					static_cast<int64>(Ruler->GetRulerType()));
+				Ruler->GetMeasurements(Record.Measurements);
+			}
+			else if (const ATrickySplineRuler* SplineRuler = Cast<ATrickySplineRuler>(&Actor))
+			{
+				Record.Type = TEXT("Spline");
+				SplineRuler->GetMeasurements(Record.Measurements);
+			}
+			else if (const ATrickyPolylineRuler* PolylineRuler = Cast<ATrickyPolylineRuler>(&Actor))
+			{
+				Record.Type = TEXT("Polyline");
+				PolylineRuler->GetMeasurements(Record.Measurements);
+			}
+
+			Record.Map = PackageName;
+			Record.Actor = Actor.GetActorNameOrLabel();
+			Record.Transform = TrickyMapIterator::GetActorTransform(&Actor);
+			Records.Add(MoveTemp(Record));
+		});
+
+		UE_LOG(LogTrickyRulersExport, Display, TEXT("%s: %d rulers"), *PackageName, Records.Num());
+		RecordsNum += Records.Num();
+
+		WritePipe.Launch(UE_SOURCE_LOCATION, [&Writer, Records = MoveTemp(Records)]()
+		{
+			for (const FTrickyMeasurementRecord& Record : Records)
+			{
+				Writer->WriteRecord(Record);
+			}
+		});
+	});
+
+	WritePipe.WaitUntilEmpty();
+	Writer->Close();
+
+	UE_LOG(LogTrickyRulersExport,
+	       Display,
+	       TEXT("Exported %d rulers from %d maps to %s"),
+	       RecordsNum,
+	       PackageNames.Num(),
+	       *OutputPath);
+	return 0;
+}
@@ -0,0 +1,23 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TrickyRulersExportCommandlet.generated.h"
+
+/**
+ * Exports measurements of all rulers in the given maps to a CSV or a JSON file.
+ *
+ * -run=TrickyRulersExport -Maps=/Game/A+/Game/B -MapPath=/Game/Maps -Output=Rulers.csv -Format=csv|json -nullrhi
+ */
+UCLASS()
+class UTrickyRulersExportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyRulersExportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
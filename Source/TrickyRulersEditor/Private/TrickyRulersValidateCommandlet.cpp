@@ -0,0 +1,266 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickyRulersValidateCommandlet.h"
+
+#include "TrickyMapIterator.h"
+#include "TrickyPolylineRuler.h"
+#include "TrickyRuler.h"
+#include "TrickySplineRuler.h"
+#include "Dom/JsonObject.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTrickyRulersValidate, Log, All);
+
+UTrickyRulersValidateCommandlet::UTrickyRulersValidateCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UTrickyRulersValidateCommandlet::Main(const FString& Params)
+{
+	TArray<FString> PackageNames;
+	TrickyMapIterator::GatherMapPackages(Params, PackageNames);
+
+	if (PackageNames.Num() == 0)
+	{
+		UE_LOG(LogTrickyRulersValidate, Error, TEXT("No maps to validate, pass -Maps= or -MapPath="));
+		return 1;
+	}
+
+	FString CachePath = FPaths::ProjectSavedDir() / TEXT("TrickyRulers/ValidationCache.json");
+	FParse::Value(*Params, TEXT("Cache="), CachePath);
+
+	TMap<FString, FMapResult> CachedResults;
+
+	if (!FParse::Param(*Params, TEXT("NoCache")))
+	{
+		LoadCache(CachePath, CachedResults);
+	}
+
+	TMap<FString, FMapResult> Results;
+	TArray<FString> ChangedPackageNames;
+	const FMD5Hash CodeHash = GetCodeHash();
+
+	// Hashing the files is much cheaper than loading the map, so unchanged maps are skipped.
+	for (const FString& PackageName : PackageNames)
+	{
+		FMapResult& Result = Results.Add(PackageName);
+		Result.Hash = GetPackageHash(PackageName, CodeHash);
+		const FMapResult* CachedResult = CachedResults.Find(PackageName);
+
+		if (CachedResult && !Result.Hash.IsEmpty() && CachedResult->Hash == Result.Hash)
+		{
+			Result.Violations = CachedResult->Violations;
+		}
+		else
+		{
+			ChangedPackageNames.Add(PackageName);
+		}
+	}
+
+	UE_LOG(LogTrickyRulersValidate,
+	       Display,
+	       TEXT("Validating %d of %d maps, the rest are unchanged"),
+	       ChangedPackageNames.Num(),
+	       PackageNames.Num());
+
+	const TArray<TSubclassOf<AActor>> RulerClasses = {
+		ATrickyRuler::StaticClass(),
+		ATrickySplineRuler::StaticClass(),
+		ATrickyPolylineRuler::StaticClass()
+	};
+
+	TrickyMapIterator::ForEachMap(ChangedPackageNames, [&](UWorld& World, const FString& PackageName)
+	{
+		TArray<FString>& Violations = Results.FindChecked(PackageName).Violations;
+		Violations.Reset();
+
+		TrickyMapIterator::ForEachActor(World, RulerClasses, [&Violations](const AActor& Actor)
+		{
+			TArray<FString> ActorViolations;
+
+			if (const ATrickyRuler* Ruler = Cast<ATrickyRuler>(&Actor))
+			{
+				Ruler->GetConstraintViolations(ActorViolations);
+			}
+			else if (const ATrickySplineRuler* SplineRuler = Cast<ATrickySplineRuler>(&Actor))
+			{
+				SplineRuler->GetConstraintViolations(ActorViolations);
+			}
+			else if (const ATrickyPolylineRuler* PolylineRuler = Cast<ATrickyPolylineRuler>(&Actor))
+			{
+				PolylineRuler->GetConstraintViolations(ActorViolations);
+			}
+
+			for (const FString& Violation : ActorViolations)
+			{
+				Violations.Add(FString::Printf(TEXT("%s: %s"), *Actor.GetActorNameOrLabel(), *Violation));
+			}
+		});
+	});
+
+	int32 ViolationsNum = 0;
+
+	for (const FString& PackageName : PackageNames)
+	{
+		for (const FString& Violation : Results.FindChecked(PackageName).Violations)
+		{
+			UE_LOG(LogTrickyRulersValidate, Warning, TEXT("%s: %s"), *PackageName, *Violation);
+			++ViolationsNum;
+		}
+	}
+
+	// Maps which weren't requested this time keep their cached results.
+	CachedResults.Append(MoveTemp(Results));
+	SaveCache(CachePath, CachedResults);
+
+	UE_LOG(LogTrickyRulersValidate,
+	       Display,
+	       TEXT("Found %d constraint violations in %d maps"),
+	       ViolationsNum,
+	       PackageNames.Num());
+	return ViolationsNum > 0 ? 1 : 0;
+}
+
+FMD5Hash UTrickyRulersValidateCommandlet::GetCodeHash()
+{
+	FMD5 MD5;
+	bool bHasModules = false;
+
+	for (const FName ModuleName : {FName(TEXT("TrickyRulers")), FName(TEXT("TrickyRulersEditor"))})
+	{
+		const FString ModulePath = FModuleManager::Get().GetModuleFilename(ModuleName);
+
+		if (ModulePath.IsEmpty())
+		{
+			continue;
+		}
+
+		const FMD5Hash FileHash = FMD5Hash::HashFile(*ModulePath);
+
+		if (FileHash.IsValid())
+		{
+			MD5.Update(FileHash.GetBytes(), FileHash.GetSize());
+			bHasModules = true;
+		}
+	}
+
+	FMD5Hash Hash;
+
+	if (bHasModules)
+	{
+		Hash.Set(MD5);
+	}
+
+	return Hash;
+}
+
+FString UTrickyRulersValidateCommandlet::GetPackageHash(const FString& PackageName, const FMD5Hash& CodeHash)
+{
+	TArray<FString> FilePaths;
+	TrickyMapIterator::GatherMapFiles(PackageName, FilePaths);
+
+	if (FilePaths.Num() == 0)
+	{
+		return FString();
+	}
+
+	// Paths are hashed too, so added and removed external actors change the hash.
+	FMD5 MD5;
+
+	if (CodeHash.IsValid())
+	{
+		MD5.Update(CodeHash.GetBytes(), CodeHash.GetSize());
+	}
+
+	for (const FString& FilePath : FilePaths)
+	{
+		const FMD5Hash FileHash = FMD5Hash::HashFile(*FilePath);
+		FString RelativePath = FilePath;
+		FPaths::MakePathRelativeTo(RelativePath, *FPaths::ProjectDir());
+		const FTCHARToUTF8 PathUtf8(*RelativePath);
+		MD5.Update(reinterpret_cast<const uint8*>(PathUtf8.Get()), PathUtf8.Length());
+		MD5.Update(FileHash.GetBytes(), FileHash.GetSize());
+	}
+
+	FMD5Hash Hash;
+	Hash.Set(MD5);
+	return LexToString(Hash);
+}
+
+void UTrickyRulersValidateCommandlet::LoadCache(const FString& FilePath, TMap<FString, FMapResult>& OutResults)
+{
+	FString Json;
+
+	if (!FFileHelper::LoadFileToString(Json, *FilePath))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root)
+		|| !Root.IsValid()
+		|| Root->GetIntegerField(TEXT("version")) != CacheVersion)
+	{
+		return;
+	}
+
+	const TSharedPtr<FJsonObject>* Maps = nullptr;
+
+	if (!Root->TryGetObjectField(TEXT("maps"), Maps))
+	{
+		return;
+	}
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Map : (*Maps)->Values)
+	{
+		const TSharedPtr<FJsonObject>* MapObject = nullptr;
+
+		if (!Map.Value->TryGetObject(MapObject))
+		{
+			continue;
+		}
+
+		FMapResult& Result = OutResults.Add(Map.Key);
+		Result.Hash = (*MapObject)->GetStringField(TEXT("hash"));
+		(*MapObject)->TryGetStringArrayField(TEXT("violations"), Result.Violations);
+	}
+}
+
+void UTrickyRulersValidateCommandlet::SaveCache(const FString& FilePath, const TMap<FString, FMapResult>& Results)
+{
+	const TSharedRef<FJsonObject> Maps = MakeShared<FJsonObject>();
+
+	for (const TPair<FString, FMapResult>& Result : Results)
+	{
+		TArray<TSharedPtr<FJsonValue>> Violations;
+
+		for (const FString& Violation : Result.Value.Violations)
+		{
+			Violations.Add(MakeShared<FJsonValueString>(Violation));
+		}
+
+		const TSharedRef<FJsonObject> MapObject = MakeShared<FJsonObject>();
+		MapObject->SetStringField(TEXT("hash"), Result.Value.Hash);
+		MapObject->SetArrayField(TEXT("violations"), Violations);
+		Maps->SetObjectField(Result.Key, MapObject);
+	}
+
+	const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("version"), CacheVersion);
+	Root->SetObjectField(TEXT("maps"), Maps);
+
+	FString Json;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&Json));
+	FFileHelper::SaveStringToFile(Json, *FilePath);
+}
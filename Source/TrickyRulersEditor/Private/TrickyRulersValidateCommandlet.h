@@ -0,0 +1,51 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Misc/SecureHash.h"
+#include "TrickyRulersValidateCommandlet.generated.h"
+
+/**
+ * Checks the measurement constraints of all rulers in the given maps and reports violations.
+ * Results are cached per map and reused while the hash of the map and its external actor files stays the same.
+ * The hash includes the binaries of the plugin, so rebuilt rulers and constraints invalidate the cache.
+ *
+ * -run=TrickyRulersValidate -Maps=/Game/A+/Game/B -MapPath=/Game/Maps -Cache=Validation.json -NoCache -nullrhi
+ */
+UCLASS()
+class UTrickyRulersValidateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTrickyRulersValidateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Increase when the way constraints are checked changes to invalidate old caches.
+	 */
+	constexpr static int32 CacheVersion = 1;
+
+	struct FMapResult
+	{
+		FString Hash;
+
+		TArray<FString> Violations;
+	};
+
+	/**
+	 * Hash of the plugin modules, which measure the rulers and check the constraints.
+	 * Empty in monolithic builds, where the cache relies on CacheVersion only.
+	 */
+	static FMD5Hash GetCodeHash();
+
+	static FString GetPackageHash(const FString& PackageName, const FMD5Hash& CodeHash);
+
+	static void LoadCache(const FString& FilePath, TMap<FString, FMapResult>& OutResults);
+
+	static void SaveCache(const FString& FilePath, const TMap<FString, FMapResult>& Results);
+};
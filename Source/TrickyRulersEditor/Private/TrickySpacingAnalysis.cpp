@@ -0,0 +1,331 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+
+#include "TrickySpacingAnalysis.h"
+
+#include "EngineUtils.h"
+#include "Editor.h"
+#include "Selection.h"
+#include "TrickyRuler.h"
+#include "TrickySpatialHash.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Tasks/Task.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "TrickySpacingAnalysis"
+
+namespace TrickySpacingAnalysis
+{
+	constexpr int32 ItemsPerBatch = 256;
+	const FString RulersFolder = TEXT("TrickySpacing");
+
+	struct FNeighbourPair
+	{
+		int32 First = INDEX_NONE;
+		int32 Second = INDEX_NONE;
+		double Distance = 0.0;
+	};
+
+	void GatherActors(UWorld* World, const FTrickySpacingSettings& Settings, TArray<AActor*>& OutActors)
+	{
+		auto CanAnalyze = [](const AActor* Actor)
+		{
+			return IsValid(Actor) && !Actor->IsA<ATrickyRuler>() && !Actor->ActorHasTag(RulerTag);
+		};
+
+		if (Settings.ActorClass)
+		{
+			for (TActorIterator<AActor> It(World, Settings.ActorClass); It; ++It)
+			{
+				if (CanAnalyze(*It))
+				{
+					OutActors.Add(*It);
+				}
+			}
+
+			return;
+		}
+
+		for (FSelectionIterator It(GEditor->GetSelectedActorIterator()); It; ++It)
+		{
+			AActor* Actor = Cast<AActor>(*It);
+
+			if (CanAnalyze(Actor) && Actor->GetWorld() == World)
+			{
+				OutActors.Add(Actor);
+			}
+		}
+	}
+
+	/**
+	 * Picks a cell size which puts a few points in each cell if they're spread evenly on the ground.
+	 */
+	double EstimateCellSize(const TArray<FVector>& Locations, const FTrickySpacingSettings& Settings)
+	{
+		if (Settings.MaxSpacing > 0.0)
+		{
+			return Settings.MaxSpacing;
+		}
+
+		const FBox Bounds(Locations);
+		const FVector Size = Bounds.GetSize();
+		const double Area = FMath::Max(Size.X * Size.Y, 1.0);
+		return FMath::Max(FMath::Sqrt(Area / Locations.Num()) * 2.0, Settings.MinSpacing);
+	}
+
+	void ShowNotification(const FText& Text, const bool bIsSuccess)
+	{
+		FNotificationInfo Info(Text);
+		Info.ExpireDuration = 8.f;
+		Info.bUseSuccessFailIcons = true;
+		FNotificationManager::Get().AddNotification(Info)->SetCompletionState(
+			bIsSuccess ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+	}
+
+	FColor GetPairColor(const double Distance, const FTrickySpacingSettings& Settings)
+	{
+		if (Settings.MinSpacing > 0.0 && Distance < Settings.MinSpacing)
+		{
+			return FColor::Red;
+		}
+
+		if (Settings.MaxSpacing > 0.0 && Distance > Settings.MaxSpacing)
+		{
+			return FColor::Orange;
+		}
+
+		return FColor::Green;
+	}
+
+	bool IsViolation(const double Distance, const FTrickySpacingSettings& Settings)
+	{
+		return GetPairColor(Distance, Settings) != FColor::Green;
+	}
+
+	void SpawnRulers(UWorld* World,
+	                 const TArray<FVector>& Locations,
+	                 const TArray<FNeighbourPair>& Pairs,
+	                 const FTrickySpacingSettings& Settings)
+	{
+		const int32 RulersNum = FMath::Min(Pairs.Num(), Settings.MaxRulers);
+
+		for (int32 i = 0; i < RulersNum; ++i)
+		{
+			const FNeighbourPair& Pair = Pairs[i];
+			const FVector& Start = Locations[Pair.First];
+			const FVector& End = Locations[Pair.Second];
+
+			// The rulers only visualize the results, so they must not end up in the level or the undo history.
+			FActorSpawnParameters SpawnParameters;
+			SpawnParameters.ObjectFlags |= RF_Transient;
+			ATrickyRuler* Ruler = World->SpawnActor<ATrickyRuler>(Start, FRotator::ZeroRotator, SpawnParameters);
+
+			if (!Ruler)
+			{
+				continue;
+			}
+
+			Ruler->Tags.Add(RulerTag);
+			Ruler->SetFolderPath(*RulersFolder);
+			Ruler->SetupLineRuler(Start, End);
+			Ruler->SetLineRulerColor(GetPairColor(Pair.Distance, Settings));
+		}
+	}
+}
+
+void TrickySpacingAnalysis::Run(UWorld* World, const FTrickySpacingSettings& Settings)
+{
+	if (!World || !GEditor)
+	{
+		return;
+	}
+
+	ClearRulers(World);
+
+	TArray<AActor*> Actors;
+	GatherActors(World, Settings, Actors);
+
+	if (Actors.Num() < 2)
+	{
+		ShowNotification(LOCTEXT("NotEnoughActors", "Select at least two actors or pass Class= to analyze spacing."),
+		                 false);
+		return;
+	}
+
+	TArray<FVector> Locations;
+	Locations.Reserve(Actors.Num());
+
+	for (const AActor* Actor : Actors)
+	{
+		Locations.Add(Actor->GetActorLocation());
+	}
+
+	const int32 ActorsNum = Locations.Num();
+	TArray<int32> NearestIndices;
+	TArray<double> NearestDistances;
+	TArray<int32> CloseNeighboursNum;
+	NearestIndices.SetNumUninitialized(ActorsNum);
+	NearestDistances.SetNumUninitialized(ActorsNum);
+	CloseNeighboursNum.SetNumZeroed(ActorsNum);
+
+	std::atomic<int32> ProcessedNum{0};
+	std::atomic<bool> bIsCancelled{false};
+
+	// The game thread only shows the progress, the queries run on the task graph.
+	UE::Tasks::TTask<void> Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&]()
+	{
+		const FTrickySpatialHash SpatialHash(Locations, EstimateCellSize(Locations, Settings));
+		const int32 BatchesNum = FMath::DivideAndRoundUp(ActorsNum, ItemsPerBatch);
+
+		ParallelFor(BatchesNum, [&](const int32 BatchIndex)
+		{
+			if (bIsCancelled.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const int32 First = BatchIndex * ItemsPerBatch;
+			const int32 Last = FMath::Min(First + ItemsPerBatch, ActorsNum);
+
+			for (int32 i = First; i < Last; ++i)
+			{
+				NearestIndices[i] = SpatialHash.FindNearest(i, NearestDistances[i]);
+
+				if (Settings.MinSpacing > 0.0)
+				{
+					SpatialHash.ForEachInRadius(Locations[i], Settings.MinSpacing, [&](const int32 Index, double)
+					{
+						CloseNeighboursNum[i] += Index != i;
+					});
+				}
+			}
+
+			ProcessedNum.fetch_add(Last - First, std::memory_order_relaxed);
+		});
+	});
+
+	{
+		FScopedSlowTask SlowTask(ActorsNum,
+		                         FText::Format(LOCTEXT("AnalyzingSpacing", "Analyzing spacing of {0} actors..."),
+		                                       ActorsNum));
+		SlowTask.MakeDialog(true);
+		int32 ReportedNum = 0;
+
+		while (!Task.Wait(FTimespan::FromMilliseconds(50.0)))
+		{
+			const int32 CurrentNum = ProcessedNum.load(std::memory_order_relaxed);
+			SlowTask.EnterProgressFrame(CurrentNum - ReportedNum);
+			ReportedNum = CurrentNum;
+
+			if (SlowTask.ShouldCancel())
+			{
+				bIsCancelled = true;
+			}
+		}
+	}
+
+	if (bIsCancelled)
+	{
+		ShowNotification(LOCTEXT("AnalysisCancelled", "Spacing analysis was cancelled."), false);
+		return;
+	}
+
+	TArray<FNeighbourPair> Pairs;
+	Pairs.Reserve(ActorsNum);
+	double MinDistance = TNumericLimits<double>::Max();
+	double MaxDistance = 0.0;
+	double DistancesSum = 0.0;
+	int32 ViolationsNum = 0;
+	int32 ClosePairsNum = 0;
+
+	for (int32 i = 0; i < ActorsNum; ++i)
+	{
+		const int32 Nearest = NearestIndices[i];
+		const double Distance = NearestDistances[i];
+		MinDistance = FMath::Min(MinDistance, Distance);
+		MaxDistance = FMath::Max(MaxDistance, Distance);
+		DistancesSum += Distance;
+		ViolationsNum += IsViolation(Distance, Settings);
+		ClosePairsNum += CloseNeighboursNum[i];
+
+		// Mutual nearest neighbours give the same pair twice.
+		if (Nearest != INDEX_NONE && !(NearestIndices[Nearest] == i && Nearest < i))
+		{
+			Pairs.Add({i, Nearest, Distance});
+		}
+	}
+
+	// Violations go first, then the closest pairs.
+	Pairs.Sort([&Settings](const FNeighbourPair& A, const FNeighbourPair& B)
+	{
+		const bool bIsViolationA = IsViolation(A.Distance, Settings);
+
+		if (bIsViolationA != IsViolation(B.Distance, Settings))
+		{
+			return bIsViolationA;
+		}
+
+		return A.Distance < B.Distance;
+	});
+
+	SpawnRulers(World, Locations, Pairs, Settings);
+
+	ShowNotification(FText::Format(LOCTEXT("AnalysisFinished",
+	                                       "Spacing of {0} actors: nearest {1} m, average {2} m, furthest {3} m.\n"
+	                                       "{4} actors violate the spacing, {5} pairs are closer than the min spacing."),
+	                               ActorsNum,
+	                               FText::AsNumber(MinDistance / 100.0),
+	                               FText::AsNumber(DistancesSum / ActorsNum / 100.0),
+	                               FText::AsNumber(MaxDistance / 100.0),
+	                               ViolationsNum,
+	                               ClosePairsNum / 2),
+	                 ViolationsNum == 0);
+}
+
+FTrickySpacingSettings TrickySpacingAnalysis::ParseSettings(const TArray<FString>& Args)
+{
+	const FString Params = FString::Join(Args, TEXT(" "));
+	FTrickySpacingSettings Settings;
+	FParse::Value(*Params, TEXT("Min="), Settings.MinSpacing);
+	FParse::Value(*Params, TEXT("Max="), Settings.MaxSpacing);
+	FParse::Value(*Params, TEXT("Rulers="), Settings.MaxRulers);
+	Settings.MaxRulers = FMath::Max(Settings.MaxRulers, 0);
+
+	FString ClassName;
+
+	if (FParse::Value(*Params, TEXT("Class="), ClassName))
+	{
+		Settings.ActorClass = FindFirstObject<UClass>(*ClassName, EFindFirstObjectOptions::NativeFirst);
+
+		if (!Settings.ActorClass || !Settings.ActorClass->IsChildOf<AActor>())
+		{
+			ShowNotification(FText::Format(LOCTEXT("WrongClass", "{0} isn't an actor class, the selection is used."),
+			                               FText::FromString(ClassName)),
+			                 false);
+			Settings.ActorClass = nullptr;
+		}
+	}
+
+	return Settings;
+}
+
+void TrickySpacingAnalysis::ClearRulers(UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	for (TActorIterator<ATrickyRuler> It(World); It; ++It)
+	{
+		if (It->ActorHasTag(RulerTag))
+		{
+			World->EditorDestroyActor(*It, false);
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,49 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UWorld;
+
+struct FTrickySpacingSettings
+{
+	/**
+	 * Actors closer to their nearest neighbour than this distance are reported. Ignored if 0.
+	 */
+	double MinSpacing = 0.0;
+
+	/**
+	 * Actors further from their nearest neighbour than this distance are reported. Ignored if 0.
+	 */
+	double MaxSpacing = 0.0;
+
+	/**
+	 * Max amount of line rulers created to show the results.
+	 */
+	int32 MaxRulers = 50;
+
+	/**
+	 * If set, all actors of the class are analyzed instead of the selected ones.
+	 */
+	UClass* ActorClass = nullptr;
+};
+
+/**
+ * Finds the nearest neighbour of every actor and shows the closest pairs and spacing violations as temporary
+ * line rulers.
+ */
+namespace TrickySpacingAnalysis
+{
+	const FName RulerTag = TEXT("TrickySpacingRuler");
+
+	void Run(UWorld* World, const FTrickySpacingSettings& Settings);
+
+	/**
+	 * Parses "Min=100 Max=500 Class=StaticMeshActor Rulers=50" console arguments.
+	 */
+	FTrickySpacingSettings ParseSettings(const TArray<FString>& Args);
+
+	void ClearRulers(UWorld* World);
+}
@@ -0,0 +1,18 @@
+﻿// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+#pragma once
+
+#include "Modules/ModuleManager.h"
+
+class IConsoleObject;
+
+class FTrickyRulersEditorModule : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	TArray<IConsoleObject*> ConsoleCommands;
+};
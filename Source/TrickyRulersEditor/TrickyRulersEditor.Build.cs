@@ -0,0 +1,34 @@
+// MIT License Copyright (c) Artyom "Tricky Fat Cat" Volkov
+
+using UnrealBuildTool;
+
+public class TrickyRulersEditor : ModuleRules
+{
+	public TrickyRulersEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+			}
+			);
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"AssetRegistry",
+				"CoreUObject",
+				"EditorFramework",
+				"Engine",
+				"InputCore",
+				"Json",
+				"Slate",
+				"SlateCore",
+				"TrickyRulers",
+				"UnrealEd",
+			}
+			);
+	}
+}